@@ -18,9 +18,27 @@
 
 #include "Layer.h"
 
+// Qt includes.
+#include <QtCore/QDebug>
+#include <QtCore/QLineF>
+#include <QtCore/QTimer>
+#include <QtGui/QPolygonF>
+
+// STL includes.
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <tuple>
+
 // Local includes.
+#include "draw/geometry/GeometryLineString.h"
 #include "draw/geometry/GeometryPoint.h"
+#include "draw/geometry/GeometryPointCollection.h"
+#include "draw/geometry/GeometryPointImage.h"
 #include "draw/geometry/GeometryPointShape.h"
+#include "util/ScratchBuffers.h"
 
 using namespace qwm;
 
@@ -90,8 +108,8 @@ void Layer::setVisible(const bool& enabled)
         // Set the visibility.
         m_visible = enabled;
 
-        // Emit that we need to redraw to display this change.
-        emit requestRedraw();
+        // Request a redraw to display this change.
+        invalidate();
     }
 }
 
@@ -103,8 +121,8 @@ void Layer::setZoomMinimum(const int& zoom_minimum)
         // Set the zoom minimum.
         m_zoom_minimum = zoom_minimum;
 
-        // Emit that we need to redraw to display this change.
-        emit requestRedraw();
+        // Request a redraw to display this change.
+        invalidate();
     }
 }
 
@@ -116,8 +134,8 @@ void Layer::setZoomMaximum(const int& zoom_maximum)
         // Set the zoom maximum.
         m_zoom_maximum = zoom_maximum;
 
-        // Emit that we need to redraw to display this change.
-        emit requestRedraw();
+        // Request a redraw to display this change.
+        invalidate();
     }
 }
 
@@ -133,269 +151,1869 @@ void Layer::setMouseEventsEnabled(const bool& enable)
     m_mouse_events_enabled = enable;
 }
 
-std::vector<std::shared_ptr<draw::Drawable>> Layer::drawableItems() const
+bool Layer::isClusteringEnabled() const
 {
-    // Gain a read lock to protect the drawable items.
-    QReadLocker locker(&m_drawable_items_mutex);
+    // Gain a read lock to protect the clusters.
+    QReadLocker locker(&m_clusters_mutex);
 
-    // Return the drawable items.
-    return m_drawable_items;
+    // Return whether clustering is enabled.
+    return m_clusters != nullptr;
 }
 
-std::vector<std::shared_ptr<draw::geometry::Geometry>> Layer::drawableGeometries(const util::RectWorldCoord& range_coord) const
+void Layer::setClusteringEnabled(const bool& enabled, const int& zoom_maximum, const qreal& cell_size_px, const projection::EPSG& projection_epsg, const QSize& tile_size_px)
 {
-    // Gain a read lock to protect the geometries container.
-    QReadLocker locker(&m_drawable_geometries_mutex);
-
-    // Populate the geometries container with geometry points.
-    std::set<std::shared_ptr<draw::geometry::Geometry>> geometry_points;
-    m_drawable_geometries_points.query(geometry_points, range_coord);
+    // Gain a lock to serialise writers (so the clusters match the current snapshot).
+    QMutexLocker locker(&m_drawables_write_mutex);
 
-    // The geometries container to return, populate with geometry points.
-    std::vector<std::shared_ptr<draw::geometry::Geometry>> return_geometries(geometry_points.begin(), geometry_points.end());
+    // Gain a write lock to protect the clusters.
+    QWriteLocker clusters_locker(&m_clusters_mutex);
 
-    // Loop through the fixed geometries types (ellipse, line string, polygon).
-    for(const auto& geometry : m_drawable_geometries_fixed)
+    // Should clustering be enabled?
+    if(enabled)
     {
-        // Does the query and geometry bounding box intersect?
-        if(range_coord.intersects(geometry->boundingBoxFixed()))
+        // Create the clusters.
+        m_clusters.reset(new util::ClusterContainer(zoom_maximum, cell_size_px, projection_epsg, tile_size_px));
+        m_clusters_counted.clear();
+
+        // Loop through each bucket in the current snapshot.
+        for(const auto& bucket : drawablesSnapshot()->m_drawable_geometries)
         {
-            // Add to the return geometries.
-            return_geometries.push_back(geometry);
+            // Fetch the bucket's geometry points.
+            std::set<std::shared_ptr<draw::geometry::Geometry>> geometry_points;
+            bucket.second.m_drawable_geometries_points.query(geometry_points, bucket.second.m_drawable_geometries_points.boundary());
+
+            // Add each (visible) geometry point to the clusters.
+            for(const auto& geometry_point : geometry_points)
+            {
+                clusterInsert(geometry_point.get(), std::static_pointer_cast<draw::geometry::GeometryPoint>(geometry_point)->coord(), bucket.first);
+            }
         }
     }
+    else
+    {
+        // Remove the clusters.
+        m_clusters.reset();
+        m_clusters_counted.clear();
+    }
 
-    // Return the list of geometries.
-    return return_geometries;
+    // Request a redraw to display this change.
+    invalidate();
 }
 
-bool Layer::addDrawable(const std::shared_ptr<draw::Drawable>& drawable, const bool& disable_redraw)
+void Layer::setClusterPen(const QPen& pen)
 {
-    // Keep track of our success.
-    bool success(false);
+    {
+        // Gain a write lock to protect the cluster pen.
+        QWriteLocker locker(&m_clusters_mutex);
+
+        // Set the pen to draw clusters with.
+        m_cluster_pen = pen;
+    }
+
+    // Request a redraw to display this change.
+    invalidate();
+}
 
-    // Check that the drawable item is valid.
-    if(drawable != nullptr)
+void Layer::setClusterBrush(const QBrush& brush)
+{
     {
-        // Is this a drawable item (non-geometry)?
-        if(drawable->drawableType() != draw::DrawableType::Geometry)
-        {
-            // Gain a write lock to protect the drawable items.
-            QWriteLocker locker(&m_drawable_items_mutex);
+        // Gain a write lock to protect the cluster brush.
+        QWriteLocker locker(&m_clusters_mutex);
 
-            // Add the drawable item.
-            m_drawable_items.push_back(drawable);
+        // Set the brush to draw clusters with.
+        m_cluster_brush = brush;
+    }
 
-            // Update our success.
-            success = true;
-        }
-        else
-        {
-            // Handle the different drawable geometry types.
-            const auto drawable_geometry(std::static_pointer_cast<draw::geometry::Geometry>(drawable));
-            if(drawable_geometry->geometryType() == draw::geometry::GeometryType::GeometryPoint)
-            {
-                // Gain a write lock to protect the geometries container.
-                QWriteLocker locker(&m_drawable_geometries_mutex);
+    // Request a redraw to display this change.
+    invalidate();
+}
 
-                // Add the geometry point container.
-                success = m_drawable_geometries_points.insert(std::static_pointer_cast<draw::geometry::GeometryPoint>(drawable_geometry)->coord(), drawable_geometry);
-            }
-            else
-            {
-                // Gain a write lock to protect the geometries container.
-                QWriteLocker locker(&m_drawable_geometries_mutex);
+qreal Layer::subPixelThresholdPx() const
+{
+    // Gain a lock to protect the sub-pixel culling settings.
+    QMutexLocker locker(&m_geometry_budget_mutex);
 
-                // Add the geometry.
-                m_drawable_geometries_fixed.push_back(std::static_pointer_cast<draw::geometry::GeometryFixed>(drawable_geometry));
+    // Return the projected size below which fixed geometries are culled.
+    return m_sub_pixel_threshold_px;
+}
 
-                // Update our success.
-                success = true;
-            }
-        }
+bool Layer::isSubPixelCollapsedToDots() const
+{
+    // Gain a lock to protect the sub-pixel culling settings.
+    QMutexLocker locker(&m_geometry_budget_mutex);
+
+    // Return whether culled geometries are collapsed into dots.
+    return m_sub_pixel_collapse_to_dots;
+}
+
+void Layer::setSubPixelCulling(const qreal& threshold_px, const bool& collapse_to_dots)
+{
+    {
+        // Gain a lock to protect the sub-pixel culling settings.
+        QMutexLocker locker(&m_geometry_budget_mutex);
+
+        // Set the projected size below which fixed geometries are culled.
+        m_sub_pixel_threshold_px = threshold_px;
+
+        // Set whether culled geometries are collapsed into dots.
+        m_sub_pixel_collapse_to_dots = collapse_to_dots;
     }
 
-    // Was we successful?
-    if(success)
+    // Request a redraw to display this change.
+    invalidate();
+}
+
+std::size_t Layer::geometryBudget() const
+{
+    // Gain a lock to protect the geometry budget.
+    QMutexLocker locker(&m_geometry_budget_mutex);
+
+    // Return the maximum number of geometries drawn per frame.
+    return m_geometry_budget;
+}
+
+void Layer::setGeometryBudget(const std::size_t& budget, const std::string& priority_key)
+{
     {
-        // Should we redraw?
-        if(disable_redraw == false)
-        {
-            // Emit to redraw layer.
-            emit requestRedraw();
-        }
+        // Gain a lock to protect the geometry budget.
+        QMutexLocker locker(&m_geometry_budget_mutex);
 
-        // Connect signal/slot to pass on redraw reuqests.
-        QObject::connect(drawable.get(), &draw::Drawable::requestRedraw, this, &Layer::requestRedraw);
+        // Set the maximum number of geometries drawn per frame.
+        m_geometry_budget = budget;
+
+        // Set the meta-data key that holds each geometry's priority.
+        m_geometry_budget_priority_key = priority_key;
     }
 
-    // Return our success.
-    return success;
+    // Request a redraw to display this change.
+    invalidate();
 }
 
-bool Layer::removeDrawable(const std::shared_ptr<draw::Drawable>& drawable, const bool& disable_redraw)
+bool Layer::isLabelDeclutteringEnabled() const
+{
+    // Return whether labels are decluttered.
+    return m_label_decluttering_enabled;
+}
+
+void Layer::setLabelDeclutteringEnabled(const bool& enabled)
+{
+    // Set whether labels are decluttered.
+    m_label_decluttering_enabled = enabled;
+
+    // Request a redraw to display this change.
+    invalidate();
+}
+
+bool Layer::isStyleSortingEnabled() const
+{
+    // Return whether geometries are drawn grouped by their style.
+    return m_style_sorting_enabled;
+}
+
+void Layer::setStyleSortingEnabled(const bool& enabled)
+{
+    // Set whether geometries are drawn grouped by their style.
+    m_style_sorting_enabled = enabled;
+
+    // Request a redraw to display this change.
+    invalidate();
+}
+
+std::shared_ptr<util::AttributeTable> Layer::attributeTable() const
+{
+    // Gain a lock to protect the attribute table.
+    QMutexLocker locker(&m_attribute_table_mutex);
+
+    // Return the attribute table.
+    return m_attribute_table;
+}
+
+void Layer::setAttributeTable(const std::shared_ptr<util::AttributeTable>& attribute_table)
 {
-    // Keep track of our success.
-    bool success(false);
+    // Gain a lock to protect the attribute table.
+    QMutexLocker locker(&m_attribute_table_mutex);
 
-    // Check that the drawable item is valid.
-    if(drawable != nullptr)
+    // Set the attribute table.
+    m_attribute_table = attribute_table;
+
+    // Move the meta-data of the drawable items/geometries already in the layer into the attribute table.
+    for(const auto& drawable : drawableItems())
     {
-        // Is this a drawable item (non-geometry)?
-        if(drawable->drawableType() != draw::DrawableType::Geometry)
-        {
-            // Gain a write lock to protect the drawable items.
-            QWriteLocker locker(&m_drawable_items_mutex);
+        drawable->setAttributeTable(m_attribute_table);
+    }
+    for(const auto& geometry : drawableGeometries(util::RectWorldCoord(util::PointWorldCoord(-180.0, 90.0), util::PointWorldCoord(180.0, -90.0))))
+    {
+        geometry->setAttributeTable(m_attribute_table);
+    }
+}
 
-            // Find the drawable item in the container.
-            const auto itr_find(std::find(m_drawable_items.begin(), m_drawable_items.end(), drawable));
-            if(itr_find != m_drawable_items.end())
-            {
-                // Remove the drawable item.
-                m_drawable_items.erase(itr_find);
+util::MemoryUsage Layer::memoryUsage() const
+{
+    // Fetch the current snapshot (the drawables are visited without blocking writers).
+    const auto snapshot(drawablesSnapshot());
+
+    // Gather the drawable items/geometries, and estimate the spatial index.
+    std::vector<std::shared_ptr<draw::Drawable>> drawables(snapshot->m_drawable_items.values());
+    std::size_t spatial_index_bytes(0);
+    std::size_t spatial_index_nodes(0);
+    for(const auto& bucket : snapshot->m_drawable_geometries)
+    {
+        // Add the bucket's geometry points.
+        std::vector<std::shared_ptr<draw::geometry::Geometry>> geometry_points;
+        bucket.second.m_drawable_geometries_points.values(geometry_points);
+        drawables.insert(drawables.end(), geometry_points.begin(), geometry_points.end());
+
+        // Add the bucket's fixed geometries.
+        drawables.insert(drawables.end(), bucket.second.m_drawable_geometries_fixed.begin(), bucket.second.m_drawable_geometries_fixed.end());
+
+        // Add the bucket's quadtree nodes and fixed geometry list.
+        spatial_index_bytes += sizeof(std::map<std::pair<int, int>, DrawablesBucket>::value_type) + (4 * sizeof(void*));
+        spatial_index_bytes += bucket.second.m_drawable_geometries_points.memoryBytes();
+        spatial_index_bytes += bucket.second.m_drawable_geometries_fixed.memoryBytes();
+        spatial_index_nodes += bucket.second.m_drawable_geometries_points.nodeCount();
+    }
+
+    // Estimate the drawables (grouped by drawable type) and their meta-data.
+    std::map<draw::DrawableType, std::pair<std::size_t, std::size_t>> drawables_by_type;
+    std::size_t metadata_bytes(0);
+    std::size_t metadata_layout_bytes(0);
+    std::size_t metadata_layout_count(0);
+    for(const auto& drawable : drawables)
+    {
+        auto& drawable_type(drawables_by_type[drawable->drawableType()]);
+        drawable_type.first += drawable->memoryBytes();
+        ++drawable_type.second;
+        metadata_bytes += drawable->metadataMemoryBytes();
 
-                // Update our success.
-                success = true;
+        // Add the geometry's meta-data text layout (if it has been laid out for display).
+        if(drawable->drawableType() == draw::DrawableType::Geometry)
+        {
+            const std::size_t layout_bytes(std::static_pointer_cast<draw::geometry::Geometry>(drawable)->metadataDisplayedLayoutMemoryBytes());
+            if(layout_bytes > 0)
+            {
+                metadata_layout_bytes += layout_bytes;
+                ++metadata_layout_count;
             }
         }
-        else
+    }
+
+    // Report the drawables, grouped by drawable type (the list of drawable items is held by the layer itself).
+    util::MemoryUsage drawables_usage("Drawables", snapshot->m_drawable_items.memoryBytes(), true, drawables.size());
+    for(const auto& drawable_type : drawables_by_type)
+    {
+        // Name the drawable type.
+        std::string name;
+        switch(drawable_type.first)
         {
-            // Handle the different geometry types.
-            const auto drawable_geometry(std::static_pointer_cast<draw::geometry::Geometry>(drawable));
-            if(drawable_geometry->geometryType() == draw::geometry::GeometryType::GeometryPoint)
+            // Is the drawable type a geometry.
+            case draw::DrawableType::Geometry:
             {
-                // Gain a write lock to protect the geometries container.
-                QWriteLocker locker(&m_drawable_geometries_mutex);
+                // Set the name.
+                name = "Geometries";
 
-                // Remove the geometry from the list.
-                m_drawable_geometries_points.erase(std::static_pointer_cast<draw::geometry::GeometryPoint>(drawable_geometry)->coord(), drawable_geometry);
+                // Finished.
+                break;
+            }
+            // Is the drawable type a map.
+            case draw::DrawableType::Map:
+            {
+                // Set the name.
+                name = "Maps";
 
-                // Update our success.
-                success = true;
+                // Finished.
+                break;
             }
-            else
+            // Is the drawable type an ESRI Shapefile.
+            case draw::DrawableType::ESRIShapefile:
             {
-                // Gain a write lock to protect the geometries container.
-                QWriteLocker locker(&m_drawable_geometries_mutex);
+                // Set the name.
+                name = "ESRI Shapefiles";
 
-                // Find the object in the container.
-                const auto itr_find(std::find(m_drawable_geometries_fixed.begin(), m_drawable_geometries_fixed.end(), std::static_pointer_cast<draw::geometry::GeometryFixed>(drawable_geometry)));
-                if(itr_find != m_drawable_geometries_fixed.end())
-                {
-                    // Remove the geometry from the list.
-                    m_drawable_geometries_fixed.erase(itr_find);
+                // Finished.
+                break;
+            }
+            // Is the drawable type a heatmap.
+            case draw::DrawableType::Heatmap:
+            {
+                // Set the name.
+                name = "Heatmaps";
 
-                    // Update our success.
-                    success = true;
-                }
+                // Finished.
+                break;
+            }
+            // Is the drawable type a geometry point collection.
+            case draw::DrawableType::GeometryPointCollection:
+            {
+                // Set the name.
+                name = "Geometry point collections";
+
+                // Finished.
+                break;
             }
         }
+
+        // Report the drawable type.
+        drawables_usage.addChild(util::MemoryUsage(name, drawable_type.second.first, true, drawable_type.second.second));
     }
 
-    // Was we successful?
-    if(success)
+    // Report the meta-data (including the attribute table, which may be shared with other layers).
+    util::MemoryUsage metadata_usage("Meta-data", metadata_bytes, true);
+    const auto attribute_table(attributeTable());
+    if(attribute_table != nullptr)
     {
-        // Disconnect any signals that were previously connected.
-        QObject::disconnect(drawable.get(), 0, this, 0);
+        metadata_usage.addChild(util::MemoryUsage("Attribute table", attribute_table->memoryBytes(), true, attribute_table->rowCount()));
+    }
+    metadata_usage.addChild(util::MemoryUsage("Text layouts", metadata_layout_bytes, true, metadata_layout_count));
 
-        // Should we redraw?
-        if(disable_redraw == false)
+    // Report the clusters (the cells at each zoom level, and the set of geometry points counted), if clustering is enabled.
+    std::unique_ptr<util::MemoryUsage> clusters_usage;
+    {
+        // Gain a read lock to protect the clusters.
+        QReadLocker clusters_locker(&m_clusters_mutex);
+
+        // Is clustering enabled?
+        if(m_clusters != nullptr)
         {
-            // Emit to redraw layer.
-            emit requestRedraw();
+            const std::size_t counted_bytes(m_clusters_counted.size() * (sizeof(const draw::geometry::Geometry*) + (4 * sizeof(void*))));
+            clusters_usage.reset(new util::MemoryUsage("Clusters", m_clusters->memoryBytes() + counted_bytes, true, m_clusters->cellCount()));
         }
     }
 
-    // Return our success.
-    return success;
+    // Report the layer.
+    util::MemoryUsage return_memory_usage(m_name, sizeof(Layer), true);
+    return_memory_usage.addChild(drawables_usage);
+    return_memory_usage.addChild(metadata_usage);
+    return_memory_usage.addChild(util::MemoryUsage("Spatial index", spatial_index_bytes, true, spatial_index_nodes));
+    if(clusters_usage != nullptr)
+    {
+        return_memory_usage.addChild(*clusters_usage);
+    }
+
+    // Return the memory used.
+    return return_memory_usage;
 }
 
-void Layer::clearDrawables(const bool& disable_redraw)
+std::vector<std::shared_ptr<draw::Drawable>> Layer::drawableItems() const
+{
+    // Return the drawable items from the current snapshot.
+    return drawablesSnapshot()->m_drawable_items.values();
+}
+
+std::vector<std::shared_ptr<draw::geometry::Geometry>> Layer::drawableGeometries(const util::RectWorldCoord& range_coord) const
 {
-    // Gain a write lock to protect the drawable items and geometries.
-    QWriteLocker locker_items(&m_drawable_items_mutex);
-    QWriteLocker locker_geometries(&m_drawable_geometries_mutex);
+    // Return the drawable geometries from the current snapshot (at all zoom levels).
+    return drawableGeometries(*drawablesSnapshot(), range_coord, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+}
 
-    // Remove all drawable items and geometries from the list.
-    m_drawable_items.clear();
-    m_drawable_geometries_points.clear();
-    m_drawable_geometries_fixed.clear();
+std::vector<std::shared_ptr<draw::geometry::Geometry>> Layer::drawableGeometries(const util::RectWorldCoord& range_coord, const int& zoom) const
+{
+    // Return the drawable geometries from the current snapshot (at the zoom level).
+    return drawableGeometries(*drawablesSnapshot(), range_coord, zoom, zoom);
+}
 
-    // Should we redraw?
-    if(disable_redraw == false)
-    {
-        // Emit to redraw layer.
-        emit requestRedraw();
-    }
+std::vector<std::shared_ptr<draw::geometry::Geometry>> Layer::drawableGeometries(const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const int& zoom_minimum, const int& zoom_maximum, const std::size_t& limit)
+{
+    // Populate the geometries container with geometry points (the query stops once the limit is reached).
+    std::set<std::shared_ptr<draw::geometry::Geometry>> geometry_points;
+    drawableGeometryPoints(geometry_points, snapshot, range_coord, zoom_minimum, zoom_maximum, limit);
+
+    // The geometries container to return, populate with geometry points.
+    std::vector<std::shared_ptr<draw::geometry::Geometry>> return_geometries(geometry_points.begin(), geometry_points.end());
+
+    // Add the fixed geometries (with the remaining limit).
+    drawableGeometriesFixed(return_geometries, snapshot, range_coord, zoom_minimum, zoom_maximum, limit);
+
+    // Return the list of geometries.
+    return return_geometries;
 }
 
-void Layer::mousePressEvent(const QMouseEvent* mouse_event, const Viewport& viewport, const qreal& fuzzy_factor_px) const
+void Layer::drawableGeometryPoints(std::set<std::shared_ptr<draw::geometry::Geometry>>& return_geometries, const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const int& zoom_minimum, const int& zoom_maximum, const std::size_t& limit)
 {
-    // Are mouse events enabled and is this layer visible?
-    if(isMouseEventsEnabled() && isVisible(viewport))
+    // Are the geometry points limited (hidden geometry points are then skipped, as they are never drawn)?
+    const bool limited(limit != std::numeric_limits<std::size_t>::max());
+
+    // Loop through each bucket within the zoom levels (stopping once the limit is reached).
+    for(auto itr_bucket(snapshot.m_drawable_geometries.begin()); itr_bucket != snapshot.m_drawable_geometries.end() && return_geometries.size() < limit; ++itr_bucket)
     {
-        // Is this a mouse press event?
-        if(mouse_event->type() == QEvent::MouseButtonPress)
+        // Is the bucket's zoom range within the zoom levels?
+        const auto& bucket(*itr_bucket);
+        if(bucket.first.first <= zoom_maximum && bucket.first.second >= zoom_minimum)
         {
-            // Is this a left-click event?
-            if(mouse_event->button() == Qt::LeftButton)
+            // Query the bucket's geometry points.
+            if(limited)
             {
-                // Calculate the mouse press world point in coords.
-                const util::PointWorldCoord mouse_point_coord(projection::toPointWorldCoord(viewport,  util::PointViewportPx(mouse_event->localPos().x(), mouse_event->localPos().y())));
+                bucket.second.m_drawable_geometries_points.query(return_geometries, range_coord, limit, [](const std::shared_ptr<draw::geometry::Geometry>& geometry) { return geometry->visible(); });
+            }
+            else
+            {
+                bucket.second.m_drawable_geometries_points.query(return_geometries, range_coord);
+            }
+        }
+    }
+}
 
-                // Calcaulte the comparison touches geometry area to use.
-                const draw::geometry::GeometryPointShape touches_area_coord(mouse_point_coord, QSizeF(fuzzy_factor_px, fuzzy_factor_px));
+void Layer::drawableGeometriesFixed(std::vector<std::shared_ptr<draw::geometry::Geometry>>& return_geometries, const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const int& zoom_minimum, const int& zoom_maximum, const std::size_t& limit)
+{
+    // Are the geometries limited (hidden fixed geometries are then skipped, as they are never drawn)?
+    const bool limited(limit != std::numeric_limits<std::size_t>::max());
 
-                // Check each drawable geometry to see it is contained in our touches geometry area.
-                for(const auto& drawable_geometry : drawableGeometries(touches_area_coord.boundingBox(viewport)))
+    // Loop through each bucket within the zoom levels (stopping once the limit is reached).
+    for(auto itr_bucket(snapshot.m_drawable_geometries.begin()); itr_bucket != snapshot.m_drawable_geometries.end() && return_geometries.size() < limit; ++itr_bucket)
+    {
+        // Is the bucket's zoom range within the zoom levels?
+        const auto& bucket(*itr_bucket);
+        if(bucket.first.first <= zoom_maximum && bucket.first.second >= zoom_minimum)
+        {
+            // Loop through the fixed geometries types (ellipse, line string, polygon), stopping once the limit is reached.
+            for(auto itr_geometry(bucket.second.m_drawable_geometries_fixed.begin()); itr_geometry != bucket.second.m_drawable_geometries_fixed.end() && return_geometries.size() < limit; ++itr_geometry)
+            {
+                // Does the query and geometry bounding box intersect?
+                const auto& geometry(*itr_geometry);
+                if((limited == false || geometry->visible()) && range_coord.intersects(geometry->boundingBoxFixed()))
                 {
-                    // Does they touch?
-                    if(drawable_geometry->touches(touches_area_coord, viewport))
-                    {
-                        // Emit that the geometry has been clicked.
-                        drawable_geometry->drawableClicked();
-                        drawableClicked(drawable_geometry);
-                    }
+                    // Add to the return geometries.
+                    return_geometries.push_back(geometry);
                 }
             }
         }
     }
 }
 
-void Layer::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+std::vector<std::shared_ptr<draw::geometry::Geometry>> Layer::displayedGeometries(std::vector<util::ClusterContainer::Cluster>& return_clusters, const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const Viewport& viewport, const std::size_t& limit) const
 {
-    // Loop through each drawable item.
-    for(const auto& drawable : drawableItems())
+    // The zoom level to display at.
+    const int zoom(viewport.zoom());
+
+    // Are the geometry points clustered at this zoom level?
+    bool clustered(false);
     {
-        // Save the current painter's state.
-        painter.save();
+        // Gain a read lock to protect the clusters.
+        QReadLocker locker(&m_clusters_mutex);
 
-        // Check the drawable item is visible.
-        if(drawable->isVisible(viewport))
+        // Is clustering enabled for this zoom level (and were the cells sized for this projection/tile size)?
+        if(m_clusters != nullptr && zoom <= m_clusters->zoomMaximum() && m_clusters->projection() == viewport.projection() && m_clusters->tileSizePx() == viewport.tileSizePx())
         {
-            // Draw the drawable item.
-            drawable->draw(painter, drawing_rect_world_coord, viewport);
+            // Fetch the clusters.
+            return_clusters = m_clusters->query(range_coord, zoom);
+            clustered = true;
         }
+    }
 
-        // Restore the painter's state.
-        painter.restore();
+    // The geometries container to return.
+    std::vector<std::shared_ptr<draw::geometry::Geometry>> return_geometries;
+
+    // Are the geometry points clustered?
+    if(clustered == false)
+    {
+        // Fetch all geometries (up to the limit).
+        return_geometries = drawableGeometries(snapshot, range_coord, zoom, zoom, limit);
     }
+    else
+    {
+        // Move the clusters that contain a single geometry point to the end, as they are displayed as the geometry point itself.
+        const auto itr_single(std::partition(return_clusters.begin(), return_clusters.end(), [](const util::ClusterContainer::Cluster& cluster) { return cluster.m_count > 1; }));
 
-    // Save the current painter's state.
-    painter.save();
+        // Populate the geometries container with the geometry points from those single clusters (stopping once the limit is reached).
+        std::set<std::shared_ptr<draw::geometry::Geometry>> geometry_points;
+        for(auto itr_cluster(itr_single); itr_cluster != return_clusters.end() && geometry_points.size() < limit; ++itr_cluster)
+        {
+            drawableGeometryPoints(geometry_points, snapshot, itr_cluster->m_cell_coord, zoom, zoom, limit);
+        }
+        return_clusters.erase(itr_single, return_clusters.end());
+        return_geometries.assign(geometry_points.begin(), geometry_points.end());
 
-    // Loop through each drawable geometry and draw it.
-    for(const auto& drawable_geometry : drawableGeometries(drawing_rect_world_coord))
+        // Add the fixed geometries (these are never clustered), with the remaining limit.
+        drawableGeometriesFixed(return_geometries, snapshot, range_coord, zoom, zoom, limit);
+    }
+
+    // Return the list of geometries.
+    return return_geometries;
+}
+
+bool Layer::addDrawable(const std::shared_ptr<draw::Drawable>& drawable, const bool& disable_redraw)
+{
+    // Add the drawable item/geometry as a batch of one.
+    return addDrawables(std::vector<std::shared_ptr<draw::Drawable>>{ drawable }, disable_redraw) == 1;
+}
+
+bool Layer::removeDrawable(const std::shared_ptr<draw::Drawable>& drawable, const bool& disable_redraw)
+{
+    // Remove the drawable item/geometry as a batch of one.
+    return removeDrawables(std::vector<std::shared_ptr<draw::Drawable>>{ drawable }, disable_redraw) == 1;
+}
+
+std::size_t Layer::addDrawables(const std::vector<std::shared_ptr<draw::Drawable>>& drawables, const bool& disable_redraw)
+{
+    // Split the drawables into the containers they are stored in (geometries are split by their zoom range bucket).
+    std::vector<std::shared_ptr<draw::Drawable>> drawable_items;
+    std::map<std::pair<int, int>, std::vector<std::pair<util::PointWorldCoord, std::shared_ptr<draw::geometry::Geometry>>>> drawable_geometries_points;
+    std::map<std::pair<int, int>, std::vector<std::shared_ptr<draw::geometry::GeometryFixed>>> drawable_geometries_fixed;
+    for(const auto& drawable : drawables)
     {
-        // Check the drawable geometry is visible.
-        if(drawable_geometry->isVisible(viewport))
+        // Check that the drawable item is valid.
+        if(drawable != nullptr)
         {
-            // Draw the drawable geometry and its meta-data displayed (if set).
-            drawable_geometry->draw(painter, drawing_rect_world_coord, viewport);
-            drawable_geometry->drawMetadataDisplayed(painter, viewport);
+            // Is this a drawable item (non-geometry)?
+            if(drawable->drawableType() != draw::DrawableType::Geometry)
+            {
+                // Add to the drawable items.
+                drawable_items.push_back(drawable);
+            }
+            else
+            {
+                // Handle the different drawable geometry types.
+                const auto drawable_geometry(std::static_pointer_cast<draw::geometry::Geometry>(drawable));
+                if(drawable_geometry->geometryType() == draw::geometry::GeometryType::GeometryPoint)
+                {
+                    // Add to the geometry points.
+                    drawable_geometries_points[zoomRange(*drawable_geometry)].emplace_back(std::static_pointer_cast<draw::geometry::GeometryPoint>(drawable_geometry)->coord(), drawable_geometry);
+                }
+                else
+                {
+                    // Add to the fixed geometries.
+                    drawable_geometries_fixed[zoomRange(*drawable_geometry)].push_back(std::static_pointer_cast<draw::geometry::GeometryFixed>(drawable_geometry));
+                }
+            }
         }
     }
 
-    // Restore the painter's state.
-    painter.restore();
+    // The drawables that were successfully added.
+    std::vector<std::shared_ptr<draw::Drawable>> drawables_added;
+    drawables_added.reserve(drawables.size());
+
+    // The geometries that were successfully added (these need to be re-bucketed when their zoom range changes).
+    std::vector<std::shared_ptr<draw::geometry::Geometry>> geometries_added;
+
+    // The geometry points that were successfully added (these need to be relocated when they move).
+    std::vector<std::shared_ptr<draw::geometry::GeometryPoint>> geometry_points_added;
+
+    // The geometry points, their points and zoom ranges that were successfully added (these need to be clustered).
+    std::vector<std::tuple<const draw::geometry::Geometry*, util::PointWorldCoord, std::pair<int, int>>> cluster_points_added;
+
+    // Do we have anything to add?
+    if(drawable_items.empty() == false || drawable_geometries_points.empty() == false || drawable_geometries_fixed.empty() == false)
+    {
+        // Gain a lock to serialise writers.
+        QMutexLocker locker(&m_drawables_write_mutex);
+
+        // Build the next snapshot from the current one (unmodified containers and quadtree nodes are shared).
+        const auto snapshot(std::make_shared<DrawablesSnapshot>(*drawablesSnapshot()));
+
+        // Do we have any drawable items to add?
+        if(drawable_items.empty() == false)
+        {
+            // Add the drawable items (only the last chunk of the drawable items is copied).
+            snapshot->m_drawable_items.append(drawable_items);
+
+            // Keep track of the drawable items added.
+            drawables_added.insert(drawables_added.end(), drawable_items.begin(), drawable_items.end());
+        }
+
+        // Loop through the geometry points to add for each zoom range bucket.
+        for(auto& bucket_points : drawable_geometries_points)
+        {
+            // Fetch the bucket (created if required).
+            auto& bucket(snapshot->m_drawable_geometries[bucket_points.first]);
+
+            // Remove any geometry points that fall outside of the points container.
+            const auto itr_outside(std::partition(bucket_points.second.begin(), bucket_points.second.end(), [&](const std::pair<util::PointWorldCoord, std::shared_ptr<draw::geometry::Geometry>>& point) { return bucket.m_drawable_geometries_points.boundary().contains(point.first); }));
+            bucket_points.second.erase(itr_outside, bucket_points.second.end());
+
+            // Keep track of the geometry points added.
+            for(const auto& point : bucket_points.second)
+            {
+                drawables_added.push_back(point.second);
+                geometries_added.push_back(point.second);
+                geometry_points_added.push_back(std::static_pointer_cast<draw::geometry::GeometryPoint>(point.second));
+                cluster_points_added.emplace_back(point.second.get(), point.first, bucket_points.first);
+            }
+
+            // Add the geometry points to the points container in bulk.
+            bucket.m_drawable_geometries_points.insert(std::move(bucket_points.second));
+        }
+
+        // Loop through the fixed geometries to add for each zoom range bucket.
+        for(const auto& bucket_fixed : drawable_geometries_fixed)
+        {
+            // Add the fixed geometries to the bucket (created if required).
+            addGeometriesFixed(snapshot->m_drawable_geometries[bucket_fixed.first], bucket_fixed.second);
+
+            // Keep track of the fixed geometries added.
+            drawables_added.insert(drawables_added.end(), bucket_fixed.second.begin(), bucket_fixed.second.end());
+            geometries_added.insert(geometries_added.end(), bucket_fixed.second.begin(), bucket_fixed.second.end());
+        }
+
+        // Publish the new snapshot.
+        publishDrawablesSnapshot(snapshot);
+
+        // Do we have any geometry points to cluster?
+        if(cluster_points_added.empty() == false)
+        {
+            // Gain a write lock to protect the clusters.
+            QWriteLocker clusters_locker(&m_clusters_mutex);
+
+            // Add each (visible) geometry point to the clusters.
+            for(const auto& point : cluster_points_added)
+            {
+                clusterInsert(std::get<0>(point), std::get<1>(point), std::get<2>(point));
+            }
+        }
+    }
+
+    // Was we successful?
+    if(drawables_added.empty() == false)
+    {
+        // Connect signal/slot to pass on redraw requests (done after the containers are unlocked).
+        for(const auto& drawable : drawables_added)
+        {
+            const std::weak_ptr<draw::Drawable> drawable_weak(drawable);
+            QObject::connect(drawable.get(), &draw::Drawable::requestRedraw, this, [this, drawable_weak]() { invalidate(drawable_weak.lock()); });
+        }
+
+        // Store the meta-data of the drawables added in the attribute table (if set).
+        const auto attribute_table(attributeTable());
+        if(attribute_table != nullptr)
+        {
+            for(const auto& drawable : drawables_added)
+            {
+                drawable->setAttributeTable(attribute_table);
+            }
+        }
+
+        // Connect signal/slot to re-bucket geometries when their zoom range changes (direct, so the buckets are updated before the redraw).
+        for(const auto& geometry : geometries_added)
+        {
+            const std::weak_ptr<draw::geometry::Geometry> geometry_weak(geometry);
+            QObject::connect(geometry.get(), &draw::Drawable::zoomRangeChanged, this, [this, geometry_weak](const int& previous_zoom_minimum, const int& previous_zoom_maximum) { rebucketGeometry(geometry_weak.lock(), std::make_pair(previous_zoom_minimum, previous_zoom_maximum)); }, Qt::DirectConnection);
+        }
+
+        // Connect signal/slot to add/remove geometry points to/from the clusters when their visibility changes (direct, so the clusters are updated before the redraw).
+        for(const auto& geometry_point : geometry_points_added)
+        {
+            const std::weak_ptr<draw::geometry::Geometry> geometry_weak(geometry_point);
+            QObject::connect(geometry_point.get(), &draw::Drawable::visibilityChanged, this, [this, geometry_weak]() { reclusterGeometryPoint(geometry_weak.lock()); }, Qt::DirectConnection);
+        }
+
+        // Connect signal/slot to relocate geometry points when they move (direct, so the index is updated before the redraw, and their previous point is redrawn).
+        for(const auto& geometry_point : geometry_points_added)
+        {
+            const std::weak_ptr<draw::geometry::Geometry> geometry_weak(geometry_point);
+            QObject::connect(geometry_point.get(), &draw::geometry::GeometryPoint::coordChanged, this, [this, geometry_weak](const util::PointWorldCoord& previous_point_coord) { geometryPointMoved(geometry_weak.lock(), previous_point_coord); }, Qt::DirectConnection);
+        }
+
+        // Should we redraw?
+        if(disable_redraw == false)
+        {
+            // Request a redraw of the layer.
+            invalidate();
+        }
+    }
+
+    // Return the number of drawables added.
+    return drawables_added.size();
+}
+
+std::size_t Layer::removeDrawables(const std::vector<std::shared_ptr<draw::Drawable>>& drawables, const bool& disable_redraw)
+{
+    // Split the drawables into the containers they are stored in (geometries are split by their zoom range bucket).
+    std::set<std::shared_ptr<draw::Drawable>> drawable_items;
+    std::map<std::pair<int, int>, std::vector<std::pair<util::PointWorldCoord, std::shared_ptr<draw::geometry::Geometry>>>> drawable_geometries_points;
+    std::map<std::pair<int, int>, std::set<std::shared_ptr<draw::geometry::GeometryFixed>>> drawable_geometries_fixed;
+    for(const auto& drawable : drawables)
+    {
+        // Check that the drawable item is valid.
+        if(drawable != nullptr)
+        {
+            // Is this a drawable item (non-geometry)?
+            if(drawable->drawableType() != draw::DrawableType::Geometry)
+            {
+                // Add to the drawable items.
+                drawable_items.insert(drawable);
+            }
+            else
+            {
+                // Handle the different geometry types.
+                const auto drawable_geometry(std::static_pointer_cast<draw::geometry::Geometry>(drawable));
+                if(drawable_geometry->geometryType() == draw::geometry::GeometryType::GeometryPoint)
+                {
+                    // Add to the geometry points.
+                    drawable_geometries_points[zoomRange(*drawable_geometry)].emplace_back(std::static_pointer_cast<draw::geometry::GeometryPoint>(drawable_geometry)->coord(), drawable_geometry);
+                }
+                else
+                {
+                    // Add to the fixed geometries.
+                    drawable_geometries_fixed[zoomRange(*drawable_geometry)].insert(std::static_pointer_cast<draw::geometry::GeometryFixed>(drawable_geometry));
+                }
+            }
+        }
+    }
+
+    // The drawables that were successfully removed.
+    std::vector<std::shared_ptr<draw::Drawable>> drawables_removed;
+
+    // The geometry points, their points and zoom ranges that were successfully removed (these need to be removed from the clusters).
+    std::vector<std::tuple<const draw::geometry::Geometry*, util::PointWorldCoord, std::pair<int, int>>> cluster_points_removed;
+
+    // Do we have anything to remove?
+    if(drawable_items.empty() == false || drawable_geometries_points.empty() == false || drawable_geometries_fixed.empty() == false)
+    {
+        // Gain a lock to serialise writers.
+        QMutexLocker locker(&m_drawables_write_mutex);
+
+        // Build the next snapshot from the current one (unmodified containers and quadtree nodes are shared).
+        const auto snapshot(std::make_shared<DrawablesSnapshot>(*drawablesSnapshot()));
+
+        // Do we have any drawable items to remove?
+        if(drawable_items.empty() == false)
+        {
+            // Remove the drawable items (only the chunks that contain them are copied), and keep track of the drawable items removed.
+            const auto drawable_items_removed(snapshot->m_drawable_items.erase(drawable_items));
+            drawables_removed.insert(drawables_removed.end(), drawable_items_removed.begin(), drawable_items_removed.end());
+        }
+
+        // Loop through the geometry points to remove for each zoom range bucket.
+        for(const auto& bucket_points : drawable_geometries_points)
+        {
+            // Does the bucket exist?
+            const auto itr_bucket(snapshot->m_drawable_geometries.find(bucket_points.first));
+            if(itr_bucket != snapshot->m_drawable_geometries.end())
+            {
+                // Loop through each geometry point to remove.
+                for(const auto& point : bucket_points.second)
+                {
+                    // Remove the geometry from the points container.
+                    if(itr_bucket->second.m_drawable_geometries_points.erase(point.first, point.second))
+                    {
+                        // Keep track of the geometry point removed.
+                        drawables_removed.push_back(point.second);
+                        cluster_points_removed.emplace_back(point.second.get(), point.first, bucket_points.first);
+                    }
+                }
+            }
+        }
+
+        // Loop through the fixed geometries to remove for each zoom range bucket.
+        for(const auto& bucket_fixed : drawable_geometries_fixed)
+        {
+            // Does the bucket exist?
+            const auto itr_bucket(snapshot->m_drawable_geometries.find(bucket_fixed.first));
+            if(itr_bucket != snapshot->m_drawable_geometries.end())
+            {
+                // Remove the fixed geometries, and keep track of the fixed geometries removed.
+                const auto geometries_fixed_removed(removeGeometriesFixed(itr_bucket->second, bucket_fixed.second));
+                drawables_removed.insert(drawables_removed.end(), geometries_fixed_removed.begin(), geometries_fixed_removed.end());
+            }
+        }
+
+        // Publish the new snapshot.
+        publishDrawablesSnapshot(snapshot);
+
+        // Do we have any geometry points to remove from the clusters?
+        if(cluster_points_removed.empty() == false)
+        {
+            // Gain a write lock to protect the clusters.
+            QWriteLocker clusters_locker(&m_clusters_mutex);
+
+            // Remove each (counted) geometry point from the clusters.
+            for(const auto& point : cluster_points_removed)
+            {
+                clusterErase(std::get<0>(point), std::get<1>(point), std::get<2>(point));
+            }
+        }
+    }
+
+    // Was we successful?
+    if(drawables_removed.empty() == false)
+    {
+        // Disconnect any signals that were previously connected (done after the containers are unlocked).
+        for(const auto& drawable : drawables_removed)
+        {
+            QObject::disconnect(drawable.get(), 0, this, 0);
+        }
+
+        // Should we redraw?
+        if(disable_redraw == false)
+        {
+            // Request a redraw of the layer.
+            invalidate();
+        }
+    }
+
+    // Return the number of drawables removed.
+    return drawables_removed.size();
+}
+
+void Layer::clearDrawables(const bool& disable_redraw)
+{
+    // Gain a lock to serialise writers.
+    QMutexLocker locker(&m_drawables_write_mutex);
+
+    // Take the current snapshot, and publish an empty snapshot (readers still holding the previous snapshot release it when they finish).
+    std::shared_ptr<const DrawablesSnapshot> snapshot(drawablesSnapshot());
+    publishDrawablesSnapshot(std::make_shared<const DrawablesSnapshot>());
+
+    // Take the current clusters, and replace them with empty clusters.
+    std::shared_ptr<util::ClusterContainer> clusters;
+    {
+        // Gain a write lock to protect the clusters.
+        QWriteLocker clusters_locker(&m_clusters_mutex);
+
+        // Is clustering enabled?
+        if(m_clusters != nullptr)
+        {
+            // Create empty clusters with the same settings, and take the current clusters.
+            std::unique_ptr<util::ClusterContainer> clusters_empty(new util::ClusterContainer(m_clusters->zoomMaximum(), m_clusters->cellSizePx(), m_clusters->projection(), m_clusters->tileSizePx()));
+            clusters.reset(m_clusters.release());
+            m_clusters = std::move(clusters_empty);
+            m_clusters_counted.clear();
+        }
+    }
+
+    // Gather the drawable items/geometries from the previous snapshot, so that they are kept alive until they are released.
+    std::vector<std::shared_ptr<draw::Drawable>> drawables(snapshot->m_drawable_items.values());
+    for(const auto& bucket : snapshot->m_drawable_geometries)
+    {
+        // Add the bucket's geometry points.
+        std::vector<std::shared_ptr<draw::geometry::Geometry>> geometry_points;
+        bucket.second.m_drawable_geometries_points.values(geometry_points);
+        drawables.insert(drawables.end(), geometry_points.begin(), geometry_points.end());
+
+        // Add the bucket's fixed geometries.
+        for(const auto& geometry_fixed : bucket.second.m_drawable_geometries_fixed)
+        {
+            drawables.push_back(geometry_fixed);
+        }
+    }
+
+    // Release the previous snapshot and clusters (only their storage, the drawables are still referenced).
+    snapshot.reset();
+    clusters.reset();
+
+    // Unlock the writers.
+    locker.unlock();
+
+    // Disconnect any signals that were previously connected (cleared drawables that are still referenced elsewhere must not update this layer).
+    for(const auto& drawable : drawables)
+    {
+        QObject::disconnect(drawable.get(), 0, this, 0);
+    }
+
+    // Hand the drawables over to be released.
+    bool release_scheduled(false);
+    {
+        // Gain a lock to protect the drawables waiting to be released.
+        QMutexLocker released_locker(&m_drawables_released_mutex);
+
+        // A release is already scheduled if drawables are still waiting.
+        release_scheduled = m_drawables_released.empty() == false;
+
+        // Add the drawables.
+        if(m_drawables_released.empty())
+        {
+            m_drawables_released.swap(drawables);
+        }
+        else
+        {
+            m_drawables_released.insert(m_drawables_released.end(), std::make_move_iterator(drawables.begin()), std::make_move_iterator(drawables.end()));
+        }
+    }
+
+    // Schedule the release on the layer's thread (a zero timeout is queued to the event loop, so this is safe from any thread).
+    if(release_scheduled == false)
+    {
+        QTimer::singleShot(0, this, SLOT(releaseDrawables()));
+    }
+
+    // Should we redraw?
+    if(disable_redraw == false)
+    {
+        // Request a redraw of the layer.
+        invalidate();
+    }
+}
+
+void Layer::releaseDrawables()
+{
+    // Take the next batch of drawables to release.
+    std::vector<std::shared_ptr<draw::Drawable>> drawables;
+    bool remaining(false);
+    {
+        // Gain a lock to protect the drawables waiting to be released.
+        QMutexLocker released_locker(&m_drawables_released_mutex);
+
+        // Move the batch out of the drawables waiting (from the end, so the remaining drawables are not moved).
+        const std::size_t count(std::min(m_drawables_released.size(), std::size_t(m_drawables_released_batch_size)));
+        const auto itr_batch(m_drawables_released.end() - static_cast<std::ptrdiff_t>(count));
+        drawables.assign(std::make_move_iterator(itr_batch), std::make_move_iterator(m_drawables_released.end()));
+        m_drawables_released.erase(itr_batch, m_drawables_released.end());
+
+        // Release the storage once everything has been taken.
+        remaining = m_drawables_released.empty() == false;
+        if(remaining == false)
+        {
+            std::vector<std::shared_ptr<draw::Drawable>>().swap(m_drawables_released);
+        }
+    }
+
+    // Release the batch (the last references are normally dropped here, on the layer's thread).
+    drawables.clear();
+
+    // Schedule the next batch, returning to the event loop in between.
+    if(remaining)
+    {
+        QTimer::singleShot(0, this, SLOT(releaseDrawables()));
+    }
+}
+
+void Layer::queueAddDrawable(const std::shared_ptr<draw::Drawable>& drawable)
+{
+    // Queue the update.
+    m_pending_updates.push(Update { UpdateType::Add, drawable, util::PointWorldCoord(0.0, 0.0), nullptr, nullptr });
+}
+
+void Layer::queueRemoveDrawable(const std::shared_ptr<draw::Drawable>& drawable)
+{
+    // Queue the update.
+    m_pending_updates.push(Update { UpdateType::Remove, drawable, util::PointWorldCoord(0.0, 0.0), nullptr, nullptr });
+}
+
+void Layer::queueMoveGeometryPoint(const std::shared_ptr<draw::geometry::GeometryPoint>& geometry_point, const util::PointWorldCoord& point_coord)
+{
+    // Queue the update.
+    m_pending_updates.push(Update { UpdateType::Move, geometry_point, point_coord, nullptr, nullptr });
+}
+
+void Layer::queueRestyleGeometry(const std::shared_ptr<draw::geometry::Geometry>& geometry, const std::shared_ptr<QPen>& pen, const std::shared_ptr<QBrush>& brush)
+{
+    // Queue the update.
+    m_pending_updates.push(Update { UpdateType::Restyle, geometry, util::PointWorldCoord(0.0, 0.0), pen, brush });
+}
+
+void Layer::beginUpdate()
+{
+    // Gain a lock to protect the update state.
+    QMutexLocker locker(&m_update_mutex);
+
+    // Increase the number of updates in progress.
+    ++m_update_depth;
+}
+
+void Layer::endUpdate()
+{
+    // Whether to redraw the whole layer or a region.
+    bool invalidate_all(false);
+    bool invalidate_region(false);
+    util::RectWorldCoord region_coord;
+    {
+        // Gain a lock to protect the update state.
+        QMutexLocker locker(&m_update_mutex);
+
+        // Decrease the number of updates in progress, is this the outermost update?
+        if(m_update_depth > 0 && --m_update_depth == 0)
+        {
+            // Take the changes collected.
+            invalidate_all = m_update_invalidate_all;
+            invalidate_region = m_update_invalidate_region;
+            region_coord = m_update_region_coord;
+
+            // Reset the changes collected.
+            m_update_invalidate_all = false;
+            m_update_invalidate_region = false;
+            m_update_region_coord = util::RectWorldCoord();
+        }
+    }
+
+    // Emit a single redraw request for the changes collected (done after the update state is unlocked).
+    if(invalidate_all)
+    {
+        emit requestRedraw();
+    }
+    else if(invalidate_region)
+    {
+        emit requestRedrawRegion(region_coord);
+    }
+}
+
+bool Layer::hasPendingUpdates() const
+{
+    // Return whether the queue has any updates.
+    return m_pending_updates.empty() == false;
+}
+
+std::size_t Layer::processPendingUpdates()
+{
+    // Take all of the queued updates.
+    const std::vector<Update> updates(m_pending_updates.take());
+
+    // Loop through each run of updates of the same type (each run is applied as a batch, which keeps the updates in order).
+    auto itr_update(updates.begin());
+    while(itr_update != updates.end())
+    {
+        // Find the end of the run.
+        const UpdateType run_type(itr_update->m_type);
+        const auto itr_run_end(std::find_if(itr_update, updates.end(), [&](const Update& update) { return update.m_type != run_type; }));
+
+        // Handle the different update types.
+        switch(run_type)
+        {
+            case UpdateType::Add:
+            case UpdateType::Remove:
+            {
+                // Collect the drawables in the run.
+                std::vector<std::shared_ptr<draw::Drawable>> drawables;
+                drawables.reserve(std::distance(itr_update, itr_run_end));
+                for(auto itr_run(itr_update); itr_run != itr_run_end; ++itr_run)
+                {
+                    drawables.push_back(itr_run->m_drawable);
+                }
+
+                // Add/remove the drawables as a batch.
+                if(run_type == UpdateType::Add)
+                {
+                    addDrawables(drawables, true);
+                }
+                else
+                {
+                    removeDrawables(drawables, true);
+                }
+
+                // Finished.
+                break;
+            }
+            case UpdateType::Move:
+            {
+                // Loop through each geometry point in the run.
+                std::vector<std::pair<std::shared_ptr<draw::geometry::Geometry>, util::PointWorldCoord>> geometry_points;
+                geometry_points.reserve(std::distance(itr_update, itr_run_end));
+                for(auto itr_run(itr_update); itr_run != itr_run_end; ++itr_run)
+                {
+                    // Check that the geometry point is valid.
+                    const auto geometry_point(std::static_pointer_cast<draw::geometry::GeometryPoint>(itr_run->m_drawable));
+                    if(geometry_point != nullptr)
+                    {
+                        // Set the new point without emitting any signals, as the geometry points are relocated together below.
+                        util::PointWorldCoord previous_point_coord(itr_run->m_point_coord);
+                        if(geometry_point->exchangeCoord(itr_run->m_point_coord, previous_point_coord))
+                        {
+                            // Keep track of the previous point.
+                            geometry_points.emplace_back(geometry_point, previous_point_coord);
+                        }
+                    }
+                }
+
+                // Relocate the geometry points that have moved as a batch.
+                if(geometry_points.empty() == false)
+                {
+                    relocateGeometryPoints(geometry_points);
+                }
+
+                // Finished.
+                break;
+            }
+            case UpdateType::Restyle:
+            {
+                // Loop through each geometry in the run.
+                for(auto itr_run(itr_update); itr_run != itr_run_end; ++itr_run)
+                {
+                    // Check that the geometry is valid.
+                    const auto geometry(std::static_pointer_cast<draw::geometry::Geometry>(itr_run->m_drawable));
+                    if(geometry != nullptr)
+                    {
+                        // Set the new pen/brush without emitting any signals, as this is applied at the start of a frame.
+                        geometry->restyle(itr_run->m_pen, itr_run->m_brush);
+                    }
+                }
+
+                // Finished.
+                break;
+            }
+        }
+
+        // Move on to the next run.
+        itr_update = itr_run_end;
+    }
+
+    // Return the number of updates processed.
+    return updates.size();
+}
+
+void Layer::mousePressEvent(const QMouseEvent* mouse_event, const Viewport& viewport, const qreal& fuzzy_factor_px) const
+{
+    // Are mouse events enabled and is this layer visible?
+    if(isMouseEventsEnabled() && isVisible(viewport))
+    {
+        // Is this a mouse press event?
+        if(mouse_event->type() == QEvent::MouseButtonPress)
+        {
+            // Is this a left-click event?
+            if(mouse_event->button() == Qt::LeftButton)
+            {
+                // Calculate the mouse press world point in coords.
+                const util::PointWorldCoord mouse_point_coord(projection::toPointWorldCoord(viewport,  util::PointViewportPx(mouse_event->localPos().x(), mouse_event->localPos().y())));
+
+                // Calcaulte the comparison touches geometry area to use.
+                const draw::geometry::GeometryPointShape touches_area_coord(mouse_point_coord, QSizeF(fuzzy_factor_px, fuzzy_factor_px));
+
+                // Calculate the search area to use, which also covers any cluster symbols that could be drawn under the mouse.
+                const qreal search_size_px(fuzzy_factor_px + 2.0 * clusterRadiusPx(std::numeric_limits<std::size_t>::max()));
+                const draw::geometry::GeometryPointShape search_area_coord(mouse_point_coord, QSizeF(search_size_px, search_size_px));
+
+                // Fetch the displayed geometries and clusters.
+                const auto snapshot(drawablesSnapshot());
+                std::vector<util::ClusterContainer::Cluster> clusters;
+                const auto drawable_geometries(displayedGeometries(clusters, *snapshot, search_area_coord.boundingBox(viewport), viewport));
+
+                // Loop through each cluster.
+                const util::PointWorldPx mouse_point_px(projection::toPointWorldPx(viewport, mouse_point_coord));
+                for(const auto& cluster : clusters)
+                {
+                    // Is the mouse within the cluster symbol?
+                    const util::PointWorldPx cluster_point_px(projection::toPointWorldPx(viewport, cluster.m_point_coord));
+                    if(QLineF(mouse_point_px, cluster_point_px).length() <= clusterRadiusPx(cluster.m_count) + fuzzy_factor_px)
+                    {
+                        // Emit that the cluster has been clicked.
+                        emit clusterClicked(cluster.m_point_coord, cluster.m_count);
+                    }
+                }
+
+                // Check each drawable geometry to see it is contained in our touches geometry area.
+                for(const auto& drawable_geometry : drawable_geometries)
+                {
+                    // Does they touch?
+                    if(drawable_geometry->touches(touches_area_coord, viewport))
+                    {
+                        // Emit that the geometry has been clicked.
+                        drawable_geometry->drawableClicked();
+                        drawableClicked(drawable_geometry);
+                    }
+                }
+
+                // Check each drawable point collection to see which of its points are contained in our touches geometry area.
+                for(const auto& drawable : snapshot->m_drawable_items)
+                {
+                    // Is this a point collection?
+                    if(drawable->drawableType() == draw::DrawableType::GeometryPointCollection)
+                    {
+                        // Fetch the points that touch.
+                        const auto geometry_point_collection(std::static_pointer_cast<draw::geometry::GeometryPointCollection>(drawable));
+                        const auto indices(geometry_point_collection->touches(touches_area_coord, viewport));
+                        if(indices.empty() == false)
+                        {
+                            // Emit that the points have been clicked.
+                            geometry_point_collection->pointsClicked(indices);
+                            geometry_point_collection->drawableClicked();
+                            drawableClicked(drawable);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Layer::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+{
+    // Take the current snapshot, so that the whole layer is drawn from a consistent version without holding any locks.
+    const auto snapshot(drawablesSnapshot());
+
+    // Keep track of the viewport drawn with, so that changed geometries can invalidate the pixels they cover.
+    {
+        // Gain a lock to protect the last drawn viewport.
+        QMutexLocker locker(&m_drawn_viewport_mutex);
+
+        // Copy the viewport.
+        m_drawn_viewport.reset(new Viewport(viewport));
+    }
+
+    // Loop through each drawable item.
+    for(const auto& drawable : snapshot->m_drawable_items)
+    {
+        // Save the current painter's state (custom drawable items may change any of it).
+        painter.save();
+
+        // Check the drawable item is visible.
+        if(drawable->isVisible(viewport))
+        {
+            // Draw the drawable item.
+            drawable->draw(painter, drawing_rect_world_coord, viewport);
+        }
+
+        // Restore the painter's state.
+        painter.restore();
+    }
+
+    // Save the current painter's state (once for all of the geometries, each geometry sets the pen/brush it draws with).
+    painter.save();
+
+    // Take a copy of the geometry budget and sub-pixel culling settings for this frame.
+    std::size_t geometry_budget(0);
+    std::string geometry_budget_priority_key;
+    qreal sub_pixel_threshold_px(0.0);
+    bool sub_pixel_collapse_to_dots(false);
+    {
+        // Gain a lock to protect the geometry budget and sub-pixel culling settings.
+        QMutexLocker locker(&m_geometry_budget_mutex);
+
+        // Copy the settings.
+        geometry_budget = m_geometry_budget;
+        geometry_budget_priority_key = m_geometry_budget_priority_key;
+        sub_pixel_threshold_px = m_sub_pixel_threshold_px;
+        sub_pixel_collapse_to_dots = m_sub_pixel_collapse_to_dots;
+    }
+
+    // Fetch the displayed geometries (the query stops at the budget when there are no priorities to choose by).
+    std::vector<util::ClusterContainer::Cluster> clusters;
+    const std::size_t geometry_limit(geometry_budget > 0 && geometry_budget_priority_key.empty() ? geometry_budget : std::numeric_limits<std::size_t>::max());
+    auto drawable_geometries(displayedGeometries(clusters, *snapshot, drawing_rect_world_coord, viewport, geometry_limit));
+
+    // Thin the geometries to the budget (before anything is projected).
+    thinGeometries(drawable_geometries, geometry_budget, geometry_budget_priority_key);
+
+    // Are labels decluttered (labels are placed in drawing order, which is the same every frame)?
+    const bool label_decluttering_enabled(m_label_decluttering_enabled);
+    util::CollisionGrid label_collision_grid;
+
+    // Are geometries drawn grouped by their style?
+    if(m_style_sorting_enabled)
+    {
+        // Fetch each geometry's geometry type and style (pen/brush values, so the grouping is the same every frame), with its drawing order.
+        typedef std::tuple<int, QRgb, qreal, int, QRgb, int> StyleKey;
+        std::vector<std::pair<StyleKey, std::size_t>> style_keys;
+        style_keys.reserve(drawable_geometries.size());
+        for(std::size_t i = 0; i < drawable_geometries.size(); ++i)
+        {
+            const QPen pen(drawable_geometries[i]->pen());
+            const QBrush brush(drawable_geometries[i]->brush());
+            style_keys.emplace_back(StyleKey(int(drawable_geometries[i]->geometryType()), pen.color().rgba(), pen.widthF(), int(pen.style()), brush.color().rgba(), int(brush.style())), i);
+        }
+
+        // Group the geometries by their geometry type and style, keeping the relative order within each group.
+        std::stable_sort(style_keys.begin(), style_keys.end(), [](const std::pair<StyleKey, std::size_t>& lhs, const std::pair<StyleKey, std::size_t>& rhs) { return lhs.first < rhs.first; });
+        std::vector<std::shared_ptr<draw::geometry::Geometry>> sorted_geometries;
+        sorted_geometries.reserve(drawable_geometries.size());
+        for(const auto& style_key : style_keys)
+        {
+            sorted_geometries.push_back(std::move(drawable_geometries[style_key.second]));
+        }
+        drawable_geometries.swap(sorted_geometries);
+    }
+
+    // Loop through each drawable geometry and draw it.
+    // Consecutive image points are batched by their image pixmap, and consecutive line strings by their pen, so that each batch is drawn with a single call.
+    std::map<QRgb, QPolygonF> collapsed_points_px;
+    std::map<qint64, ImageBatch> image_batches;
+    std::vector<draw::geometry::Geometry*> image_labels;
+    util::ScratchBuffers& scratch_buffers(util::ScratchBuffers::local());
+    PolylineBatch polyline_batch { QPen(), scratch_buffers.batchPointsPx(), scratch_buffers.batchPolylineSizes(), std::vector<draw::geometry::Geometry*>() };
+    for(const auto& drawable_geometry : drawable_geometries)
+    {
+        // Check the drawable geometry is visible.
+        if(drawable_geometry->isVisible(viewport))
+        {
+            // Is sub-pixel culling enabled and is this a fixed geometry?
+            bool culled(false);
+            if(sub_pixel_threshold_px > 0.0 && drawable_geometry->geometryType() != draw::geometry::GeometryType::GeometryPoint)
+            {
+                // Calculate the projected size of the fixed bounding box.
+                const util::RectWorldCoord& bounding_box_coord(std::static_pointer_cast<draw::geometry::GeometryFixed>(drawable_geometry)->boundingBoxFixed());
+                const QRectF bounding_box_px(QRectF(projection::toPointWorldPx(viewport, bounding_box_coord.topLeftCoord()), projection::toPointWorldPx(viewport, bounding_box_coord.bottomRightCoord())).normalized());
+
+                // The geometry is culled if it is too small to draw in full.
+                culled = bounding_box_px.width() < sub_pixel_threshold_px && bounding_box_px.height() < sub_pixel_threshold_px;
+
+                // Collapse the culled geometry into a dot (batched by pen colour), if required.
+                if(culled && sub_pixel_collapse_to_dots)
+                {
+                    collapsed_points_px[drawable_geometry->pen().color().rgba()].append(bounding_box_px.center());
+                }
+            }
+
+            // Is the geometry text that collides with a label already placed?
+            if(culled == false && label_decluttering_enabled)
+            {
+                // Fetch the geometry's text rect.
+                const QRectF text_rect_px(drawable_geometry->textRectPx(viewport));
+
+                // The geometry is culled if its text cannot be placed.
+                culled = text_rect_px.isEmpty() == false && label_collision_grid.insert(text_rect_px) == false;
+            }
+
+            // Check the drawable geometry has not been culled.
+            if(culled == false)
+            {
+                // Is the drawable geometry an image point?
+                const auto geometry_point_image(drawable_geometry->geometryType() == draw::geometry::GeometryType::GeometryPoint ? dynamic_cast<const draw::geometry::GeometryPointImage*>(drawable_geometry.get()) : nullptr);
+                if(geometry_point_image != nullptr)
+                {
+                    // Draw the pending line strings first (to keep the drawing order).
+                    drawPolylineBatch(painter, polyline_batch, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+
+                    // Fetch the batch for the image pixmap.
+                    const QPixmap& image(geometry_point_image->image());
+                    ImageBatch& image_batch(image_batches[image.cacheKey()]);
+                    if(image_batch.m_fragments.empty())
+                    {
+                        // Capture the image pixmap for the batch.
+                        image_batch.m_pixmap = image;
+                    }
+
+                    // Add the image point to the batch (its meta-data displayed is drawn once the batch has been drawn).
+                    image_batch.m_fragments.push_back(geometry_point_image->pixmapFragment(viewport));
+                    image_labels.push_back(drawable_geometry.get());
+                }
+                else if(drawable_geometry->geometryType() == draw::geometry::GeometryType::GeometryLineString)
+                {
+                    // Draw the pending image points first (to keep the drawing order).
+                    drawImageBatches(painter, image_batches, image_labels, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+
+                    // Draw the pending line strings first if they use a different pen (compared by value).
+                    const QPen pen(drawable_geometry->pen());
+                    if(polyline_batch.m_labels.empty() == false && polyline_batch.m_pen != pen)
+                    {
+                        drawPolylineBatch(painter, polyline_batch, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+                    }
+                    polyline_batch.m_pen = pen;
+
+                    // Add the line string's polylines to the batch (its meta-data displayed is drawn once the batch has been drawn).
+                    std::static_pointer_cast<draw::geometry::GeometryLineString>(drawable_geometry)->appendPolylinesPx(drawing_rect_world_coord, viewport, polyline_batch.m_points_px, polyline_batch.m_polyline_sizes);
+                    polyline_batch.m_labels.push_back(drawable_geometry.get());
+                }
+                else
+                {
+                    // Draw the pending image points and line strings first (to keep the drawing order).
+                    drawImageBatches(painter, image_batches, image_labels, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+                    drawPolylineBatch(painter, polyline_batch, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+
+                    // Draw the drawable geometry and its meta-data displayed (if set, decluttered against the labels already placed).
+                    drawable_geometry->draw(painter, drawing_rect_world_coord, viewport);
+                    drawable_geometry->drawMetadataDisplayed(painter, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+                }
+            }
+        }
+    }
+
+    // Draw the remaining pending image points and line strings.
+    drawImageBatches(painter, image_batches, image_labels, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+    drawPolylineBatch(painter, polyline_batch, viewport, label_decluttering_enabled ? &label_collision_grid : nullptr);
+
+    // Loop through each batch of collapsed geometries and draw them as dots.
+    for(const auto& collapsed_points : collapsed_points_px)
+    {
+        // Set the pen to draw the dots with.
+        painter.setPen(QPen(QColor::fromRgba(collapsed_points.first)));
+
+        // Draw the dots.
+        painter.drawPoints(collapsed_points.second);
+    }
+
+    // Do we have any clusters to draw?
+    if(clusters.empty() == false)
+    {
+        // Set the pen/brush to draw the clusters with.
+        {
+            // Gain a read lock to protect the cluster pen/brush.
+            QReadLocker locker(&m_clusters_mutex);
+
+            // Set the pen/brush.
+            painter.setPen(m_cluster_pen);
+            painter.setBrush(m_cluster_brush);
+        }
+
+        // Loop through each cluster and draw it (on top of the geometries).
+        for(const auto& cluster : clusters)
+        {
+            // Calculate the cluster symbol in pixels.
+            const util::PointWorldPx cluster_point_px(projection::toPointWorldPx(viewport, cluster.m_point_coord));
+            const qreal radius_px(clusterRadiusPx(cluster.m_count));
+            const QRectF cluster_rect_px(cluster_point_px.x() - radius_px, cluster_point_px.y() - radius_px, radius_px * 2.0, radius_px * 2.0);
+
+            // Draw the cluster symbol and its count.
+            painter.drawEllipse(cluster_rect_px);
+            painter.drawText(cluster_rect_px, Qt::AlignCenter, QString::number(cluster.m_count));
+        }
+    }
+
+    // Restore the painter's state.
+    painter.restore();
+}
+
+void Layer::invalidate()
+{
+    // Whether the change has been collected by an update in progress.
+    bool collected(false);
+    {
+        // Gain a lock to protect the update state.
+        QMutexLocker locker(&m_update_mutex);
+
+        // Is an update in progress?
+        if(m_update_depth > 0)
+        {
+            // Collect the change, it is emitted when the update ends.
+            m_update_invalidate_all = true;
+            collected = true;
+        }
+    }
+
+    // Should we emit the change now?
+    if(collected == false)
+    {
+        // Emit that we need to redraw the layer.
+        emit requestRedraw();
+    }
+}
+
+void Layer::invalidate(const util::RectWorldCoord& region_coord)
+{
+    // Whether the change has been collected by an update in progress.
+    bool collected(false);
+    {
+        // Gain a lock to protect the update state.
+        QMutexLocker locker(&m_update_mutex);
+
+        // Is an update in progress?
+        if(m_update_depth > 0)
+        {
+            // Collect the region, it is emitted (as the union of the regions collected) when the update ends.
+            // The union is calculated by hand, as QRectF::united() ignores the empty regions of geometry points.
+            const QRectF region(region_coord.normalized());
+            if(m_update_invalidate_region)
+            {
+                const QRectF region_collected(m_update_region_coord);
+                m_update_region_coord = util::RectWorldCoord(util::PointWorldCoord(std::min(region.left(), region_collected.left()), std::min(region.top(), region_collected.top())), util::PointWorldCoord(std::max(region.right(), region_collected.right()), std::max(region.bottom(), region_collected.bottom())));
+            }
+            else
+            {
+                m_update_region_coord = util::RectWorldCoord::fromQRectF(region);
+            }
+            m_update_invalidate_region = true;
+            collected = true;
+        }
+    }
+
+    // Should we emit the change now?
+    if(collected == false)
+    {
+        // Emit that we need to redraw the region.
+        emit requestRedrawRegion(region_coord);
+    }
+}
+
+void Layer::invalidate(const std::shared_ptr<draw::Drawable>& drawable)
+{
+    // Is the drawable a geometry?
+    if(drawable != nullptr && drawable->drawableType() == draw::DrawableType::Geometry)
+    {
+        // Only the region covered by the geometry has changed.
+        const auto geometry(std::static_pointer_cast<draw::geometry::Geometry>(drawable));
+        if(geometry->geometryType() == draw::geometry::GeometryType::GeometryPoint)
+        {
+            // The geometry point is drawn around its point.
+            const util::PointWorldCoord point_coord(std::static_pointer_cast<draw::geometry::GeometryPoint>(geometry)->coord());
+            invalidate(drawnRegion(*geometry, util::RectWorldCoord(point_coord, point_coord)));
+        }
+        else
+        {
+            // The fixed geometry is drawn around its bounding box.
+            invalidate(drawnRegion(*geometry, std::static_pointer_cast<draw::geometry::GeometryFixed>(geometry)->boundingBoxFixed()));
+        }
+    }
+    else
+    {
+        // Redraw the whole layer.
+        invalidate();
+    }
+}
+
+util::RectWorldCoord Layer::drawnRegion(const draw::geometry::Geometry& geometry, const util::RectWorldCoord& region_coord) const
+{
+    // Copy the last drawn viewport.
+    std::unique_ptr<Viewport> viewport;
+    {
+        // Gain a lock to protect the last drawn viewport.
+        QMutexLocker locker(&m_drawn_viewport_mutex);
+
+        // Has the layer been drawn?
+        if(m_drawn_viewport != nullptr)
+        {
+            viewport.reset(new Viewport(*m_drawn_viewport));
+        }
+    }
+
+    // Nothing has been drawn yet, so there is nothing to pad.
+    if(viewport == nullptr)
+    {
+        return region_coord;
+    }
+
+    // Calculate the geometry's own region (its point or fixed bounding box) in world pixels.
+    util::RectWorldCoord geometry_region_coord;
+    if(geometry.geometryType() == draw::geometry::GeometryType::GeometryPoint)
+    {
+        const util::PointWorldCoord point_coord(static_cast<const draw::geometry::GeometryPoint&>(geometry).coord());
+        geometry_region_coord = util::RectWorldCoord(point_coord, point_coord);
+    }
+    else
+    {
+        geometry_region_coord = static_cast<const draw::geometry::GeometryFixed&>(geometry).boundingBoxFixed();
+    }
+    const QRectF geometry_region_px(QRectF(projection::toPointWorldPx(*viewport, geometry_region_coord.topLeftCoord()), projection::toPointWorldPx(*viewport, geometry_region_coord.bottomRightCoord())).normalized());
+
+    // Calculate the extent that the geometry draws over in world pixels (its shape and any text).
+    const util::RectWorldCoord bounding_box_coord(geometry.boundingBox(*viewport));
+    QRectF extent_px(QRectF(projection::toPointWorldPx(*viewport, bounding_box_coord.topLeftCoord()), projection::toPointWorldPx(*viewport, bounding_box_coord.bottomRightCoord())).normalized());
+    const QRectF text_rect_px(geometry.textRectPx(*viewport));
+    if(text_rect_px.isEmpty() == false)
+    {
+        extent_px = extent_px.united(text_rect_px);
+    }
+
+    // The padding is how far the extent reaches beyond the geometry's own region, plus the pen width (and a pixel for anti-aliasing).
+    const qreal pen_padding_px(geometry.pen().widthF() + 1.0);
+    const qreal left_padding_px(std::max(0.0, geometry_region_px.left() - extent_px.left()) + pen_padding_px);
+    const qreal top_padding_px(std::max(0.0, geometry_region_px.top() - extent_px.top()) + pen_padding_px);
+    const qreal right_padding_px(std::max(0.0, extent_px.right() - geometry_region_px.right()) + pen_padding_px);
+    const qreal bottom_padding_px(std::max(0.0, extent_px.bottom() - geometry_region_px.bottom()) + pen_padding_px);
+
+    // Pad the region in world pixels.
+    const QRectF region_px(QRectF(projection::toPointWorldPx(*viewport, region_coord.topLeftCoord()), projection::toPointWorldPx(*viewport, region_coord.bottomRightCoord())).normalized().adjusted(-left_padding_px, -top_padding_px, right_padding_px, bottom_padding_px));
+
+    // Return the padded region in world coordinates.
+    return util::RectWorldCoord::fromQRectF(QRectF(projection::toPointWorldCoord(*viewport, util::PointWorldPx(region_px.left(), region_px.top())), projection::toPointWorldCoord(*viewport, util::PointWorldPx(region_px.right(), region_px.bottom()))).normalized());
+}
+
+void Layer::relocateGeometryPoints(const std::vector<std::pair<std::shared_ptr<draw::geometry::Geometry>, util::PointWorldCoord>>& geometry_points)
+{
+    // The geometry points that were removed, as they have moved outside of the points container.
+    std::vector<std::shared_ptr<draw::geometry::Geometry>> geometry_points_removed;
+
+    // Gain a lock to serialise writers.
+    QMutexLocker locker(&m_drawables_write_mutex);
+
+    // Build the next snapshot from the current one (only the quadtree nodes along the relocation paths are copied).
+    const auto snapshot(std::make_shared<DrawablesSnapshot>(*drawablesSnapshot()));
+
+    // Gain a write lock to protect the clusters.
+    QWriteLocker clusters_locker(&m_clusters_mutex);
+
+    // Loop through each geometry point.
+    for(const auto& geometry_point : geometry_points)
+    {
+        // Check that the geometry is still valid.
+        if(geometry_point.first != nullptr)
+        {
+            // Fetch the new point.
+            const util::PointWorldCoord point_coord(std::static_pointer_cast<draw::geometry::GeometryPoint>(geometry_point.first)->coord());
+
+            // Find the geometry point's zoom range bucket.
+            const auto itr_bucket(snapshot->m_drawable_geometries.find(zoomRange(*geometry_point.first)));
+            if(itr_bucket != snapshot->m_drawable_geometries.end())
+            {
+                // Has the geometry point moved outside of the points container?
+                auto& bucket_points(itr_bucket->second.m_drawable_geometries_points);
+                if(bucket_points.boundary().contains(point_coord) == false)
+                {
+                    // Remove the geometry point, as it would not have been added there.
+                    if(bucket_points.erase(geometry_point.second, geometry_point.first))
+                    {
+                        // Keep track of the geometry point removed.
+                        geometry_points_removed.push_back(geometry_point.first);
+
+                        // Remove the geometry point from the clusters.
+                        clusterErase(geometry_point.first.get(), geometry_point.second, itr_bucket->first);
+                    }
+                }
+                // Relocate the geometry point (it only moves between nodes if it has crossed a node boundary).
+                else if(bucket_points.relocate(geometry_point.second, point_coord, geometry_point.first) && m_clusters_counted.count(geometry_point.first.get()) > 0)
+                {
+                    // Relocate the geometry point within the clusters.
+                    m_clusters->relocate(geometry_point.second, point_coord, itr_bucket->first.first, itr_bucket->first.second);
+                }
+            }
+        }
+    }
+
+    // Publish the new snapshot.
+    publishDrawablesSnapshot(snapshot);
+
+    // Unlock the containers.
+    clusters_locker.unlock();
+    locker.unlock();
+
+    // Loop through each geometry point that was removed.
+    for(const auto& geometry_point : geometry_points_removed)
+    {
+        // Warn that the geometry point has been removed from the layer.
+        qDebug() << "Geometry point moved outside of the world bounds, removed from layer '" << m_name.c_str() << "'";
+
+        // Disconnect any signals that were previously connected.
+        QObject::disconnect(geometry_point.get(), 0, this, 0);
+    }
+}
+
+void Layer::rebucketGeometry(const std::shared_ptr<draw::geometry::Geometry>& geometry, const std::pair<int, int>& previous_zoom_range)
+{
+    // Check that the geometry is still valid.
+    if(geometry != nullptr)
+    {
+        // Gain a lock to serialise writers.
+        QMutexLocker locker(&m_drawables_write_mutex);
+
+        // Build the next snapshot from the current one (unmodified containers and quadtree nodes are shared).
+        const auto snapshot(std::make_shared<DrawablesSnapshot>(*drawablesSnapshot()));
+
+        // Find the previous zoom range bucket.
+        const auto itr_bucket(snapshot->m_drawable_geometries.find(previous_zoom_range));
+        if(itr_bucket != snapshot->m_drawable_geometries.end())
+        {
+            // Handle the different geometry types.
+            if(geometry->geometryType() == draw::geometry::GeometryType::GeometryPoint)
+            {
+                // Remove the geometry point from the previous bucket.
+                const util::PointWorldCoord point_coord(std::static_pointer_cast<draw::geometry::GeometryPoint>(geometry)->coord());
+                if(itr_bucket->second.m_drawable_geometries_points.erase(point_coord, geometry))
+                {
+                    // Add the geometry point to the new bucket (created if required).
+                    const std::pair<int, int> zoom_range(zoomRange(*geometry));
+                    snapshot->m_drawable_geometries[zoom_range].m_drawable_geometries_points.insert(point_coord, geometry);
+
+                    // Publish the new snapshot.
+                    publishDrawablesSnapshot(snapshot);
+
+                    // Gain a write lock to protect the clusters.
+                    QWriteLocker clusters_locker(&m_clusters_mutex);
+
+                    // Is the geometry point counted in the clusters?
+                    if(m_clusters_counted.count(geometry.get()) > 0)
+                    {
+                        // Move the geometry point to the zoom levels it is now clustered at.
+                        clusterErase(geometry.get(), point_coord, previous_zoom_range);
+                        clusterInsert(geometry.get(), point_coord, zoom_range);
+                    }
+                }
+            }
+            else
+            {
+                // Remove the fixed geometry from the previous bucket.
+                const auto geometries_fixed_removed(removeGeometriesFixed(itr_bucket->second, { std::static_pointer_cast<draw::geometry::GeometryFixed>(geometry) }));
+                if(geometries_fixed_removed.empty() == false)
+                {
+                    // Add the fixed geometry to the new bucket (created if required).
+                    addGeometriesFixed(snapshot->m_drawable_geometries[zoomRange(*geometry)], geometries_fixed_removed);
+
+                    // Publish the new snapshot.
+                    publishDrawablesSnapshot(snapshot);
+                }
+            }
+        }
+    }
+}
+
+void Layer::reclusterGeometryPoint(const std::shared_ptr<draw::geometry::Geometry>& geometry)
+{
+    // Check that the geometry is still valid.
+    if(geometry != nullptr)
+    {
+        // Gain a lock to serialise writers (so the geometry point cannot be added/removed/moved meanwhile).
+        QMutexLocker locker(&m_drawables_write_mutex);
+
+        // Find the geometry point's zoom range bucket.
+        const auto snapshot(drawablesSnapshot());
+        const auto itr_bucket(snapshot->m_drawable_geometries.find(zoomRange(*geometry)));
+        if(itr_bucket != snapshot->m_drawable_geometries.end())
+        {
+            // Is the geometry point still in this layer?
+            const util::PointWorldCoord point_coord(std::static_pointer_cast<draw::geometry::GeometryPoint>(geometry)->coord());
+            std::set<std::shared_ptr<draw::geometry::Geometry>> geometry_points;
+            itr_bucket->second.m_drawable_geometries_points.query(geometry_points, util::RectWorldCoord(point_coord, point_coord));
+            if(geometry_points.count(geometry) > 0)
+            {
+                // Gain a write lock to protect the clusters.
+                QWriteLocker clusters_locker(&m_clusters_mutex);
+
+                // Add/remove the geometry point to/from the clusters, based on its current visibility.
+                if(geometry->visible())
+                {
+                    clusterInsert(geometry.get(), point_coord, itr_bucket->first);
+                }
+                else
+                {
+                    clusterErase(geometry.get(), point_coord, itr_bucket->first);
+                }
+            }
+        }
+    }
+}
+
+void Layer::geometryPointMoved(const std::shared_ptr<draw::geometry::Geometry>& geometry, const util::PointWorldCoord& previous_point_coord)
+{
+    // Check that the geometry is still valid.
+    if(geometry != nullptr)
+    {
+        // Relocate the geometry point within the points container.
+        relocateGeometryPoints({ std::make_pair(geometry, previous_point_coord) });
+
+        // Redraw the region the geometry point was drawn over at its previous point.
+        invalidate(drawnRegion(*geometry, util::RectWorldCoord(previous_point_coord, previous_point_coord)));
+    }
+}
+
+void Layer::clusterInsert(const draw::geometry::Geometry* geometry, const util::PointWorldCoord& point_coord, const std::pair<int, int>& zoom_range)
+{
+    // Is clustering enabled, and is the geometry point visible and not already counted?
+    if(m_clusters != nullptr && geometry->visible() && m_clusters_counted.insert(geometry).second)
+    {
+        // Add the geometry point to the clusters.
+        m_clusters->insert(point_coord, zoom_range.first, zoom_range.second);
+    }
+}
+
+void Layer::clusterErase(const draw::geometry::Geometry* geometry, const util::PointWorldCoord& point_coord, const std::pair<int, int>& zoom_range)
+{
+    // Is clustering enabled, and is the geometry point counted?
+    if(m_clusters != nullptr && m_clusters_counted.erase(geometry) > 0)
+    {
+        // Remove the geometry point from the clusters.
+        m_clusters->erase(point_coord, zoom_range.first, zoom_range.second);
+    }
+}
+
+qreal Layer::clusterRadiusPx(const std::size_t& count)
+{
+    // The radius grows with the number of digits in the count (capped, so that large clusters do not swamp the map).
+    return std::min(12.0 + 4.0 * std::log10(static_cast<double>(std::max(count, std::size_t(1)))), 32.0);
+}
+
+void Layer::thinGeometries(std::vector<std::shared_ptr<draw::geometry::Geometry>>& geometries, const std::size_t& budget, const std::string& priority_key)
+{
+    // Check we have a budget and that it has been exceeded.
+    if(budget > 0 && geometries.size() > budget)
+    {
+        // Fetch each geometry's priority (so the meta-data is only looked up once per geometry), with its drawing order.
+        std::vector<std::pair<double, std::size_t>> priorities;
+        priorities.reserve(geometries.size());
+        for(std::size_t i = 0; i < geometries.size(); ++i)
+        {
+            priorities.emplace_back(priority_key.empty() ? 0.0 : geometries.at(i)->metadata(priority_key).toDouble(), i);
+        }
+
+        // Partition the priorities so that the highest are first (no full sort is required).
+        // Equal priorities are broken by the drawing order, so the same geometries are kept every frame.
+        std::nth_element(priorities.begin(), priorities.begin() + static_cast<std::ptrdiff_t>(budget), priorities.end(), [](const std::pair<double, std::size_t>& lhs, const std::pair<double, std::size_t>& rhs) { return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second); });
+
+        // Restore the drawing order of the geometries kept.
+        std::sort(priorities.begin(), priorities.begin() + static_cast<std::ptrdiff_t>(budget), [](const std::pair<double, std::size_t>& lhs, const std::pair<double, std::size_t>& rhs) { return lhs.second < rhs.second; });
+
+        // Keep the geometries with the highest priorities.
+        std::vector<std::shared_ptr<draw::geometry::Geometry>> kept_geometries;
+        kept_geometries.reserve(budget);
+        for(std::size_t i = 0; i < budget; ++i)
+        {
+            kept_geometries.push_back(std::move(geometries.at(priorities.at(i).second)));
+        }
+        geometries.swap(kept_geometries);
+    }
+}
+
+void Layer::drawImageBatches(QPainter& painter, std::map<qint64, ImageBatch>& image_batches, std::vector<draw::geometry::Geometry*>& image_labels, const Viewport& viewport, util::CollisionGrid* label_collision_grid)
+{
+    // Loop through each image batch.
+    for(const auto& image_batch : image_batches)
+    {
+        // Draw all the image points that share the image pixmap.
+        painter.drawPixmapFragments(image_batch.second.m_fragments.data(), int(image_batch.second.m_fragments.size()), image_batch.second.m_pixmap);
+    }
+
+    // Loop through each image point and draw its meta-data displayed (on top of the images).
+    for(const auto& image_label : image_labels)
+    {
+        // Draw the meta-data displayed (if set).
+        image_label->drawMetadataDisplayed(painter, viewport, label_collision_grid);
+    }
+
+    // Clear the pending image points.
+    image_batches.clear();
+    image_labels.clear();
+}
+
+void Layer::drawPolylineBatch(QPainter& painter, PolylineBatch& polyline_batch, const Viewport& viewport, util::CollisionGrid* label_collision_grid)
+{
+    // Do we have any line strings pending?
+    if(polyline_batch.m_labels.empty() == false)
+    {
+        // Set the pen to use (once for the whole batch).
+        painter.setPen(polyline_batch.m_pen);
+
+        // Can the polylines be merged without changing how overlaps blend?
+        if(polyline_batch.m_pen.color().alpha() == 255 && polyline_batch.m_polyline_sizes.size() > 1)
+        {
+            // Merge the polylines into a single path (each polyline is a separate sub-path).
+            QPainterPath path_px;
+            const QPointF* polyline_px(polyline_batch.m_points_px.data());
+            for(const auto& polyline_size : polyline_batch.m_polyline_sizes)
+            {
+                path_px.moveTo(polyline_px[0]);
+                for(int p = 1; p < polyline_size; ++p)
+                {
+                    path_px.lineTo(polyline_px[p]);
+                }
+                polyline_px += polyline_size;
+            }
+
+            // Draw the merged polylines (without a fill).
+            painter.setBrush(Qt::NoBrush);
+            painter.drawPath(path_px);
+        }
+        else
+        {
+            // Draw each polyline.
+            const QPointF* polyline_px(polyline_batch.m_points_px.data());
+            for(const auto& polyline_size : polyline_batch.m_polyline_sizes)
+            {
+                painter.drawPolyline(polyline_px, polyline_size);
+                polyline_px += polyline_size;
+            }
+        }
+
+        // Loop through each line string and draw its meta-data displayed (on top of the lines).
+        for(const auto& label : polyline_batch.m_labels)
+        {
+            // Draw the meta-data displayed (if set).
+            label->drawMetadataDisplayed(painter, viewport, label_collision_grid);
+        }
+    }
+
+    // Clear the pending line strings.
+    polyline_batch.m_points_px.clear();
+    polyline_batch.m_polyline_sizes.clear();
+    polyline_batch.m_labels.clear();
+}
+
+std::pair<int, int> Layer::zoomRange(const draw::Drawable& drawable)
+{
+    // Return the drawable's zoom range.
+    return std::make_pair(drawable.zoomMinimum(), drawable.zoomMaximum());
+}
+
+void Layer::addGeometriesFixed(DrawablesBucket& bucket, const std::vector<std::shared_ptr<draw::geometry::GeometryFixed>>& geometries)
+{
+    // Add the fixed geometries (only the last chunk of the bucket's fixed geometries is copied, the others may be shared with other snapshots).
+    bucket.m_drawable_geometries_fixed.append(geometries);
+}
+
+std::vector<std::shared_ptr<draw::geometry::GeometryFixed>> Layer::removeGeometriesFixed(DrawablesBucket& bucket, const std::set<std::shared_ptr<draw::geometry::GeometryFixed>>& geometries)
+{
+    // Remove the fixed geometries (only the chunks that contain them are copied, the others may be shared with other snapshots).
+    return bucket.m_drawable_geometries_fixed.erase(geometries);
+}
+
+std::shared_ptr<const Layer::DrawablesSnapshot> Layer::drawablesSnapshot() const
+{
+    // Return the current snapshot (atomically, as a writer may be publishing a replacement).
+    return std::atomic_load(&m_drawables_snapshot);
+}
+
+void Layer::publishDrawablesSnapshot(const std::shared_ptr<const DrawablesSnapshot>& snapshot)
+{
+    // Replace the current snapshot (atomically, as readers may be fetching it).
+    std::atomic_store(&m_drawables_snapshot, snapshot);
 }
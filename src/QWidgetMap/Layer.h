@@ -19,15 +19,24 @@
 #pragma once
 
 // Qt includes.
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QReadWriteLock>
+#include <QtCore/QSize>
 #include <QtCore/QVariant>
+#include <QtGui/QBrush>
 #include <QtGui/QMouseEvent>
 #include <QtGui/QPainter>
+#include <QtGui/QPen>
+#include <QtGui/QPixmap>
+#include <QtGui/QPolygonF>
 
 // STL includes.
+#include <cstddef>
+#include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -37,6 +46,12 @@
 #include "draw/Drawable.h"
 #include "draw/geometry/Geometry.h"
 #include "draw/geometry/GeometryFixed.h"
+#include "draw/geometry/GeometryPoint.h"
+#include "util/AttributeTable.h"
+#include "util/ChunkedVector.h"
+#include "util/ClusterContainer.h"
+#include "util/MemoryUsage.h"
+#include "util/MPSCQueue.h"
 #include "util/Rect.h"
 #include "util/QuadtreeContainer.h"
 
@@ -134,6 +149,133 @@ namespace qwm
          */
         void setMouseEventsEnabled(const bool& enable);
 
+        /**
+         * Fetches whether geometry points are clustered.
+         * @return whether geometry points are clustered.
+         */
+        bool isClusteringEnabled() const;
+
+        /**
+         * Set whether geometry points are clustered at lower zoom levels.
+         * Geometry points that share a cell are drawn as a single cluster symbol with their count, while a geometry point
+         * that is alone in its cell is drawn as normal. The clusters are updated incrementally as geometry points change.
+         * Hidden geometry points are not counted. The cells are square in the pixels of the projection/tile size given,
+         * and geometry points are drawn unclustered on a map that uses a different projection/tile size.
+         * @param enabled Whether to cluster geometry points.
+         * @param zoom_maximum The maximum zoom level to cluster geometry points at.
+         * @param cell_size_px The size of each cluster cell in pixels.
+         * @param projection_epsg The EPSG of the projection the map uses.
+         * @param tile_size_px The tile size in pixels the map uses.
+         */
+        void setClusteringEnabled(const bool& enabled, const int& zoom_maximum = 12, const qreal& cell_size_px = 60.0, const projection::EPSG& projection_epsg = projection::EPSG::SphericalMercator, const QSize& tile_size_px = QSize(256, 256));
+
+        /**
+         * Set the pen to draw clusters with.
+         * @param pen The pen to draw clusters with.
+         */
+        void setClusterPen(const QPen& pen);
+
+        /**
+         * Set the brush to draw clusters with.
+         * @param brush The brush to draw clusters with.
+         */
+        void setClusterBrush(const QBrush& brush);
+
+        /**
+         * Fetches the projected size (in pixels) below which fixed geometries are culled.
+         * @return the projected size (in pixels) below which fixed geometries are culled.
+         */
+        qreal subPixelThresholdPx() const;
+
+        /**
+         * Fetches whether culled geometries are collapsed into dots.
+         * @return whether culled geometries are collapsed into dots.
+         */
+        bool isSubPixelCollapsedToDots() const;
+
+        /**
+         * Set the level-of-detail for small geometries.
+         * Fixed geometries (ellipses, line strings and polygons) whose bounding box projects to less than the threshold skip
+         * their full draw path and meta-data display, and are either skipped or collapsed into a single dot (drawn in one batch
+         * with the other collapsed geometries that share their pen colour). Culling is disabled by default.
+         * @param threshold_px The projected size (in pixels) below which geometries are culled (0 to disable culling).
+         * @param collapse_to_dots Whether culled geometries are drawn as dots (otherwise they are skipped).
+         */
+        void setSubPixelCulling(const qreal& threshold_px, const bool& collapse_to_dots = true);
+
+        /**
+         * Fetches the maximum number of geometries drawn per frame.
+         * @return the maximum number of geometries drawn per frame (0 if unlimited).
+         */
+        std::size_t geometryBudget() const;
+
+        /**
+         * Set the maximum number of geometries drawn per frame.
+         * When more geometries are displayed within the drawing rect than the budget allows, only those with the highest
+         * priority are drawn (equal priorities keep the earliest drawn, so the same geometries are kept every frame). The lower
+         * priority geometries are dropped straight after the spatial query, so they are never projected. Without a priority key,
+         * the spatial query stops once the budget is reached: visible geometry points are taken first (in quadtree order), then
+         * the fixed geometries fill whatever budget remains.
+         * @param budget The maximum number of geometries drawn per frame (0 for unlimited).
+         * @param priority_key The meta-data key that holds each geometry's priority (higher values are kept first, missing values count as 0).
+         */
+        void setGeometryBudget(const std::size_t& budget, const std::string& priority_key = std::string());
+
+        /**
+         * Fetches whether labels are decluttered.
+         * @return whether labels are decluttered.
+         */
+        bool isLabelDeclutteringEnabled() const;
+
+        /**
+         * Set whether labels (displayed meta-data and text geometries) are decluttered.
+         * Each label tries its candidate alignments in priority order and is only drawn at the first that does not collide
+         * with a label already placed. Labels are placed in world pixels in drawing order (which is the same every frame), so
+         * placements are stable whilst panning. Disabled by default.
+         * @param enabled Whether to declutter labels.
+         */
+        void setLabelDeclutteringEnabled(const bool& enabled);
+
+        /**
+         * Fetches whether geometries are drawn grouped by their style.
+         * @return whether geometries are drawn grouped by their style.
+         */
+        bool isStyleSortingEnabled() const;
+
+        /**
+         * Set whether geometries are drawn grouped by their geometry type and style (pen/brush values), disabled by default.
+         * The painter state is then only changed between groups, and line strings that share a pen are drawn together.
+         * The relative order of geometries within a group is kept, but geometries are no longer drawn in the order they were
+         * added. When disabled, only consecutive line strings that share a pen are drawn together.
+         * @param enabled Whether to draw geometries grouped by their style.
+         */
+        void setStyleSortingEnabled(const bool& enabled);
+
+        /**
+         * Fetches the attribute table that stores the meta-data of the drawable items/geometries in this layer.
+         * @return the attribute table, or nullptr if each drawable item/geometry stores its own meta-data.
+         */
+        std::shared_ptr<util::AttributeTable> attributeTable() const;
+
+        /**
+         * Set the attribute table to store the meta-data of the drawable items/geometries in this layer (disabled by default).
+         * The drawable items/geometries already in the layer, and those added afterwards, store their meta-data in the
+         * table (columnar storage), so a meta-data key can be scanned across the whole layer in one pass. Drawable
+         * items/geometries removed from the layer keep their row until they are destroyed. Integer meta-data values (ie: int)
+         * are returned as qlonglong once they are stored in the table.
+         * @param attribute_table The attribute table to store the meta-data in (nullptr to disable).
+         */
+        void setAttributeTable(const std::shared_ptr<util::AttributeTable>& attribute_table);
+
+        /**
+         * Fetches the memory used by this layer: its drawable items/geometries (grouped by drawable type), their meta-data
+         * (including the attribute table, if set, and the meta-data text laid out for display), the spatial index (quadtree
+         * nodes and fixed geometry lists) and the clusters (if clustering is enabled).
+         * All sizes are estimates, and each drawable item/geometry is visited (so avoid calling this every frame).
+         * @return the memory used.
+         */
+        util::MemoryUsage memoryUsage() const;
+
     public:
 
         /**
@@ -149,6 +291,15 @@ namespace qwm
          */
         std::vector<std::shared_ptr<draw::geometry::Geometry>> drawableGeometries(const util::RectWorldCoord& range_coord) const;
 
+        /**
+         * Returns the drawable geoemtries in this layer that are set to be shown at a zoom level.
+         * Geometries are bucketed by their zoom range, so those not shown at the zoom level are never queried.
+         * @param range_coord The bounding box range to limit the geometries that are fetched in coordinates.
+         * @param zoom The zoom level to limit the geometries that are fetched.
+         * @return the drawable geoemtries in this layer.
+         */
+        std::vector<std::shared_ptr<draw::geometry::Geometry>> drawableGeometries(const util::RectWorldCoord& range_coord, const int& zoom) const;
+
         /**
          * Adds a drawable item/geometry to this Layer.
          * @param drawable The drawable item/geometry to add.
@@ -165,12 +316,162 @@ namespace qwm
          */
         bool removeDrawable(const std::shared_ptr<draw::Drawable>& drawable, const bool& disable_redraw = false);
 
+        /**
+         * Adds multiple drawable items/geometries to this Layer.
+         * The containers are locked and sized once for the whole batch and a single redraw is requested at the end.
+         * @param drawables The drawable items/geometries to add.
+         * @param disable_redraw Whether to disable the redraw call after the drawable items/geometries are added.
+         * @return the number of drawable items/geometries that were added into this layer.
+         */
+        std::size_t addDrawables(const std::vector<std::shared_ptr<draw::Drawable>>& drawables, const bool& disable_redraw = false);
+
+        /**
+         * Adds a range of drawable items/geometries to this Layer.
+         * @param first The first drawable item/geometry in the range to add.
+         * @param last The end of the range to add.
+         * @param disable_redraw Whether to disable the redraw call after the drawable items/geometries are added.
+         * @return the number of drawable items/geometries that were added into this layer.
+         */
+        template <class InputIterator>
+        std::size_t addDrawables(InputIterator first, InputIterator last, const bool& disable_redraw = false)
+        {
+            // Add the range as drawables.
+            return addDrawables(std::vector<std::shared_ptr<draw::Drawable>>(first, last), disable_redraw);
+        }
+
+        /**
+         * Removes multiple drawable items/geometries from this Layer.
+         * The containers are locked once for the whole batch and a single redraw is requested at the end.
+         * @param drawables The drawable items/geometries to remove.
+         * @param disable_redraw Whether to disable the redraw call after the drawable items/geometries are removed.
+         * @return the number of drawable items/geometries that were removed from this layer.
+         */
+        std::size_t removeDrawables(const std::vector<std::shared_ptr<draw::Drawable>>& drawables, const bool& disable_redraw = false);
+
+        /**
+         * Removes a range of drawable items/geometries from this Layer.
+         * @param first The first drawable item/geometry in the range to remove.
+         * @param last The end of the range to remove.
+         * @param disable_redraw Whether to disable the redraw call after the drawable items/geometries are removed.
+         * @return the number of drawable items/geometries that were removed from this layer.
+         */
+        template <class InputIterator>
+        std::size_t removeDrawables(InputIterator first, InputIterator last, const bool& disable_redraw = false)
+        {
+            // Remove the range as drawables.
+            return removeDrawables(std::vector<std::shared_ptr<draw::Drawable>>(first, last), disable_redraw);
+        }
+
         /**
          * Removes all drawable items from this Layer.
+         * The layer is emptied immediately, whilst the drawable items themselves are released in batches by the layer's
+         * thread event loop (so clearing a layer of millions of drawable items does not stall the caller or the event loop).
          * @param disable_redraw Whether to disable the redraw call after all drawable items are removed.
          */
         void clearDrawables(const bool& disable_redraw = false);
 
+    public:
+
+        /**
+         * Queues a drawable item/geometry to be added to this layer.
+         * This is safe to call from any thread and never blocks, the update is applied by processPendingUpdates().
+         * @param drawable The drawable item/geometry to add.
+         */
+        void queueAddDrawable(const std::shared_ptr<draw::Drawable>& drawable);
+
+        /**
+         * Queues a drawable item/geometry to be removed from this layer.
+         * This is safe to call from any thread and never blocks, the update is applied by processPendingUpdates().
+         * @param drawable The drawable item/geometry to remove.
+         */
+        void queueRemoveDrawable(const std::shared_ptr<draw::Drawable>& drawable);
+
+        /**
+         * Queues a geometry point (already in this layer) to be moved.
+         * This is safe to call from any thread and never blocks, the update is applied by processPendingUpdates().
+         * @param geometry_point The geometry point to move.
+         * @param point_coord The new point of the geometry point (world coordinates).
+         */
+        void queueMoveGeometryPoint(const std::shared_ptr<draw::geometry::GeometryPoint>& geometry_point, const util::PointWorldCoord& point_coord);
+
+        /**
+         * Queues a geometry to be restyled.
+         * This is safe to call from any thread and never blocks, the update is applied by processPendingUpdates().
+         * @param geometry The geometry to restyle.
+         * @param pen The new pen to use (nullptr to leave unchanged).
+         * @param brush The new brush to use (nullptr to leave unchanged).
+         */
+        void queueRestyleGeometry(const std::shared_ptr<draw::geometry::Geometry>& geometry, const std::shared_ptr<QPen>& pen, const std::shared_ptr<QBrush>& brush);
+
+        /**
+         * Fetches whether there are queued updates waiting to be applied.
+         * @return whether there are queued updates waiting to be applied.
+         */
+        bool hasPendingUpdates() const;
+
+        /**
+         * Applies all queued updates, in the order they were queued.
+         * Consecutive updates of the same type are applied as a single batch. No redraw is requested, as this is
+         * intended to be called by the renderer at the start of a frame.
+         * @return the number of queued updates processed.
+         */
+        std::size_t processPendingUpdates();
+
+    public:
+
+        /**
+         * RAII helper that groups changes to a layer into a single update (see Layer::beginUpdate()/endUpdate()).
+         */
+        class QWIDGETMAP_EXPORT UpdateScope
+        {
+
+        public:
+
+            /**
+             * Begins an update of the layer.
+             * @param layer The layer to update.
+             */
+            explicit UpdateScope(Layer& layer)
+                : m_layer(layer)
+            {
+                // Begin the update.
+                m_layer.beginUpdate();
+            }
+
+            /// Disable copy constructor.
+            UpdateScope(const UpdateScope&) = delete;
+
+            /// Disable copy assignment.
+            UpdateScope& operator=(const UpdateScope&) = delete;
+
+            /// Destructor, ends the update of the layer.
+            ~UpdateScope()
+            {
+                // End the update.
+                m_layer.endUpdate();
+            }
+
+        private:
+
+            /// The layer being updated.
+            Layer& m_layer;
+
+        };
+
+        /**
+         * Begins an update of this layer (calls can be nested).
+         * Until the matching endUpdate(), redraw requests from the layer and its drawable items/geometries (ie: restyling
+         * many geometries) are collected rather than emitted, along with the union of the regions they affect.
+         */
+        void beginUpdate();
+
+        /**
+         * Ends an update of this layer.
+         * When the outermost update ends, a single redraw request is emitted for all the changes collected: requestRedraw()
+         * if the whole layer changed, otherwise requestRedrawRegion() with the union of the regions that changed.
+         */
+        void endUpdate();
+
     public:
 
         /**
@@ -197,11 +498,105 @@ namespace qwm
          */
         void drawableClicked(const std::shared_ptr<draw::Drawable>& drawable) const;
 
+        /**
+         * Signal emitted when a cluster of geometry points is clicked.
+         * @param point_coord The mean point of the geometry points in the cluster (world coordinates).
+         * @param count The number of geometry points in the cluster.
+         */
+        void clusterClicked(const util::PointWorldCoord& point_coord, const std::size_t& count) const;
+
         /**
          * Signal emitted when a change has occurred that requires the layer to be redrawn.
          */
         void requestRedraw() const;
 
+        /**
+         * Signal emitted when a change has occurred that requires a region of the layer to be redrawn.
+         * This is emitted instead of requestRedraw() when only geometries have changed.
+         * @param region_coord The region that has changed (world coordinates), the geometries have only changed within it.
+         */
+        void requestRedrawRegion(const util::RectWorldCoord& region_coord) const;
+
+    private slots:
+
+        /**
+         * Slot called to release the next batch of cleared drawable items, scheduling itself again until all are released.
+         */
+        void releaseDrawables();
+
+    private:
+
+        /**
+         * Requests that the whole layer is redrawn (collected if an update is in progress).
+         */
+        void invalidate();
+
+        /**
+         * Requests that a region of the layer is redrawn (collected if an update is in progress).
+         * @param region_coord The region that has changed (world coordinates).
+         */
+        void invalidate(const util::RectWorldCoord& region_coord);
+
+        /**
+         * Requests a redraw for a drawable item/geometry that has changed.
+         * Geometries only invalidate the region they draw over, other drawable items invalidate the whole layer.
+         * @param drawable The drawable item/geometry that has changed.
+         */
+        void invalidate(const std::shared_ptr<draw::Drawable>& drawable);
+
+        /**
+         * Pads a region by the pixel extent that a geometry draws beyond it (its shape, pen and text) in the last drawn viewport.
+         * @param geometry The geometry that is drawn.
+         * @param region_coord The region to pad, either the geometry's point or its fixed bounding box (world coordinates).
+         * @return the padded region (world coordinates), or the region itself if the layer has not been drawn yet.
+         */
+        util::RectWorldCoord drawnRegion(const draw::geometry::Geometry& geometry, const util::RectWorldCoord& region_coord) const;
+
+        /**
+         * Relocates geometry points within the points container after their points have changed.
+         * Geometry points that have moved outside of the points container (the world bounds) are removed from the layer.
+         * @param geometry_points The geometry points that have moved, with their previous points (world coordinates).
+         */
+        void relocateGeometryPoints(const std::vector<std::pair<std::shared_ptr<draw::geometry::Geometry>, util::PointWorldCoord>>& geometry_points);
+
+        /**
+         * Moves a geometry to the bucket for its zoom range after its zoom range has changed.
+         * @param geometry The geometry whose zoom range has changed.
+         * @param previous_zoom_range The previous zoom range (minimum, maximum) of the geometry.
+         */
+        void rebucketGeometry(const std::shared_ptr<draw::geometry::Geometry>& geometry, const std::pair<int, int>& previous_zoom_range);
+
+        /**
+         * Adds/removes a geometry point to/from the clusters after its visibility has changed (hidden geometry points are not counted).
+         * @param geometry The geometry point whose visibility has changed.
+         */
+        void reclusterGeometryPoint(const std::shared_ptr<draw::geometry::Geometry>& geometry);
+
+        /**
+         * Relocates a geometry point within the points container after it has moved, and redraws its previous region.
+         * @param geometry The geometry point that has moved.
+         * @param previous_point_coord The previous point of the geometry point (world coordinates).
+         */
+        void geometryPointMoved(const std::shared_ptr<draw::geometry::Geometry>& geometry, const util::PointWorldCoord& previous_point_coord);
+
+        /**
+         * Adds a geometry point to the clusters, if clustering is enabled and the geometry point is visible and not already counted.
+         * The clusters must be write locked by the caller.
+         * @param geometry The geometry point to add.
+         * @param point_coord The point of the geometry point in world coordinates.
+         * @param zoom_range The zoom range (minimum, maximum) of the geometry point.
+         */
+        void clusterInsert(const draw::geometry::Geometry* geometry, const util::PointWorldCoord& point_coord, const std::pair<int, int>& zoom_range);
+
+        /**
+         * Removes a geometry point from the clusters, if it is counted.
+         * The clusters must be write locked by the caller.
+         * @param geometry The geometry point to remove.
+         * @param point_coord The point of the geometry point in world coordinates.
+         * @param zoom_range The zoom range (minimum, maximum) of the geometry point.
+         */
+        void clusterErase(const draw::geometry::Geometry* geometry, const util::PointWorldCoord& point_coord, const std::pair<int, int>& zoom_range);
+
     private:
 
         /// The layer name.
@@ -224,22 +619,292 @@ namespace qwm
 
     private:
 
-        /// List of drawable items drawn by this layer.
-        std::vector<std::shared_ptr<draw::Drawable>> m_drawable_items;
+        /// Captures the drawable geometries that share a zoom range.
+        struct DrawablesBucket
+        {
+            /// List of drawable geometries (point) drawn by this layer (copies share unmodified quadtree nodes).
+            util::QuadtreeContainer<std::shared_ptr<draw::geometry::Geometry>> m_drawable_geometries_points { 50, util::RectWorldCoord(util::PointWorldCoord(-180.0, 90.0), util::PointWorldCoord(180.0, -90.0)) };
+
+            /// List of drawable geometries (fixed) drawn by this layer (copies share unmodified chunks).
+            util::ChunkedVector<std::shared_ptr<draw::geometry::GeometryFixed>> m_drawable_geometries_fixed;
+        };
 
-        /// Mutex to protect drawable items.
-        mutable QReadWriteLock m_drawable_items_mutex;
+        /// Captures an immutable version of the drawable items/geometries in this layer.
+        struct DrawablesSnapshot
+        {
+            /// List of drawable items drawn by this layer (copies share unmodified chunks).
+            util::ChunkedVector<std::shared_ptr<draw::Drawable>> m_drawable_items;
+
+            /// Drawable geometries, bucketed by their zoom range (minimum, maximum).
+            std::map<std::pair<int, int>, DrawablesBucket> m_drawable_geometries;
+        };
+
+        /// Captures the image points (pending drawing) that share an image pixmap.
+        struct ImageBatch
+        {
+            /// The image pixmap shared by the points.
+            QPixmap m_pixmap;
+
+            /// The pixmap fragment of each point.
+            std::vector<QPainter::PixmapFragment> m_fragments;
+        };
+
+        /// Captures the line strings (pending drawing) that share a pen.
+        struct PolylineBatch
+        {
+            /// The pen shared by the line strings (a copy, so it cannot change or be released whilst the batch is pending).
+            QPen m_pen;
+
+            /// The points of the line strings' polylines in world pixels (one after another, in the drawing thread's scratch buffers).
+            std::vector<QPointF>& m_points_px;
+
+            /// The number of points in each polyline (in the drawing thread's scratch buffers).
+            std::vector<int>& m_polyline_sizes;
+
+            /// The line strings whose meta-data displayed should be drawn (in drawing order).
+            std::vector<draw::geometry::Geometry*> m_labels;
+        };
+
+        /**
+         * Fetches the current drawables snapshot.
+         * The snapshot is never modified, so it can be read without holding any locks.
+         * @return the current drawables snapshot.
+         */
+        std::shared_ptr<const DrawablesSnapshot> drawablesSnapshot() const;
+
+        /**
+         * Publishes a new drawables snapshot, replacing the current one.
+         * Readers still holding the previous snapshot continue to use it until they release it.
+         * @param snapshot The new drawables snapshot.
+         */
+        void publishDrawablesSnapshot(const std::shared_ptr<const DrawablesSnapshot>& snapshot);
+
+        /**
+         * Returns the drawable geoemtries in a drawables snapshot.
+         * @param snapshot The drawables snapshot to fetch the geometries from.
+         * @param range_coord The bounding box range to limit the geometries that are fetched in coordinates.
+         * @param zoom_minimum The minimum zoom level to limit the geometries that are fetched.
+         * @param zoom_maximum The maximum zoom level to limit the geometries that are fetched.
+         * @param limit The maximum number of geometries to fetch (when limited, hidden geometries are not fetched, and the
+         *              geometry points are fetched before the fixed geometries).
+         * @return the drawable geoemtries in the drawables snapshot.
+         */
+        static std::vector<std::shared_ptr<draw::geometry::Geometry>> drawableGeometries(const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const int& zoom_minimum, const int& zoom_maximum, const std::size_t& limit = std::numeric_limits<std::size_t>::max());
+
+        /**
+         * Fetches the drawable geoemtry points in a drawables snapshot.
+         * @param return_geometries The geometry points that are within the range are added to this.
+         * @param snapshot The drawables snapshot to fetch the geometry points from.
+         * @param range_coord The bounding box range to limit the geometry points that are fetched in coordinates.
+         * @param zoom_minimum The minimum zoom level to limit the geometry points that are fetched.
+         * @param zoom_maximum The maximum zoom level to limit the geometry points that are fetched.
+         * @param limit The number of return geometries to stop at (when limited, hidden geometry points are not fetched).
+         */
+        static void drawableGeometryPoints(std::set<std::shared_ptr<draw::geometry::Geometry>>& return_geometries, const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const int& zoom_minimum, const int& zoom_maximum, const std::size_t& limit = std::numeric_limits<std::size_t>::max());
+
+        /**
+         * Fetches the drawable fixed geoemtries in a drawables snapshot.
+         * @param return_geometries The fixed geometries that intersect the range are added to this.
+         * @param snapshot The drawables snapshot to fetch the fixed geometries from.
+         * @param range_coord The bounding box range to limit the fixed geometries that are fetched in coordinates.
+         * @param zoom_minimum The minimum zoom level to limit the fixed geometries that are fetched.
+         * @param zoom_maximum The maximum zoom level to limit the fixed geometries that are fetched.
+         * @param limit The number of return geometries to stop at (when limited, hidden fixed geometries are not fetched).
+         */
+        static void drawableGeometriesFixed(std::vector<std::shared_ptr<draw::geometry::Geometry>>& return_geometries, const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const int& zoom_minimum, const int& zoom_maximum, const std::size_t& limit = std::numeric_limits<std::size_t>::max());
+
+        /**
+         * Fetches the drawable geometries and clusters that are displayed at a zoom level.
+         * When the geometry points are clustered, only the geometry points that are alone in their cluster are returned.
+         * @param return_clusters The clusters (of more than one geometry point) that are within the range are added to this.
+         * @param snapshot The drawables snapshot to fetch the geometries from.
+         * @param range_coord The bounding box range to limit the geometries that are fetched in coordinates.
+         * @param viewport The viewport to display the geometries in (clustering only applies to a matching projection/tile size).
+         * @param limit The maximum number of unclustered geometries to fetch (when limited, hidden geometries are not fetched).
+         * @return the drawable geometries that are displayed.
+         */
+        std::vector<std::shared_ptr<draw::geometry::Geometry>> displayedGeometries(std::vector<util::ClusterContainer::Cluster>& return_clusters, const DrawablesSnapshot& snapshot, const util::RectWorldCoord& range_coord, const Viewport& viewport, const std::size_t& limit = std::numeric_limits<std::size_t>::max()) const;
+
+        /**
+         * Calculates the radius of a cluster symbol.
+         * @param count The number of geometry points in the cluster.
+         * @return the radius of the cluster symbol in pixels.
+         */
+        static qreal clusterRadiusPx(const std::size_t& count);
+
+        /**
+         * Thins the geometries to the budget, keeping those with the highest priority (equal priorities keep the earliest drawn).
+         * @param geometries The geometries to thin (the drawing order of the geometries kept is preserved).
+         * @param budget The maximum number of geometries to keep (0 for unlimited).
+         * @param priority_key The meta-data key that holds each geometry's priority.
+         */
+        static void thinGeometries(std::vector<std::shared_ptr<draw::geometry::Geometry>>& geometries, const std::size_t& budget, const std::string& priority_key);
+
+        /**
+         * Draws the pending image points, one QPainter::drawPixmapFragments call per image pixmap, followed by their meta-data displayed.
+         * The image batches and labels are cleared once drawn.
+         * @param painter The painter to draw on.
+         * @param image_batches The pending image points, keyed by the image pixmap's cache key.
+         * @param image_labels The pending image points whose meta-data displayed should be drawn (in drawing order).
+         * @param viewport The current viewport to use.
+         * @param label_collision_grid The labels already placed (to declutter against), or nullptr to not declutter.
+         */
+        static void drawImageBatches(QPainter& painter, std::map<qint64, ImageBatch>& image_batches, std::vector<draw::geometry::Geometry*>& image_labels, const Viewport& viewport, util::CollisionGrid* label_collision_grid);
+
+        /**
+         * Draws the pending line strings that share a pen, followed by their meta-data displayed.
+         * Opaque pens are drawn with a single QPainter::drawPath call, translucent pens with a QPainter::drawPolyline per
+         * polyline (so overlaps still blend as before). The polyline batch is cleared once drawn.
+         * @param painter The painter to draw on.
+         * @param polyline_batch The pending line strings.
+         * @param viewport The current viewport to use.
+         * @param label_collision_grid The labels already placed (to declutter against), or nullptr to not declutter.
+         */
+        static void drawPolylineBatch(QPainter& painter, PolylineBatch& polyline_batch, const Viewport& viewport, util::CollisionGrid* label_collision_grid);
+
+        /**
+         * Fetches the zoom range (minimum, maximum) of a drawable, used as its bucket key.
+         * @param drawable The drawable to fetch the zoom range of.
+         * @return the zoom range (minimum, maximum).
+         */
+        static std::pair<int, int> zoomRange(const draw::Drawable& drawable);
+
+        /**
+         * Adds fixed geometries to a bucket.
+         * @param bucket The bucket to add to.
+         * @param geometries The fixed geometries to add.
+         */
+        static void addGeometriesFixed(DrawablesBucket& bucket, const std::vector<std::shared_ptr<draw::geometry::GeometryFixed>>& geometries);
+
+        /**
+         * Removes fixed geometries from a bucket.
+         * @param bucket The bucket to remove from.
+         * @param geometries The fixed geometries to remove.
+         * @return the fixed geometries that were removed.
+         */
+        static std::vector<std::shared_ptr<draw::geometry::GeometryFixed>> removeGeometriesFixed(DrawablesBucket& bucket, const std::set<std::shared_ptr<draw::geometry::GeometryFixed>>& geometries);
 
     private:
 
-        /// List of drawable geometries (point) drawn by this layer.
-        util::QuadtreeContainer<std::shared_ptr<draw::geometry::Geometry>> m_drawable_geometries_points { 50, util::RectWorldCoord(util::PointWorldCoord(-180.0, 90.0), util::PointWorldCoord(180.0, -90.0)) };
+        /// The current drawables snapshot (readers take a reference to it, writers publish a replacement).
+        std::shared_ptr<const DrawablesSnapshot> m_drawables_snapshot { std::make_shared<const DrawablesSnapshot>() };
+
+        /// Mutex to serialise writers building the next drawables snapshot.
+        QMutex m_drawables_write_mutex;
+
+        /// The drawable items/geometries that have been cleared, waiting to be released (in batches) by releaseDrawables().
+        std::vector<std::shared_ptr<draw::Drawable>> m_drawables_released;
+
+        /// Mutex to protect the cleared drawable items/geometries waiting to be released.
+        QMutex m_drawables_released_mutex;
+
+        /// The number of drawable items/geometries released in each batch.
+        static const std::size_t m_drawables_released_batch_size = 10000;
+
+    private:
+
+        /// The clustered geometry points (nullptr if clustering is disabled).
+        std::unique_ptr<util::ClusterContainer> m_clusters;
+
+        /// The geometry points counted in the clusters (hidden geometry points are not counted).
+        std::set<const draw::geometry::Geometry*> m_clusters_counted;
+
+        /// Mutex to protect the clustered geometry points and the cluster pen/brush.
+        mutable QReadWriteLock m_clusters_mutex;
+
+        /// The pen to draw clusters with.
+        QPen m_cluster_pen { QColor(Qt::white) };
+
+        /// The brush to draw clusters with.
+        QBrush m_cluster_brush { QColor(0, 120, 215, 200) };
+
+        /// The projected size (in pixels) below which fixed geometries are culled (0 if culling is disabled).
+        qreal m_sub_pixel_threshold_px { 0.0 };
+
+        /// Whether culled geometries are collapsed into dots.
+        bool m_sub_pixel_collapse_to_dots { true };
+
+        /// The maximum number of geometries drawn per frame (0 if unlimited).
+        std::size_t m_geometry_budget { 0 };
+
+        /// The meta-data key that holds each geometry's priority.
+        std::string m_geometry_budget_priority_key;
+
+        /// Mutex to protect the geometry budget and sub-pixel culling settings.
+        mutable QMutex m_geometry_budget_mutex;
+
+        /// Whether labels are decluttered.
+        bool m_label_decluttering_enabled { false };
+
+        /// Whether geometries are drawn grouped by their style.
+        bool m_style_sorting_enabled { false };
+
+        /// The number of updates in progress (nested beginUpdate() calls).
+        int m_update_depth { 0 };
+
+        /// Whether the whole layer has changed during the update.
+        bool m_update_invalidate_all { false };
+
+        /// Whether a region has changed during the update.
+        bool m_update_invalidate_region { false };
+
+        /// The union of the regions that have changed during the update (world coordinates).
+        util::RectWorldCoord m_update_region_coord;
+
+        /// Mutex to protect the update state.
+        mutable QMutex m_update_mutex;
+
+        /// The viewport that the layer was last drawn with (nullptr until it is drawn), used to pad invalidated regions.
+        mutable std::unique_ptr<Viewport> m_drawn_viewport;
+
+        /// Mutex to protect the last drawn viewport.
+        mutable QMutex m_drawn_viewport_mutex;
+
+        /// The attribute table that stores the meta-data of the drawable items/geometries.
+        std::shared_ptr<util::AttributeTable> m_attribute_table;
+
+        /// Mutex to protect the attribute table.
+        mutable QMutex m_attribute_table_mutex;
+
+    private:
+
+        /// The types of queued update.
+        enum class UpdateType
+        {
+            /// Add a drawable item/geometry.
+            Add,
+
+            /// Remove a drawable item/geometry.
+            Remove,
+
+            /// Move a geometry point.
+            Move,
+
+            /// Restyle a geometry.
+            Restyle
+        };
+
+        /// Captures a queued update.
+        struct Update
+        {
+            /// The type of update.
+            UpdateType m_type;
+
+            /// The drawable item/geometry to update.
+            std::shared_ptr<draw::Drawable> m_drawable;
+
+            /// The new point (move only).
+            util::PointWorldCoord m_point_coord;
+
+            /// The new pen (restyle only).
+            std::shared_ptr<QPen> m_pen;
 
-        /// List of drawable geometries (fixed) drawn by this layer.
-        std::vector<std::shared_ptr<draw::geometry::GeometryFixed>> m_drawable_geometries_fixed;
+            /// The new brush (restyle only).
+            std::shared_ptr<QBrush> m_brush;
+        };
 
-        /// Mutex to protect drawable geometries.
-        mutable QReadWriteLock m_drawable_geometries_mutex;
+        /// The queued updates waiting to be applied.
+        util::MPSCQueue<Update> m_pending_updates;
 
     };
 
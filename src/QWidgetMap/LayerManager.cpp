@@ -65,6 +65,7 @@ void LayerManager::add(const std::shared_ptr<Layer>& layer, const int& index, co
 
         // Connect signals/slots to emit layer changed when redraw requests received.
         QObject::connect(layer.get(), &Layer::requestRedraw, this, &LayerManager::layerChanged);
+        QObject::connect(layer.get(), &Layer::requestRedrawRegion, this, &LayerManager::layerRegionChanged);
 
         // Connect signal/slot to pass on drawable clicked events.
         QObject::connect(layer.get(), &Layer::drawableClicked, this, &LayerManager::drawableClicked);
@@ -135,3 +136,16 @@ void LayerManager::remove(const std::string& name, const bool& disable_redraw)
         emit layerRemoved(layer_to_remove);
     }
 }
+
+util::MemoryUsage LayerManager::memoryUsage() const
+{
+    // Report each layer.
+    util::MemoryUsage return_memory_usage("LayerManager");
+    for(const auto& layer : layers())
+    {
+        return_memory_usage.addChild(layer->memoryUsage());
+    }
+
+    // Return the memory used.
+    return return_memory_usage;
+}
@@ -90,6 +90,12 @@ namespace qwm
          */
         void remove(const std::string& name, const bool& disable_redraw = false);
 
+        /**
+         * Fetches the memory used by each layer (see Layer::memoryUsage()).
+         * @return the memory used.
+         */
+        util::MemoryUsage memoryUsage() const;
+
     signals:
 
         /**
@@ -109,6 +115,12 @@ namespace qwm
          */
         void layerChanged();
 
+        /**
+         * Signal emitted when a region of a layer changes.
+         * @param region_coord The region that has changed (world coordinates).
+         */
+        void layerRegionChanged(const util::RectWorldCoord& region_coord);
+
         /**
          * Signal emitted when a layer is removed.
          * @param layer The layer that has been removed.
@@ -27,6 +27,7 @@
 // Local includes.
 #include "ui_QWidgetMap.h"
 #include "util/ImageManager.h"
+#include "util/SpriteAtlas.h"
 
 using namespace qwm;
 
@@ -54,6 +55,12 @@ QWidgetMap::QWidgetMap(const QSizeF& size_px, QWidget* parent, Qt::WindowFlags w
     // Connect signal/slot to update the primary screen when the render manager provides an image change.
     QObject::connect(&m_render_manager, &RenderManager::imageChanged, this, &QWidgetMap::updatePrimaryScreen);
 
+    // Register meta types.
+    qRegisterMetaType<util::MemoryUsage>("util::MemoryUsage");
+
+    // Connect signal/slot to periodically report the memory used.
+    QObject::connect(&m_memory_usage_timer, &QTimer::timeout, this, [this]() { emit memoryUsageReported(memoryUsage()); });
+
     // Connect signal/slot to update the controls when viewport changes are made.
     QObject::connect(m_viewport_manager.get(), &ViewportManager::viewportChanged, this, &QWidgetMap::updateUI);
 
@@ -73,6 +80,9 @@ QWidgetMap::~QWidgetMap()
 {
     // Destroy the image manager instance.
     util::ImageManager::destory();
+
+    // Destroy the sprite atlas instance.
+    util::SpriteAtlas::destroy();
 }
 
 ViewportManager& QWidgetMap::viewport_manager()
@@ -175,6 +185,45 @@ QPixmap QWidgetMap::primaryScreen() const
     return return_pixmap;
 }
 
+util::MemoryUsage QWidgetMap::memoryUsage() const
+{
+    // Report the primary screen pixmaps.
+    util::MemoryUsage primary_screen_usage("Primary screen");
+    {
+        // Gain a lock to protect the primary screen.
+        std::lock_guard<std::mutex> locker(m_mutex_primary_screen);
+
+        // Report the primary screen and the scaled primary screen.
+        primary_screen_usage.addChild(util::MemoryUsage("Pixmap", util::MemoryUsage::pixmapBytes(m_primary_screen_pixmap), true));
+        primary_screen_usage.addChild(util::MemoryUsage("Scaled pixmap", util::MemoryUsage::pixmapBytes(m_scaled_primary_screen_pixmap), true));
+    }
+
+    // Report the map's components.
+    util::MemoryUsage return_memory_usage("QWidgetMap");
+    return_memory_usage.addChild(util::ImageManager::get().memoryUsage());
+    return_memory_usage.addChild(m_render_manager.memoryUsage());
+    return_memory_usage.addChild(primary_screen_usage);
+    return_memory_usage.addChild(m_layer_manager->memoryUsage());
+
+    // Return the memory used.
+    return return_memory_usage;
+}
+
+void QWidgetMap::setMemoryUsageInterval(const std::chrono::milliseconds& interval)
+{
+    // Should the memory used be reported?
+    if(interval.count() > 0)
+    {
+        // Start (or restart) the timer at the interval.
+        m_memory_usage_timer.start(int(interval.count()));
+    }
+    else
+    {
+        // Stop the timer.
+        m_memory_usage_timer.stop();
+    }
+}
+
 void QWidgetMap::updateUI()
 {
     // Fetch the current viewport manager.
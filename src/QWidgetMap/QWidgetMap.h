@@ -20,6 +20,7 @@
 
 // Qt includes.
 #include <QtCore/QDir>
+#include <QtCore/QTimer>
 #include <QtNetwork/QNetworkProxy>
 #include <QtWidgets/QWidget>
 
@@ -33,6 +34,7 @@
 #include "LayerManager.h"
 #include "RenderManager.h"
 #include "ViewportManager.h"
+#include "util/MemoryUsage.h"
 
 /// QWidgetMap namespace.
 namespace qwm
@@ -151,6 +153,27 @@ namespace qwm
          */
         QPixmap primaryScreen() const;
 
+        /**
+         * Fetches the memory used by the map: the image manager's caches, the renderer, the primary screen pixmaps and each
+         * layer. Totals that include estimated sizes are flagged as estimated (see util::MemoryUsage).
+         * @return the memory used.
+         */
+        util::MemoryUsage memoryUsage() const;
+
+        /**
+         * Set how often the memory used is reported by memoryUsageReported() (ie: to log it, or check it against a budget).
+         * @param interval The interval between reports (0 to disable reporting).
+         */
+        void setMemoryUsageInterval(const std::chrono::milliseconds& interval = std::chrono::milliseconds(0));
+
+    signals:
+
+        /**
+         * Signal emitted periodically with the memory used (see setMemoryUsageInterval()).
+         * @param memory_usage The memory used.
+         */
+        void memoryUsageReported(const util::MemoryUsage& memory_usage);
+
     private:
 
         /**
@@ -208,6 +231,9 @@ namespace qwm
         /// Render manager.
         RenderManager m_render_manager;
 
+        /// Timer to report the memory used.
+        QTimer m_memory_usage_timer;
+
     private:
 
         /// Mutex to protect the primary screen usage.
@@ -47,10 +47,13 @@ HEADERS +=                                          \
     draw/geometry/GeometryEllipse.h                 \
     draw/geometry/GeometryFixed.h                   \
     draw/geometry/GeometryLineString.h              \
+    draw/geometry/GeometryMultiLineString.h         \
+    draw/geometry/GeometryMultiPolygon.h            \
     draw/geometry/GeometryPoint.h                   \
     draw/geometry/GeometryPointShape.h              \
     draw/geometry/GeometryPointArrow.h              \
     draw/geometry/GeometryPointCircle.h             \
+    draw/geometry/GeometryPointCollection.h         \
     draw/geometry/GeometryPointImage.h              \
     draw/geometry/GeometryPointText.h               \
     draw/geometry/GeometryPolygon.h                 \
@@ -58,17 +61,27 @@ HEADERS +=                                          \
     draw/map/MapGoogle.h                            \
     draw/map/MapOSM.h                               \
     draw/map/MapTile.h                              \
+    draw/other/Heatmap.h                            \
     projection/Projection.h                         \
     projection/ProjectionEquirectangular.h          \
     projection/ProjectionSphericalMercator.h        \
     util/Algorithms.h                               \
+    util/AttributeTable.h                           \
+    util/ChunkedVector.h                            \
+    util/ClusterContainer.h                         \
+    util/CollisionGrid.h                            \
     util/ImageManager.h                             \
     util/InertiaEventManager.h                      \
+    util/MemoryUsage.h                              \
+    util/MPSCQueue.h                                \
     util/NetworkManager.h                           \
     util/Point.h                                    \
     util/QuadtreeContainer.h                        \
     util/QProgressIndicator.h                       \
     util/Rect.h                                     \
+    util/ScratchBuffers.h                           \
+    util/SpriteAtlas.h                              \
+    util/VertexBuffer.h                             \
 
 # Add source files.
 SOURCES +=                                          \
@@ -84,10 +97,13 @@ SOURCES +=                                          \
     draw/geometry/GeometryEllipse.cpp               \
     draw/geometry/GeometryFixed.cpp                 \
     draw/geometry/GeometryLineString.cpp            \
+    draw/geometry/GeometryMultiLineString.cpp       \
+    draw/geometry/GeometryMultiPolygon.cpp          \
     draw/geometry/GeometryPoint.cpp                 \
     draw/geometry/GeometryPointShape.cpp            \
     draw/geometry/GeometryPointArrow.cpp            \
     draw/geometry/GeometryPointCircle.cpp           \
+    draw/geometry/GeometryPointCollection.cpp       \
     draw/geometry/GeometryPointImage.cpp            \
     draw/geometry/GeometryPointText.cpp             \
     draw/geometry/GeometryPolygon.cpp               \
@@ -95,14 +111,22 @@ SOURCES +=                                          \
     draw/map/MapGoogle.cpp                          \
     draw/map/MapOSM.cpp                             \
     draw/map/MapTile.cpp                            \
+    draw/other/Heatmap.cpp                          \
     projection/Projection.cpp                       \
     projection/ProjectionEquirectangular.cpp        \
     projection/ProjectionSphericalMercator.cpp      \
     util/Algorithms.cpp                             \
+    util/AttributeTable.cpp                         \
+    util/ClusterContainer.cpp                       \
+    util/CollisionGrid.cpp                          \
     util/ImageManager.cpp                           \
     util/InertiaEventManager.cpp                    \
+    util/MemoryUsage.cpp                            \
     util/NetworkManager.cpp                         \
     util/QProgressIndicator.cpp                     \
+    util/ScratchBuffers.cpp                         \
+    util/SpriteAtlas.cpp                            \
+    util/VertexBuffer.cpp                           \
 
 # Add form files.
 FORMS +=                                            \
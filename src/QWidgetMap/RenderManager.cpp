@@ -25,6 +25,7 @@
 
 // Local includes.
 #include "util/ImageManager.h"
+#include "util/ScratchBuffers.h"
 
 using namespace qwm;
 
@@ -38,6 +39,7 @@ RenderManager::RenderManager(const std::shared_ptr<ViewportManager>& viewport_ma
 
     // Connect signal/slots to process changes that require a redraw request.
     QObject::connect(m_layer_manager.get(), &LayerManager::layerChanged, this, &RenderManager::requestRedraw);
+    QObject::connect(m_layer_manager.get(), &LayerManager::layerRegionChanged, this, &RenderManager::requestRedrawRegion);
     QObject::connect(&(util::ImageManager::get()), &util::ImageManager::imageUpdated, this, &RenderManager::requestRedraw);
 
     // Start the render thread.
@@ -56,6 +58,17 @@ RenderManager::~RenderManager()
     }
 }
 
+util::MemoryUsage RenderManager::memoryUsage() const
+{
+    // Report the back buffer and scratch buffers.
+    util::MemoryUsage return_memory_usage("RenderManager");
+    return_memory_usage.addChild(util::MemoryUsage("Back buffer", m_back_buffer_bytes));
+    return_memory_usage.addChild(util::MemoryUsage("Scratch buffers", m_scratch_buffers_bytes));
+
+    // Return the memory used.
+    return return_memory_usage;
+}
+
 void RenderManager::requestRedraw()
 {
     // Get access to the queue mutex.
@@ -65,6 +78,20 @@ void RenderManager::requestRedraw()
     m_queue.push_back(true);
 }
 
+void RenderManager::requestRedrawRegion(const util::RectWorldCoord& region_coord)
+{
+    // Calculate the current drawing rect in world coordinates.
+    const QRectF drawing_rect_coord(drawingRectWorldCoord(Viewport(*(m_viewport_manager.get()))).normalized());
+
+    // Does the region overlap the drawing rect (inclusive, as the regions of geometry points are empty)?
+    const QRectF region(region_coord.normalized());
+    if(region.left() <= drawing_rect_coord.right() && region.right() >= drawing_rect_coord.left() && region.top() <= drawing_rect_coord.bottom() && region.bottom() >= drawing_rect_coord.top())
+    {
+        // Add the request to the queue.
+        requestRedraw();
+    }
+}
+
 void RenderManager::processRequests()
 {
     // Mark that processing is allowed.
@@ -86,8 +113,23 @@ void RenderManager::processRequests()
             m_queue.clear();
         }
 
-        // Is the queue empty?
-        if(m_queue_empty)
+        // Apply any queued layer updates at the frame boundary (each layer applies its updates in batches).
+        bool layers_updated(false);
+        for(const auto& layer : m_layer_manager->layers())
+        {
+            // Does the layer have any queued updates?
+            if(layer->hasPendingUpdates())
+            {
+                // Apply the queued updates.
+                layer->processPendingUpdates();
+
+                // A redraw is needed to display the updates.
+                layers_updated = true;
+            }
+        }
+
+        // Is the queue empty (and have no layers been updated)?
+        if(m_queue_empty && layers_updated == false)
         {
             // Emit that rendering has finished.
             emit renderingFinished();
@@ -130,6 +172,13 @@ void RenderManager::processRequests()
             // Undo the viewport's drawing top/left point translation.
             painter.translate(drawing_rect_world_px.topLeftPx());
 
+            // Reset the render thread's scratch buffers, now the frame has been drawn.
+            util::ScratchBuffers::local().reset();
+
+            // Keep track of the memory used by the frame.
+            m_back_buffer_bytes = std::size_t(image_drawing_viewport.bytesPerLine()) * std::size_t(image_drawing_viewport.height());
+            m_scratch_buffers_bytes = util::ScratchBuffers::local().bytesReserved();
+
             // Emit that we have a new image to display.
             emit imageChanged(QPixmap::fromImage(image_drawing_viewport), draw_rect_world_coord, current_viewport.zoom());
         }
@@ -22,6 +22,8 @@
 #include <QtCore/QObject>
 
 // STL includes.
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -30,6 +32,7 @@
 #include "qwidgetmap_global.h"
 #include "LayerManager.h"
 #include "ViewportManager.h"
+#include "util/MemoryUsage.h"
 #include "util/Rect.h"
 
 /// QWidgetMap namespace.
@@ -62,6 +65,16 @@ namespace qwm
         /// Destructor.
         ~RenderManager();
 
+    public:
+
+        /**
+         * Fetches the memory used by the renderer, as of the last frame drawn.
+         * The back buffer is allocated while each frame is drawn (and released once it has been converted for display),
+         * the scratch buffers are kept by the rendering thread between frames.
+         * @return the memory used.
+         */
+        util::MemoryUsage memoryUsage() const;
+
     public slots:
 
         /**
@@ -69,6 +82,13 @@ namespace qwm
          */
         void requestRedraw();
 
+        /**
+         * Slot to add a redraw request to the queue for a region that has changed.
+         * The request is ignored if the region is outside of the current drawing rect.
+         * @param region_coord The region that has changed (world coordinates).
+         */
+        void requestRedrawRegion(const util::RectWorldCoord& region_coord);
+
     private:
 
         /**
@@ -139,6 +159,12 @@ namespace qwm
         /// The rendering queue.
         std::vector<bool> m_queue;
 
+        /// The number of bytes used by the back buffer of the last frame drawn.
+        std::atomic<std::size_t> m_back_buffer_bytes { 0 };
+
+        /// The number of bytes reserved by the rendering thread's scratch buffers after the last frame drawn.
+        std::atomic<std::size_t> m_scratch_buffers_bytes { 0 };
+
     };
 
 }
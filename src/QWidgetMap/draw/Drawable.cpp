@@ -17,6 +17,10 @@
 
 #include "Drawable.h"
 
+// STL includes.
+#include <utility>
+#include <vector>
+
 using namespace qwm;
 using namespace qwm::draw;
 
@@ -27,6 +31,15 @@ Drawable::Drawable(const DrawableType& drawable_type, QObject* parent)
 
 }
 
+Drawable::~Drawable()
+{
+    // Release our row in the attribute table.
+    if(m_attribute_table != nullptr)
+    {
+        m_attribute_table->removeRow(m_attribute_row);
+    }
+}
+
 const DrawableType& Drawable::drawableType() const
 {
     // Return the drawable type.
@@ -38,12 +51,24 @@ QVariant Drawable::metadata(const std::string& key) const
     // Default return value.
     QVariant return_value;
 
-    // Find the key.
-    const auto itr_find(m_metadata.find(key));
-    if(itr_find != m_metadata.end())
+    // Gain a lock to protect the meta-data.
+    QMutexLocker locker(&m_metadata_mutex);
+
+    // Is the meta-data stored in an attribute table?
+    if(m_attribute_table != nullptr)
     {
-        // Fetch the value.
-        return_value = itr_find->second;
+        // Fetch the value from our row.
+        return_value = m_attribute_table->value(m_attribute_row, key);
+    }
+    else
+    {
+        // Find the key.
+        const auto itr_find(m_metadata.find(key));
+        if(itr_find != m_metadata.end())
+        {
+            // Fetch the value.
+            return_value = itr_find->second;
+        }
     }
 
     // Return the value.
@@ -52,8 +77,78 @@ QVariant Drawable::metadata(const std::string& key) const
 
 void Drawable::setMetadata(const std::string& key, const QVariant& value)
 {
-    // Set the meta-data.
-    m_metadata[key] = value;
+    // Gain a lock to protect the meta-data.
+    QMutexLocker locker(&m_metadata_mutex);
+
+    // Is the meta-data stored in an attribute table?
+    if(m_attribute_table != nullptr)
+    {
+        // Set the value in our row.
+        m_attribute_table->setValue(m_attribute_row, key, value);
+    }
+    else
+    {
+        // Set the meta-data.
+        m_metadata[key] = value;
+    }
+}
+
+std::shared_ptr<util::AttributeTable> Drawable::attributeTable() const
+{
+    // Gain a lock to protect the attribute table.
+    QMutexLocker locker(&m_metadata_mutex);
+
+    // Return the attribute table.
+    return m_attribute_table;
+}
+
+std::size_t Drawable::attributeRow() const
+{
+    // Gain a lock to protect the attribute row.
+    QMutexLocker locker(&m_metadata_mutex);
+
+    // Return the row allocated in the attribute table.
+    return m_attribute_row;
+}
+
+void Drawable::setAttributeTable(const std::shared_ptr<util::AttributeTable>& attribute_table)
+{
+    // Gain a lock to protect the meta-data (so it is never read whilst it is being moved).
+    QMutexLocker locker(&m_metadata_mutex);
+
+    // Only move the meta-data if the attribute table has changed.
+    if(m_attribute_table != attribute_table)
+    {
+        // Take the existing meta-data (from the current attribute table, or our own storage).
+        std::vector<std::pair<std::string, QVariant>> metadata;
+        if(m_attribute_table != nullptr)
+        {
+            metadata = m_attribute_table->values(m_attribute_row);
+            m_attribute_table->removeRow(m_attribute_row);
+        }
+        else
+        {
+            metadata.assign(m_metadata.begin(), m_metadata.end());
+            m_metadata.clear();
+        }
+
+        // Set the attribute table.
+        m_attribute_table = attribute_table;
+
+        // Move the meta-data into the new storage.
+        if(m_attribute_table != nullptr)
+        {
+            m_attribute_row = m_attribute_table->addRow();
+            for(const auto& value : metadata)
+            {
+                m_attribute_table->setValue(m_attribute_row, value.first, value.second);
+            }
+        }
+        else
+        {
+            m_metadata.insert(metadata.begin(), metadata.end());
+        }
+    }
 }
 
 bool Drawable::visible() const
@@ -86,19 +181,40 @@ void Drawable::setVisible(const bool& enabled)
         // Set the visibility.
         m_visible = enabled;
 
+        // Emit that the visibility has changed (allows the layer to update its clusters).
+        emit visibilityChanged(enabled);
+
         // Emit that we need to redraw to display this change.
         emit requestRedraw();
     }
 }
 
+int Drawable::zoomMinimum() const
+{
+    // Return the zoom minimum.
+    return m_zoom_minimum;
+}
+
+int Drawable::zoomMaximum() const
+{
+    // Return the zoom maximum.
+    return m_zoom_maximum;
+}
+
 void Drawable::setZoomMinimum(const int& zoom_minimum)
 {
     // Only update zoom minimum if it has changed.
     if(m_zoom_minimum != zoom_minimum)
     {
+        // Keep track of the previous zoom minimum.
+        const int previous_zoom_minimum(m_zoom_minimum);
+
         // Set the zoom minimum.
         m_zoom_minimum = zoom_minimum;
 
+        // Emit that the zoom range has changed (allows the layer to re-bucket this drawable item).
+        emit zoomRangeChanged(previous_zoom_minimum, m_zoom_maximum);
+
         // Emit that we need to redraw to display this change.
         emit requestRedraw();
     }
@@ -109,10 +225,42 @@ void Drawable::setZoomMaximum(const int& zoom_maximum)
     // Only update zoom maximum if it has changed.
     if(m_zoom_maximum != zoom_maximum)
     {
+        // Keep track of the previous zoom maximum.
+        const int previous_zoom_maximum(m_zoom_maximum);
+
         // Set the zoom maximum.
         m_zoom_maximum = zoom_maximum;
 
+        // Emit that the zoom range has changed (allows the layer to re-bucket this drawable item).
+        emit zoomRangeChanged(m_zoom_minimum, previous_zoom_maximum);
+
         // Emit that we need to redraw to display this change.
         emit requestRedraw();
     }
 }
+
+std::size_t Drawable::memoryBytes() const
+{
+    // Return the size of the object (subclasses that hold storage add it).
+    return sizeof(Drawable);
+}
+
+std::size_t Drawable::metadataMemoryBytes() const
+{
+    // Gain a lock to protect the meta-data.
+    QMutexLocker locker(&m_metadata_mutex);
+
+    // Estimate each meta-data entry (the map node, the key's characters and any string value's characters).
+    std::size_t return_bytes(0);
+    for(const auto& value : m_metadata)
+    {
+        return_bytes += sizeof(std::map<std::string, QVariant>::value_type) + (4 * sizeof(void*)) + value.first.capacity();
+        if(value.second.type() == QVariant::String)
+        {
+            return_bytes += std::size_t(value.second.toString().size()) * sizeof(QChar);
+        }
+    }
+
+    // Return the estimated number of bytes.
+    return return_bytes;
+}
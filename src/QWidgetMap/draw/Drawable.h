@@ -18,13 +18,21 @@
 #pragma once
 
 // Qt includes.
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QVariant>
 #include <QtGui/QPainter>
 
+// STL includes.
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
 // Local includes.
 #include "../qwidgetmap_global.h"
 #include "../Viewport.h"
+#include "../util/AttributeTable.h"
 #include "../util/Rect.h"
 
 /// QWidgetMap namespace.
@@ -45,7 +53,13 @@ namespace qwm
             Map,
 
             /// ESRI Shapefile.
-            ESRIShapefile
+            ESRIShapefile,
+
+            /// Heatmap.
+            Heatmap,
+
+            /// Geometry point collection.
+            GeometryPointCollection
         };
 
         /**
@@ -73,7 +87,7 @@ namespace qwm
             Drawable& operator=(const Drawable&) = delete;
 
             /// Destructor.
-            virtual ~Drawable() = default;
+            virtual ~Drawable();
 
         public:
 
@@ -85,6 +99,7 @@ namespace qwm
 
             /**
              * Fetches a meta-data value.
+             * When the meta-data is stored in an attribute table, integer values (ie: int) are returned as qlonglong.
              * @param key The meta-data key.
              * @return the meta-data value.
              */
@@ -97,6 +112,27 @@ namespace qwm
              */
             void setMetadata(const std::string& key, const QVariant& value);
 
+            /**
+             * Fetches the attribute table that stores the meta-data.
+             * @return the attribute table that stores the meta-data, or nullptr if the meta-data is stored by this drawable item.
+             */
+            std::shared_ptr<util::AttributeTable> attributeTable() const;
+
+            /**
+             * Fetches the row allocated to this drawable item in the attribute table.
+             * @return the row allocated in the attribute table (only valid when an attribute table is set).
+             */
+            std::size_t attributeRow() const;
+
+            /**
+             * Set the attribute table to store the meta-data in (columnar storage shared by many drawable items).
+             * A row is allocated in the table and any existing meta-data is moved into it, metadata()/setMetadata() then
+             * read/write the table (integer values are then returned as qlonglong). Setting nullptr moves the meta-data back into
+             * this drawable item.
+             * @param attribute_table The attribute table to store the meta-data in.
+             */
+            void setAttributeTable(const std::shared_ptr<util::AttributeTable>& attribute_table);
+
             /**
              * Fetches whether the drawable item is visible.
              * @return whether the drawable item is visible.
@@ -116,6 +152,18 @@ namespace qwm
              */
             void setVisible(const bool& enabled);
 
+            /**
+             * Fetches the minimum zoom level to show this drawable item at.
+             * @return the minimum zoom level to show this drawable item at.
+             */
+            int zoomMinimum() const;
+
+            /**
+             * Fetches the maximum zoom level to show this drawable item at.
+             * @return the maximum zoom level to show this drawable item at.
+             */
+            int zoomMaximum() const;
+
             /**
              * Set the minimum zoom level to show this drawable item at.
              * @param zoom_minimum The minimum zoom level to show this drawable item at.
@@ -128,6 +176,19 @@ namespace qwm
              */
             void setZoomMaximum(const int& zoom_maximum = 17);
 
+            /**
+             * Estimates the number of bytes used by the drawable item (the object and the storage it holds, excluding its meta-data).
+             * Drawable items that hold storage (ie: vertices, points, caches) override this.
+             * @return the estimated number of bytes used.
+             */
+            virtual std::size_t memoryBytes() const;
+
+            /**
+             * Estimates the number of bytes used by the meta-data stored by this drawable item.
+             * @return the estimated number of bytes used (0 when the meta-data is stored in an attribute table).
+             */
+            std::size_t metadataMemoryBytes() const;
+
         public:
 
             /**
@@ -150,14 +211,36 @@ namespace qwm
              */
             void requestRedraw() const;
 
+            /**
+             * Signal emitted when the zoom levels to show this drawable item at have changed.
+             * @param previous_zoom_minimum The previous minimum zoom level.
+             * @param previous_zoom_maximum The previous maximum zoom level.
+             */
+            void zoomRangeChanged(const int& previous_zoom_minimum, const int& previous_zoom_maximum) const;
+
+            /**
+             * Signal emitted when the visibility of the drawable item has changed.
+             * @param visible Whether the drawable item is now visible.
+             */
+            void visibilityChanged(const bool& visible) const;
+
         private:
 
             /// The drawable type.
             const DrawableType m_drawable_type;
 
-            /// Meta-data storage.
+            /// Mutex to protect the meta-data, attribute table and attribute row.
+            mutable QMutex m_metadata_mutex;
+
+            /// Meta-data storage (used when no attribute table is set).
             std::map<std::string, QVariant> m_metadata;
 
+            /// The attribute table that stores the meta-data.
+            std::shared_ptr<util::AttributeTable> m_attribute_table;
+
+            /// The row allocated in the attribute table.
+            std::size_t m_attribute_row { 0 };
+
             /// Whether the drawable item is visible.
             bool m_visible { true };
 
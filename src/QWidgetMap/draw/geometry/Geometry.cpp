@@ -18,10 +18,27 @@
 
 #include "Geometry.h"
 #include "../../projection/Projection.h"
+#include "../../util/MemoryUsage.h"
+
+// Qt includes.
+#include <QtGui/QTransform>
+
+// STL includes.
+#include <memory>
+#include <vector>
 
 using namespace qwm;
 using namespace qwm::draw::geometry;
 
+namespace
+{
+    /// The default pen, shared by all geometries without a pen set (so they can be drawn as one style group).
+    const std::shared_ptr<QPen> m_default_pen(std::make_shared<QPen>());
+
+    /// The default brush, shared by all geometries without a brush set (so they can be drawn as one style group).
+    const std::shared_ptr<QBrush> m_default_brush(std::make_shared<QBrush>());
+}
+
 Geometry::Geometry(const GeometryType& geometry_type, QObject* parent)
     : Drawable(DrawableType::Geometry, parent),
       m_geometry_type(geometry_type)
@@ -35,23 +52,19 @@ const GeometryType& Geometry::geometryType() const
     return m_geometry_type;
 }
 
-const QPen& Geometry::pen() const
+QPen Geometry::pen() const
 {
-    // Do we have a pen?
-    if(m_pen == nullptr)
-    {
-        // Create a default pen.
-        m_pen = std::make_shared<QPen>();
-    }
+    // Gain a lock to protect the pen/brush.
+    QMutexLocker locker(&m_style_mutex);
 
-    // Get the pen to draw with.
-    return *(m_pen.get());
+    // Get the pen to draw with (the shared default pen if none is set).
+    return m_pen == nullptr ? *m_default_pen : *m_pen;
 }
 
 void Geometry::setPen(const std::shared_ptr<QPen>& pen)
 {
     // Set the pen to draw with.
-    m_pen = pen;
+    restyle(pen, nullptr);
 
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
@@ -60,29 +73,25 @@ void Geometry::setPen(const std::shared_ptr<QPen>& pen)
 void Geometry::setPen(const QPen& pen)
 {
     // Set the pen to draw with.
-    m_pen = std::make_shared<QPen>(pen);
+    restyle(std::make_shared<QPen>(pen), nullptr);
 
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
 }
 
-const QBrush& Geometry::brush() const
+QBrush Geometry::brush() const
 {
-    // Do we have a brush?
-    if(m_brush == nullptr)
-    {
-        // Create a default brush.
-        m_brush = std::make_shared<QBrush>();
-    }
+    // Gain a lock to protect the pen/brush.
+    QMutexLocker locker(&m_style_mutex);
 
-    // Get the brush to draw with.
-    return *(m_brush.get());
+    // Get the brush to draw with (the shared default brush if none is set).
+    return m_brush == nullptr ? *m_default_brush : *m_brush;
 }
 
 void Geometry::setBrush(const std::shared_ptr<QBrush>& brush)
 {
     // Set the brush to draw with.
-    m_brush = brush;
+    restyle(nullptr, brush);
 
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
@@ -91,12 +100,41 @@ void Geometry::setBrush(const std::shared_ptr<QBrush>& brush)
 void Geometry::setBrush(const QBrush& brush)
 {
     // Set the brush to draw with.
-    m_brush = std::make_shared<QBrush>(brush);
+    restyle(nullptr, std::make_shared<QBrush>(brush));
 
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
 }
 
+void Geometry::restyle(const std::shared_ptr<QPen>& pen, const std::shared_ptr<QBrush>& brush)
+{
+    // Gain a lock to protect the pen/brush.
+    QMutexLocker locker(&m_style_mutex);
+
+    // Set the pen to draw with (if one is given).
+    if(pen != nullptr)
+    {
+        m_pen = pen;
+    }
+
+    // Set the brush to draw with (if one is given).
+    if(brush != nullptr)
+    {
+        m_brush = brush;
+    }
+
+    // Unlock the pen/brush (the style change may need to read them).
+    locker.unlock();
+
+    // Let the geometry update anything that depends on its pen/brush.
+    styleChanged();
+}
+
+void Geometry::styleChanged()
+{
+    // Nothing depends on the pen/brush by default.
+}
+
 const QFont& Geometry::font() const
 {
     // Do we have a font?
@@ -115,6 +153,12 @@ void Geometry::setFont(const std::shared_ptr<QFont>& font)
     // Set the font to draw with.
     m_font = font;
 
+    // Invalidate the meta-data text layout.
+    {
+        QMutexLocker locker(&m_metadata_displayed_layout_mutex);
+        m_metadata_displayed_layout.reset();
+    }
+
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
 }
@@ -124,6 +168,12 @@ void Geometry::setFont(const QFont& font)
     // Set the font to draw with.
     m_font = std::make_shared<QFont>(font);
 
+    // Invalidate the meta-data text layout.
+    {
+        QMutexLocker locker(&m_metadata_displayed_layout_mutex);
+        m_metadata_displayed_layout.reset();
+    }
+
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
 }
@@ -136,15 +186,25 @@ void Geometry::setMetadataDisplayed(const std::string& key, const int& zoom_mini
     m_metadata_displayed_alignment_type = alignment_type;
     m_metadata_displayed_alignment_offset_px = alignment_offset_px;
 
+    // Invalidate the meta-data text layout.
+    {
+        QMutexLocker locker(&m_metadata_displayed_layout_mutex);
+        m_metadata_displayed_layout.reset();
+    }
+
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
 }
 
-void Geometry::drawMetadataDisplayed(QPainter& painter, const Viewport& viewport)
+void Geometry::drawMetadataDisplayed(QPainter& painter, const Viewport& viewport, util::CollisionGrid* collision_grid)
 {
     // Do we have a meta-data value and should we display it at this zoom?
-    if(viewport.zoom() >= m_metadata_displayed_zoom_minimum && metadata(m_metadata_displayed_key).isNull() == false)
+    const QVariant metadata_value(metadata(m_metadata_displayed_key));
+    if(viewport.zoom() >= m_metadata_displayed_zoom_minimum && metadata_value.isNull() == false)
     {
+        // Fetch the meta-data text to display.
+        const QString text(metadata_value.toString());
+
         // Fetch the bounding box of the geometry.
         const util::RectWorldCoord geometry_rect_coord(boundingBox(viewport));
         const util::RectWorldPx geometry_rect_px(projection::toPointWorldPx(viewport, geometry_rect_coord.topLeftCoord()), projection::toPointWorldPx(viewport, geometry_rect_coord.bottomRightCoord()));
@@ -153,61 +213,161 @@ void Geometry::drawMetadataDisplayed(QPainter& painter, const Viewport& viewport
         painter.setPen(pen());
         painter.setFont(font());
 
-        // Calculate the text rect box.
-        const QRectF text_rect_px(painter.boundingRect(QRectF{}, Qt::AlignLeft, metadata(m_metadata_displayed_key).toString()));
-
-        // Draw the text next to the point with an offset.
-        switch(m_metadata_displayed_alignment_type)
+        // Fetch the text layout (the text is only laid out again when the text or font changes).
+        QStaticText text_layout;
         {
-            case AlignmentType::Middle:
-            {
-                painter.drawText(geometry_rect_px.center() + util::PointPx(-text_rect_px.width() / 2.0, text_rect_px.height() / 2.0), metadata(m_metadata_displayed_key).toString());
-                break;
-            }
-            case AlignmentType::MiddleLeft:
-            {
-                painter.drawText(util::PointWorldPx(geometry_rect_px.left(), geometry_rect_px.center().y()) + util::PointPx(-m_metadata_displayed_alignment_offset_px, 0) + util::PointPx(-text_rect_px.width(), text_rect_px.height() / 2.0), metadata(m_metadata_displayed_key).toString());
-                break;
-            }
-            case AlignmentType::MiddleRight:
-            {
-                painter.drawText(util::PointWorldPx(geometry_rect_px.right(), geometry_rect_px.center().y()) + util::PointPx(m_metadata_displayed_alignment_offset_px, 0) + util::PointPx(0, text_rect_px.height() / 2.0), metadata(m_metadata_displayed_key).toString());
-                break;
-            }
-            case AlignmentType::TopLeft:
-            {
-                painter.drawText(geometry_rect_px.bottomLeft() + util::PointPx(-m_metadata_displayed_alignment_offset_px, -m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_rect_px.width(), 0), metadata(m_metadata_displayed_key).toString());
-                break;
-            }
-            case AlignmentType::TopRight:
-            {
-                painter.drawText(geometry_rect_px.bottomRight() + util::PointPx(m_metadata_displayed_alignment_offset_px, -m_metadata_displayed_alignment_offset_px), metadata(m_metadata_displayed_key).toString());
-                break;
-            }
-            case AlignmentType::TopMiddle:
-            {
-                painter.drawText(util::PointWorldPx(geometry_rect_px.center().x(), geometry_rect_px.bottom()) + util::PointPx(0, -m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_rect_px.width() / 2.0, 0), metadata(m_metadata_displayed_key).toString());
-                break;
-            }
-            case AlignmentType::BottomLeft:
+            // Gain a lock to protect the text layout.
+            QMutexLocker locker(&m_metadata_displayed_layout_mutex);
+
+            // Does the text need to be laid out?
+            if(m_metadata_displayed_layout == nullptr || m_metadata_displayed_layout->m_text != text || m_metadata_displayed_layout->m_font != font())
             {
-                painter.drawText(geometry_rect_px.topLeft() + util::PointPx(-m_metadata_displayed_alignment_offset_px, m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_rect_px.width(), text_rect_px.height()), metadata(m_metadata_displayed_key).toString());
-                break;
+                // Lay out the text (the layout is allocated the first time it is needed).
+                if(m_metadata_displayed_layout == nullptr)
+                {
+                    m_metadata_displayed_layout.reset(new MetadataDisplayedLayout());
+                }
+                m_metadata_displayed_layout->m_text = text;
+                m_metadata_displayed_layout->m_font = font();
+                m_metadata_displayed_layout->m_layout = layoutText(text, font());
             }
-            case AlignmentType::BottomRight:
+
+            // Take a (shallow) copy of the text layout.
+            text_layout = m_metadata_displayed_layout->m_layout;
+        }
+
+        // Fetch the text rect box.
+        const QRectF text_rect_px(QPointF(0.0, 0.0), text_layout.size());
+
+        // The alignments to try, the preferred alignment first (the others are only tried when decluttering).
+        std::vector<AlignmentType> alignment_types { m_metadata_displayed_alignment_type };
+        if(collision_grid != nullptr)
+        {
+            // Add the other alignments in priority order.
+            for(const auto& alignment_type : { AlignmentType::TopRight, AlignmentType::BottomRight, AlignmentType::TopLeft, AlignmentType::BottomLeft, AlignmentType::MiddleRight, AlignmentType::MiddleLeft, AlignmentType::TopMiddle, AlignmentType::BottomMiddle, AlignmentType::Middle })
             {
-                painter.drawText(geometry_rect_px.topRight() + util::PointPx(m_metadata_displayed_alignment_offset_px, m_metadata_displayed_alignment_offset_px) + util::PointPx(0, text_rect_px.height()), metadata(m_metadata_displayed_key).toString());
-                break;
+                if(alignment_type != m_metadata_displayed_alignment_type)
+                {
+                    alignment_types.push_back(alignment_type);
+                }
             }
-            case AlignmentType::BottomMiddle:
+        }
+
+        // Loop through each alignment, until the text has been placed.
+        for(const auto& alignment_type : alignment_types)
+        {
+            // Calculate where the text would be drawn (placed in world pixels, so that placements are stable whilst panning).
+            const QPointF text_point_px(metadataDisplayedPointPx(geometry_rect_px, alignment_type, text_rect_px.size()));
+            const QRectF label_rect_px(text_point_px.x(), text_point_px.y() - text_rect_px.height(), text_rect_px.width(), text_rect_px.height());
+
+            // Can the text be placed here?
+            if(collision_grid == nullptr || collision_grid->insert(label_rect_px))
             {
-                painter.drawText(util::PointWorldPx(geometry_rect_px.center().x(), geometry_rect_px.top()) + util::PointPx(0, m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_rect_px.width() / 2.0, text_rect_px.height()), metadata(m_metadata_displayed_key).toString());
+                // Draw the text next to the geometry with an offset.
+                painter.drawStaticText(label_rect_px.topLeft(), text_layout);
+
+                // Finished.
                 break;
             }
         }
     }
 }
 
+QStaticText Geometry::layoutText(const QString& text, const QFont& font)
+{
+    // Create the static text (plain text, with new line characters converted to line separators so they start a new line).
+    QStaticText return_static_text(QString(text).replace(QChar('\n'), QChar(QChar::LineSeparator)));
+    return_static_text.setTextFormat(Qt::PlainText);
+
+    // Lay out the text with the font.
+    return_static_text.prepare(QTransform(), font);
+
+    // Return the laid out text.
+    return return_static_text;
+}
+
+QRectF Geometry::textRectPx(const Viewport& /*viewport*/) const
+{
+    // By default, geometries do not draw text.
+    return QRectF();
+}
+
+std::size_t Geometry::metadataDisplayedLayoutMemoryBytes() const
+{
+    // Gain a lock to protect the meta-data text layout.
+    QMutexLocker locker(&m_metadata_displayed_layout_mutex);
+
+    // Has the meta-data text been laid out?
+    std::size_t return_bytes(0);
+    if(m_metadata_displayed_layout != nullptr)
+    {
+        // Add the text and its layout to the size of the cache entry.
+        return_bytes = sizeof(MetadataDisplayedLayout) + (std::size_t(m_metadata_displayed_layout->m_text.size()) * sizeof(QChar)) + util::MemoryUsage::staticTextBytes(m_metadata_displayed_layout->m_layout);
+    }
+
+    // Return the memory used.
+    return return_bytes;
+}
+
+QPointF Geometry::metadataDisplayedPointPx(const util::RectWorldPx& geometry_rect_px, const AlignmentType& alignment_type, const QSizeF& text_size_px) const
+{
+    // Default world point to return.
+    QPointF return_point_px(geometry_rect_px.center());
+
+    // Apply the alignment type (with an offset from the geometry).
+    switch(alignment_type)
+    {
+        case AlignmentType::Middle:
+        {
+            return_point_px = geometry_rect_px.center() + util::PointPx(-text_size_px.width() / 2.0, text_size_px.height() / 2.0);
+            break;
+        }
+        case AlignmentType::MiddleLeft:
+        {
+            return_point_px = util::PointWorldPx(geometry_rect_px.left(), geometry_rect_px.center().y()) + util::PointPx(-m_metadata_displayed_alignment_offset_px, 0) + util::PointPx(-text_size_px.width(), text_size_px.height() / 2.0);
+            break;
+        }
+        case AlignmentType::MiddleRight:
+        {
+            return_point_px = util::PointWorldPx(geometry_rect_px.right(), geometry_rect_px.center().y()) + util::PointPx(m_metadata_displayed_alignment_offset_px, 0) + util::PointPx(0, text_size_px.height() / 2.0);
+            break;
+        }
+        case AlignmentType::TopLeft:
+        {
+            return_point_px = geometry_rect_px.bottomLeft() + util::PointPx(-m_metadata_displayed_alignment_offset_px, -m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_size_px.width(), 0);
+            break;
+        }
+        case AlignmentType::TopRight:
+        {
+            return_point_px = geometry_rect_px.bottomRight() + util::PointPx(m_metadata_displayed_alignment_offset_px, -m_metadata_displayed_alignment_offset_px);
+            break;
+        }
+        case AlignmentType::TopMiddle:
+        {
+            return_point_px = util::PointWorldPx(geometry_rect_px.center().x(), geometry_rect_px.bottom()) + util::PointPx(0, -m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_size_px.width() / 2.0, 0);
+            break;
+        }
+        case AlignmentType::BottomLeft:
+        {
+            return_point_px = geometry_rect_px.topLeft() + util::PointPx(-m_metadata_displayed_alignment_offset_px, m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_size_px.width(), text_size_px.height());
+            break;
+        }
+        case AlignmentType::BottomRight:
+        {
+            return_point_px = geometry_rect_px.topRight() + util::PointPx(m_metadata_displayed_alignment_offset_px, m_metadata_displayed_alignment_offset_px) + util::PointPx(0, text_size_px.height());
+            break;
+        }
+        case AlignmentType::BottomMiddle:
+        {
+            return_point_px = util::PointWorldPx(geometry_rect_px.center().x(), geometry_rect_px.top()) + util::PointPx(0, m_metadata_displayed_alignment_offset_px) + util::PointPx(-text_size_px.width() / 2.0, text_size_px.height());
+            break;
+        }
+    }
+
+    // Return the world point.
+    return return_point_px;
+}
+
 util::PointWorldPx Geometry::calculateTopLeftPoint(const util::PointWorldPx& point_px, const AlignmentType& alignment_type, const QSizeF& geometry_size_px) const
 {
     // Default world point to return.
@@ -19,8 +19,11 @@
 #pragma once
 
 // Qt includes.
+#include <QtCore/QMutex>
 #include <QtGui/QBrush>
+#include <QtGui/QFont>
 #include <QtGui/QPen>
+#include <QtGui/QStaticText>
 
 // STL includes.
 #include <memory>
@@ -29,6 +32,7 @@
 // Local includes.
 #include "../../qwidgetmap_global.h"
 #include "../../Viewport.h"
+#include "../../util/CollisionGrid.h"
 #include "../../util/Point.h"
 #include "../../util/Rect.h"
 #include "../Drawable.h"
@@ -54,6 +58,12 @@ namespace qwm
                 /// Geometry that represents a line string.
                 GeometryLineString,
 
+                /// Geometry that represents multiple line strings.
+                GeometryMultiLineString,
+
+                /// Geometry that represents multiple polygons (with holes).
+                GeometryMultiPolygon,
+
                 /// Geometry that represents a point.
                 GeometryPoint,
 
@@ -131,7 +141,7 @@ namespace qwm
                  * Fetches the pen to draw the geometry with (outline).
                  * @return the QPen to use for drawing.
                  */
-                const QPen& pen() const;
+                QPen pen() const;
 
                 /**
                  * Sets the pen to draw the geometry with (outline).
@@ -149,7 +159,7 @@ namespace qwm
                  * Fetches the brush to draw the geometry with (fill).
                  * @return the QBrush to use for drawing.
                  */
-                const QBrush& brush() const;
+                QBrush brush() const;
 
                 /**
                  * Sets the brush to draw the geometry with (fill).
@@ -163,6 +173,14 @@ namespace qwm
                  */
                 virtual void setBrush(const QBrush& brush);
 
+                /**
+                 * Sets the pen/brush to draw the geometry with, without emitting any signals.
+                 * This is used by a layer that applies queued style changes at the start of a frame.
+                 * @param pen The QPen to use for drawing (nullptr to leave unchanged).
+                 * @param brush The QBrush to use for drawing (nullptr to leave unchanged).
+                 */
+                void restyle(const std::shared_ptr<QPen>& pen, const std::shared_ptr<QBrush>& brush);
+
                 /**
                  * Fetches the font to draw the geometry's metadata with.
                  * @return the QFont to use for drawing.
@@ -192,13 +210,35 @@ namespace qwm
 
                 /**
                  * Draws the meta-data to display if set.
+                 * When a collision grid is provided, the candidate alignments are tried in priority order (the preferred alignment
+                 * first) and the meta-data is drawn at the first that does not collide with a label already placed, or not at all.
                  * @param painter The painter to draw on.
                  * @param viewport The current viewport to use.
+                 * @param collision_grid The labels already placed in world pixels (nullptr to always draw the meta-data).
                  */
-                void drawMetadataDisplayed(QPainter& painter, const Viewport& viewport);
+                void drawMetadataDisplayed(QPainter& painter, const Viewport& viewport, util::CollisionGrid* collision_grid = nullptr);
+
+                /**
+                 * Fetches the rect that the geometry's own text occupies, used to declutter text geometries against labels.
+                 * @param viewport The current viewport to use.
+                 * @return the text rect in world pixels (empty if the geometry does not draw text).
+                 */
+                virtual QRectF textRectPx(const Viewport& viewport) const;
+
+                /**
+                 * Estimates the number of bytes used by the meta-data text that has been laid out for display.
+                 * @return the estimated number of bytes used (0 until meta-data is displayed).
+                 */
+                std::size_t metadataDisplayedLayoutMemoryBytes() const;
 
             protected:
 
+                /**
+                 * Called after the pen/brush has changed, so that anything that depends on them can be updated.
+                 * This must not emit any signals.
+                 */
+                virtual void styleChanged();
+
                 /**
                  * Calculates the top-left world point in pixels after the alignment type has been applied.
                  * @param point_px The world point in pixels to align.
@@ -208,6 +248,25 @@ namespace qwm
                  */
                 util::PointWorldPx calculateTopLeftPoint(const util::PointWorldPx& point_px, const AlignmentType& alignment_type, const QSizeF& geometry_size_px) const;
 
+                /**
+                 * Lays out text once, so that it can be drawn repeatedly (with QPainter::drawStaticText) without being shaped again.
+                 * @param text The text to lay out (new line characters start a new line).
+                 * @param font The font to lay out the text with.
+                 * @return the laid out text.
+                 */
+                static QStaticText layoutText(const QString& text, const QFont& font);
+
+            private:
+
+                /**
+                 * Calculates the point to draw the meta-data text from (bottom-left) after the alignment type has been applied.
+                 * @param geometry_rect_px The geometry's bounding box in world pixels.
+                 * @param alignment_type The alignment type to use.
+                 * @param text_size_px The size of the meta-data text in pixels.
+                 * @return the bottom-left world point in pixels.
+                 */
+                QPointF metadataDisplayedPointPx(const util::RectWorldPx& geometry_rect_px, const AlignmentType& alignment_type, const QSizeF& text_size_px) const;
+
             public:
 
                 /**
@@ -230,11 +289,14 @@ namespace qwm
                 /// The geometry type.
                 const GeometryType m_geometry_type;
 
-                /// The pen to use when drawing a geometry.
-                mutable std::shared_ptr<QPen> m_pen;
+                /// Mutex to protect the pen/brush.
+                mutable QMutex m_style_mutex;
+
+                /// The pen to use when drawing a geometry (nullptr for the shared default pen).
+                std::shared_ptr<QPen> m_pen;
 
-                /// The brush to use when drawing a geometry.
-                mutable std::shared_ptr<QBrush> m_brush;
+                /// The brush to use when drawing a geometry (nullptr for the shared default brush).
+                std::shared_ptr<QBrush> m_brush;
 
                 /// The font to use when drawing a geometry's metadata.
                 mutable std::shared_ptr<QFont> m_font;
@@ -251,6 +313,25 @@ namespace qwm
                 /// The offset that the meta-data value is displayed from in pixels.
                 double m_metadata_displayed_alignment_offset_px { 5.0 };
 
+                /// The meta-data text that has been laid out (only allocated once meta-data is displayed).
+                struct MetadataDisplayedLayout
+                {
+                    /// The meta-data text that has been laid out.
+                    QString m_text;
+
+                    /// The font that the meta-data text has been laid out with.
+                    QFont m_font;
+
+                    /// The meta-data text layout.
+                    QStaticText m_layout;
+                };
+
+                /// Mutex to protect the meta-data text layout.
+                mutable QMutex m_metadata_displayed_layout_mutex;
+
+                /// The meta-data text layout (nullptr until meta-data is displayed, or when it needs to be laid out again).
+                std::unique_ptr<MetadataDisplayedLayout> m_metadata_displayed_layout;
+
             };
 
         }
@@ -114,6 +114,22 @@ bool GeometryEllipse::touches(const Geometry& geometry, const Viewport& viewport
                 // Finished.
                 break;
             }
+            case GeometryType::GeometryMultiLineString:
+            {
+                // Set touches response based on multi line string vs ellipse check.
+                return_touches = geometry.touches(*this, viewport);
+
+                // Finished.
+                break;
+            }
+            case GeometryType::GeometryMultiPolygon:
+            {
+                // Set touches response based on multi polygon vs ellipse check.
+                return_touches = geometry.touches(*this, viewport);
+
+                // Finished.
+                break;
+            }
             case GeometryType::GeometryPoint:
             {
                 // They have touched if the shapes intersect.
@@ -173,6 +189,12 @@ void GeometryEllipse::draw(QPainter& painter, const util::RectWorldCoord& /*draw
     painter.translate(-ellipse_rect_px.centerPx());
 }
 
+std::size_t GeometryEllipse::memoryBytes() const
+{
+    // Return the size of the object.
+    return sizeof(GeometryEllipse);
+}
+
 void GeometryEllipse::drawPreview(QPainter& painter, const Viewport& viewport, const util::PointViewportPx& mouse_position_pressed_px) const
 {
     // Convert each destination point to pixels.
@@ -105,6 +105,12 @@ namespace qwm
                  */
                 void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
 
+                /**
+                 * Estimates the number of bytes used by the ellipse (the object).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
             public:
 
                 /**
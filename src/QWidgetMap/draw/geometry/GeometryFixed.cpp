@@ -18,6 +18,23 @@
 
 #include "GeometryFixed.h"
 
+// Qt includes.
+#include <QtGui/QPainterPathStroker>
+
+// STL includes.
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Local includes.
+#include "../../projection/Projection.h"
+#include "../../util/Algorithms.h"
+#include "../../util/ScratchBuffers.h"
+#include "GeometryLineString.h"
+#include "GeometryMultiLineString.h"
+#include "GeometryMultiPolygon.h"
+#include "GeometryPolygon.h"
+
 using namespace qwm;
 using namespace qwm::draw::geometry;
 
@@ -26,3 +43,318 @@ GeometryFixed::GeometryFixed(const GeometryType& geometry_type, QObject* parent)
 {
 
 }
+
+void GeometryFixed::appendClippedPolylinesPx(const util::VertexBuffer& points, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport, std::vector<QPointF>& points_px, std::vector<int>& polyline_sizes, const std::size_t& first, const std::size_t& last) const
+{
+    // Fetch the simplified indices and padded drawing rects.
+    const auto indices(simplifiedIndices(points, first, std::min(last, points.size()), viewport));
+    const auto drawing_rects(paddedDrawingRects(drawing_rect_world_coord, viewport));
+
+    // Where the polyline currently being built starts in the buffer (and where it ends), and the previous projected point (if any).
+    std::size_t polyline_start(points_px.size());
+    QPointF polyline_end_px;
+    QPointF previous_point_px;
+    bool previous_projected(false);
+
+    // Helper to finish the polyline currently being built (single points are discarded).
+    const auto finish_polyline = [&points_px, &polyline_sizes, &polyline_start]()
+    {
+        if(points_px.size() - polyline_start > 1)
+        {
+            polyline_sizes.push_back(int(points_px.size() - polyline_start));
+        }
+        else
+        {
+            points_px.resize(polyline_start);
+        }
+        polyline_start = points_px.size();
+    };
+
+    // Loop through each segment.
+    for(std::size_t i = 1; i < indices->size(); ++i)
+    {
+        // Fetch the segment's points.
+        const util::PointWorldCoord start_point_coord(points[indices->at(i - 1)]);
+        const util::PointWorldCoord end_point_coord(points[indices->at(i)]);
+
+        // Skip the segment without projecting it if both points are outside the same side of the drawing rect.
+        if((util::algorithms::outcode(start_point_coord, drawing_rects.first) & util::algorithms::outcode(end_point_coord, drawing_rects.first)) != 0)
+        {
+            // Finish the current polyline.
+            finish_polyline();
+            previous_projected = false;
+            continue;
+        }
+
+        // Project the segment's points (re-using the previous end point).
+        QPointF start_point_px(previous_projected ? previous_point_px : QPointF(projection::toPointWorldPx(viewport, start_point_coord)));
+        QPointF end_point_px(projection::toPointWorldPx(viewport, end_point_coord));
+        previous_point_px = end_point_px;
+        previous_projected = true;
+
+        // Clip the segment to the padded drawing rect.
+        if(util::algorithms::clipLine(start_point_px, end_point_px, drawing_rects.second) == false)
+        {
+            // Finish the current polyline.
+            finish_polyline();
+            continue;
+        }
+
+        // Start a new polyline if the segment does not continue on from the current one.
+        if(points_px.size() == polyline_start || polyline_end_px != start_point_px)
+        {
+            // Finish the current polyline.
+            finish_polyline();
+            points_px.push_back(start_point_px);
+        }
+
+        // Add the end point, unless it lands on the same pixel as the previous point.
+        if(std::floor(points_px.back().x()) != std::floor(end_point_px.x()) || std::floor(points_px.back().y()) != std::floor(end_point_px.y()))
+        {
+            points_px.push_back(end_point_px);
+        }
+
+        // Track where the polyline ends (even if the end point was dropped).
+        polyline_end_px = end_point_px;
+    }
+
+    // Finish the last polyline.
+    finish_polyline();
+}
+
+const std::vector<QPointF>& GeometryFixed::clippedPolygonPx(const util::VertexBuffer& points, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport, const std::size_t& first, const std::size_t& last) const
+{
+    // Fetch the simplified indices and padded drawing rects.
+    const auto indices(simplifiedIndices(points, first, std::min(last, points.size()), viewport));
+    const auto drawing_rects(paddedDrawingRects(drawing_rect_world_coord, viewport));
+
+    // Fetch the scratch buffers of the drawing thread.
+    util::ScratchBuffers& scratch_buffers(util::ScratchBuffers::local());
+
+    // Calculate the outcodes of the points.
+    std::vector<int>& outcodes(scratch_buffers.outcodes(indices->size()));
+    for(const auto& index : *indices)
+    {
+        outcodes.push_back(util::algorithms::outcode(points[index], drawing_rects.first));
+    }
+
+    // Loop through each point to project.
+    std::vector<QPointF>& polygon_px(scratch_buffers.pointsPx(indices->size()));
+    bool clipping_required(false);
+    int previous_outcode(0);
+    for(std::size_t i = 0; i < indices->size(); ++i)
+    {
+        // Does the point lie outside the drawing rect?
+        if(outcodes[i] != 0)
+        {
+            // Clipping will be required.
+            clipping_required = true;
+
+            // Skip the point if it is outside the same side as the previous kept point and the next point (the edge between them
+            // then stays outside that side, so the clip is unchanged). The previous kept point is used, rather than the previous
+            // point, so that a run which turns a corner keeps the corner point.
+            if(i > 0 && i + 1 < indices->size() && (previous_outcode & outcodes[i] & outcodes[i + 1]) != 0)
+            {
+                continue;
+            }
+        }
+
+        // Project the point.
+        const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, points[indices->at(i)]));
+
+        // Add the point, unless it lands on the same pixel as the previous point.
+        if(polygon_px.empty() || std::floor(polygon_px.back().x()) != std::floor(point_px.x()) || std::floor(polygon_px.back().y()) != std::floor(point_px.y()))
+        {
+            polygon_px.push_back(point_px);
+            previous_outcode = outcodes[i];
+        }
+    }
+
+    // Clip the polygon to the padded drawing rect, if required.
+    if(clipping_required)
+    {
+        util::algorithms::clipPolygon(polygon_px, scratch_buffers.clipPx(polygon_px.size()), drawing_rects.second);
+    }
+
+    // Return the polygon.
+    return polygon_px;
+}
+
+QPainterPath GeometryFixed::touchesShape(const Geometry& geometry, const Viewport& viewport)
+{
+    // The shape to return.
+    QPainterPath return_shape;
+
+    // Calculate the degree distance of 1 px within viewport (used to calculate fuzz factor around lines).
+    const util::PointWorldPx point_center_px(projection::toPointWorldPx(viewport, util::PointWorldCoord(0.0, 0.0)));
+    const util::PointWorldPx point_fuzz_px(point_center_px.x() + 1.0, point_center_px.y() + 1.0);
+    const util::PointWorldCoord point_fuzz_coord(projection::toPointWorldCoord(viewport, point_fuzz_px));
+
+    // Create a stroker to turn lines into shapes (using the pen width as a fuzz factor).
+    QPainterPathStroker line_stroker;
+    line_stroker.setWidth(point_fuzz_coord.x() * geometry.pen().widthF());
+
+    // Switch to the correct geometry type.
+    switch(geometry.geometryType())
+    {
+        case GeometryType::GeometryEllipse:
+        {
+            // The shape is the ellipse within the bounding box.
+            return_shape.addEllipse(geometry.boundingBox(viewport));
+
+            // Finished.
+            break;
+        }
+        case GeometryType::GeometryLineString:
+        {
+            // Add the line.
+            const auto& points(static_cast<const GeometryLineString&>(geometry).points());
+            QPainterPath line;
+            for(const auto& point : points)
+            {
+                // Start the line at the first point, and join each point after it.
+                if(line.elementCount() == 0)
+                {
+                    line.moveTo(point);
+                }
+                else
+                {
+                    line.lineTo(point);
+                }
+            }
+
+            // The shape is the stroked line.
+            return_shape = line_stroker.createStroke(line);
+
+            // Finished.
+            break;
+        }
+        case GeometryType::GeometryMultiLineString:
+        {
+            // The shape is the stroked lines.
+            return_shape = line_stroker.createStroke(static_cast<const GeometryMultiLineString&>(geometry).toQPainterPath());
+
+            // Finished.
+            break;
+        }
+        case GeometryType::GeometryMultiPolygon:
+        {
+            // The shape is the polygons (with their holes).
+            return_shape = static_cast<const GeometryMultiPolygon&>(geometry).toQPainterPath();
+
+            // Finished.
+            break;
+        }
+        case GeometryType::GeometryPoint:
+        {
+            // The shape is the point's bounding box.
+            return_shape.addRect(geometry.boundingBox(viewport));
+
+            // Finished.
+            break;
+        }
+        case GeometryType::GeometryPolygon:
+        {
+            // The shape is the polygon.
+            return_shape.addPolygon(static_cast<const GeometryPolygon&>(geometry).toQPolygonF());
+            return_shape.closeSubpath();
+
+            // Finished.
+            break;
+        }
+    }
+
+    // Return the shape.
+    return return_shape;
+}
+
+std::shared_ptr<const std::vector<std::size_t>> GeometryFixed::simplifiedIndices(const util::VertexBuffer& points, const std::size_t& first, const std::size_t& last, const Viewport& viewport) const
+{
+    // Tolerance (in pixels) that a removed point can be from the simplified line.
+    const double tolerance_px(0.5);
+
+    // Lock the simplified indices.
+    QMutexLocker locker(&m_simplified_indices_mutex);
+
+    // Find the cached kept indices for this projection/zoom.
+    const std::pair<int, int> key(projection::epsgNumber(viewport), viewport.zoom());
+    auto itr_zoom(std::find_if(m_simplified_indices.begin(), m_simplified_indices.end(), [&key](const std::pair<std::pair<int, int>, std::map<std::size_t, std::shared_ptr<const std::vector<std::size_t>>>>& simplified_zoom) { return simplified_zoom.first == key; }));
+    if(itr_zoom == m_simplified_indices.end())
+    {
+        // Drop the least recently drawn projection/zoom if the cache is full.
+        if(m_simplified_indices.size() >= m_simplified_indices_zoom_capacity)
+        {
+            m_simplified_indices.pop_back();
+        }
+
+        // Add an empty entry for this projection/zoom (as the most recent).
+        itr_zoom = m_simplified_indices.emplace(m_simplified_indices.begin(), key, std::map<std::size_t, std::shared_ptr<const std::vector<std::size_t>>>());
+    }
+    else if(itr_zoom != m_simplified_indices.begin())
+    {
+        // Move this projection/zoom to the front (as the most recent).
+        std::rotate(m_simplified_indices.begin(), itr_zoom, itr_zoom + 1);
+        itr_zoom = m_simplified_indices.begin();
+    }
+
+    // Fetch the kept indices for this part, simplifying the points if this is the first draw.
+    auto& simplified_parts(itr_zoom->second);
+    auto itr_find(simplified_parts.find(first));
+    if(itr_find == simplified_parts.end())
+    {
+        // Project all of the part's points.
+        QPolygonF points_px;
+        points_px.reserve(int(last - first));
+        for(std::size_t i = first; i < last; ++i)
+        {
+            points_px.append(projection::toPointWorldPx(viewport, points[i]));
+        }
+
+        // Simplify the part (offsetting the kept indices by the part's first point).
+        std::vector<std::size_t> indices(util::algorithms::simplify(points_px, tolerance_px));
+        for(auto& index : indices)
+        {
+            index += first;
+        }
+
+        // Cache the kept indices.
+        itr_find = simplified_parts.emplace(first, std::make_shared<const std::vector<std::size_t>>(std::move(indices))).first;
+    }
+
+    // Return the kept indices.
+    return itr_find->second;
+}
+
+std::size_t GeometryFixed::simplifiedIndicesMemoryBytes() const
+{
+    // Gain a lock to protect the simplified indices.
+    QMutexLocker locker(&m_simplified_indices_mutex);
+
+    // Estimate each cached projection/zoom, and each cached part (the map node, the shared vector and its indices).
+    std::size_t return_bytes(m_simplified_indices.capacity() * sizeof(decltype(m_simplified_indices)::value_type));
+    for(const auto& simplified_zoom : m_simplified_indices)
+    {
+        for(const auto& simplified_indices : simplified_zoom.second)
+        {
+            return_bytes += sizeof(decltype(simplified_zoom.second)::value_type) + (4 * sizeof(void*)) + sizeof(std::vector<std::size_t>) + (simplified_indices.second->capacity() * sizeof(std::size_t));
+        }
+    }
+
+    // Return the estimated number of bytes.
+    return return_bytes;
+}
+
+std::pair<QRectF, QRectF> GeometryFixed::paddedDrawingRects(const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+{
+    // Pad by the pen width (plus a pixel for anti-aliasing) so that clipped edges are never visible.
+    const double padding_px(pen().widthF() + 1.0);
+
+    // Calculate the padded drawing rect in world pixels.
+    const QRectF drawing_rect_px(QRectF(projection::toPointWorldPx(viewport, drawing_rect_world_coord.topLeftCoord()), projection::toPointWorldPx(viewport, drawing_rect_world_coord.bottomRightCoord())).normalized().adjusted(-padding_px, -padding_px, padding_px, padding_px));
+
+    // Calculate the padded drawing rect in world coordinates.
+    const QRectF drawing_rect_coord(QRectF(projection::toPointWorldCoord(viewport, util::PointWorldPx(drawing_rect_px.left(), drawing_rect_px.top())), projection::toPointWorldCoord(viewport, util::PointWorldPx(drawing_rect_px.right(), drawing_rect_px.bottom()))).normalized());
+
+    // Return the padded drawing rects.
+    return std::make_pair(drawing_rect_coord, drawing_rect_px);
+}
@@ -18,8 +18,21 @@
 
 #pragma once
 
+// Qt includes.
+#include <QtCore/QMutex>
+#include <QtGui/QPainterPath>
+#include <QtGui/QPolygonF>
+
+// STL includes.
+#include <limits>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
 // Local includes.
 #include "../../qwidgetmap_global.h"
+#include "../../util/VertexBuffer.h"
 #include "Geometry.h"
 
 /// QWidgetMap namespace.
@@ -68,6 +81,87 @@ namespace qwm
                  */
                 virtual const util::RectWorldCoord& boundingBoxFixed() const = 0;
 
+            protected:
+
+                /**
+                 * Projects the points into world pixels as polylines, simplified for the viewport's zoom and clipped to the drawing rect.
+                 * Runs of segments that lie entirely outside one side of the drawing rect are discarded before they are projected,
+                 * and the remaining segments are clipped (Liang-Barsky) to the drawing rect padded by the pen width.
+                 * The polylines are appended to flat buffers (drawn with the pointer/count QPainter overloads), so they can be
+                 * reused across geometries without allocating each polyline.
+                 * @param points The points to project (must be the same points each call).
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The viewport to project the points for.
+                 * @param points_px The buffer to append the points of the visible parts of the line to (world pixels).
+                 * @param polyline_sizes The buffer to append the number of points in each visible part of the line to.
+                 * @param first The index of the first point of the part to project (for multi-part geometries).
+                 * @param last The index after the last point of the part to project (defaults to the end of the points).
+                 */
+                void appendClippedPolylinesPx(const util::VertexBuffer& points, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport, std::vector<QPointF>& points_px, std::vector<int>& polyline_sizes, const std::size_t& first = 0, const std::size_t& last = std::numeric_limits<std::size_t>::max()) const;
+
+                /**
+                 * Projects the points into a world pixel polygon, simplified for the viewport's zoom and clipped to the drawing rect.
+                 * Runs of points that lie outside one side of the drawing rect are collapsed to their end points (and the corner points
+                 * where a run turns to another side) before they are projected, and the polygon is clipped (Sutherland-Hodgman) to the
+                 * drawing rect padded by the pen width.
+                 * @param points The points to project (must be the same points each call).
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The viewport to project the points for.
+                 * @param first The index of the first point of the ring to project (for multi-part geometries).
+                 * @param last The index after the last point of the ring to project (defaults to the end of the points).
+                 * @return the visible polygon in world pixels, held in the drawing thread's scratch buffers (valid until the next polygon is projected).
+                 */
+                const std::vector<QPointF>& clippedPolygonPx(const util::VertexBuffer& points, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport, const std::size_t& first = 0, const std::size_t& last = std::numeric_limits<std::size_t>::max()) const;
+
+                /**
+                 * Creates the shape (world coordinates) of a geometry, as used to check whether multi-part geometries touch.
+                 * Lines are stroked by their pen width (as a fuzz factor), while polygons/ellipses/points are filled.
+                 * @param geometry The geometry to create the shape of.
+                 * @param viewport The viewport to use.
+                 * @return the shape of the geometry.
+                 */
+                static QPainterPath touchesShape(const Geometry& geometry, const Viewport& viewport);
+
+                /**
+                 * Estimates the number of bytes used by the cached simplified indices.
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t simplifiedIndicesMemoryBytes() const;
+
+            private:
+
+                /**
+                 * Fetches the indices of the points kept after simplification for the viewport's zoom.
+                 * The points are simplified (Douglas-Peucker) the first time each zoom is drawn and the kept indices are cached.
+                 * Only the most recently drawn projection/zoom levels are cached, so the cache does not grow as the map is zoomed.
+                 * @param points The points to simplify (must be the same points each call).
+                 * @param first The index of the first point of the part to simplify.
+                 * @param last The index after the last point of the part to simplify.
+                 * @param viewport The viewport to simplify the points for.
+                 * @return the indices of the kept points.
+                 */
+                std::shared_ptr<const std::vector<std::size_t>> simplifiedIndices(const util::VertexBuffer& points, const std::size_t& first, const std::size_t& last, const Viewport& viewport) const;
+
+                /**
+                 * Calculates the drawing rect padded by the pen width.
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The viewport to use.
+                 * @return the padded drawing rect in world coordinates and world pixels (both normalized).
+                 */
+                std::pair<QRectF, QRectF> paddedDrawingRects(const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const;
+
+            private:
+
+                /// The maximum number of projection/zoom levels to cache the simplified indices for.
+                static const std::size_t m_simplified_indices_zoom_capacity = 2;
+
+                /// The indices of the points kept after simplification for the most recently drawn projection (epsg number)/zoom levels
+                /// (most recent first), keyed by the part's first point.
+                mutable std::vector<std::pair<std::pair<int, int>, std::map<std::size_t, std::shared_ptr<const std::vector<std::size_t>>>>> m_simplified_indices;
+
+                /// Mutex to protect the simplified indices.
+                mutable QMutex m_simplified_indices_mutex;
+
             };
 
         }
@@ -26,6 +26,7 @@
 #include "GeometryEllipse.h"
 #include "GeometryPolygon.h"
 #include "../../projection/Projection.h"
+#include "../../util/ScratchBuffers.h"
 
 using namespace qwm;
 using namespace qwm::draw::geometry;
@@ -34,19 +35,11 @@ GeometryLineString::GeometryLineString(const std::vector<util::PointWorldCoord>&
     : GeometryFixed(GeometryType::GeometryLineString, parent),
       m_points(points)
 {
-    // Loop through each point to add to the polygon.
-    QPolygonF polygon_line;
-    for(const auto& point : m_points)
-    {
-        // Add the point to be drawn.
-        polygon_line.append(point);
-    }
-
     // Set the fixed bounding box.
-    m_bounding_box_fixed = util::RectWorldCoord::fromQRectF(polygon_line.boundingRect());
+    m_bounding_box_fixed = util::RectWorldCoord::fromQRectF(m_points.boundingRect());
 }
 
-std::vector<util::PointWorldCoord> GeometryLineString::points() const
+const util::VertexBuffer& GeometryLineString::points() const
 {
     // Return the points.
     return m_points;
@@ -72,8 +65,14 @@ bool GeometryLineString::touches(const Geometry& geometry, const Viewport& viewp
     // Check we are visible.
     if(isVisible(viewport))
     {
+        // Is the other geometry multi-part?
+        if(geometry.geometryType() == GeometryType::GeometryMultiLineString || geometry.geometryType() == GeometryType::GeometryMultiPolygon)
+        {
+            // Set touches response based on multi-part vs line string check (which checks every part-line at once).
+            return_touches = geometry.touches(*this, viewport);
+        }
         // Check we have at least 2 points!
-        if(m_points.size() > 1)
+        else if(m_points.size() > 1)
         {
             // Calculate the degree distance of 1 px within viewport (used to calculate fuzz factor around lines).
             const util::PointWorldPx point_center_px(projection::toPointWorldPx(viewport, util::PointWorldCoord(0.0, 0.0)));
@@ -131,6 +130,14 @@ bool GeometryLineString::touches(const Geometry& geometry, const Viewport& viewp
                         // Finished.
                         break;
                     }
+                    case GeometryType::GeometryMultiLineString:
+                    case GeometryType::GeometryMultiPolygon:
+                    {
+                        // Multi-part geometries are checked before the part-lines are looped through.
+
+                        // Finished.
+                        break;
+                    }
                     case GeometryType::GeometryPoint:
                     {
                         // They have touched if the shapes intersect.
@@ -164,21 +171,34 @@ bool GeometryLineString::touches(const Geometry& geometry, const Viewport& viewp
     return return_touches;
 }
 
-void GeometryLineString::draw(QPainter& painter, const util::RectWorldCoord& /*drawing_rect_world_coord*/, const Viewport& viewport) const
+void GeometryLineString::appendPolylinesPx(const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport, std::vector<QPointF>& points_px, std::vector<int>& polyline_sizes) const
 {
-    // Create a polygon of the points.
-    QPolygonF polygon_line_px;
+    // Append polygon lines of the visible points, simplified for the current zoom.
+    appendClippedPolylinesPx(m_points, drawing_rect_world_coord, viewport, points_px, polyline_sizes);
+}
 
-    // Loop through each point to add to the polygon.
-    for(const auto& point : m_points)
-    {
-        // Add the point to be drawn.
-        polygon_line_px.append(projection::toPointWorldPx(viewport, point));
-    }
+void GeometryLineString::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+{
+    // Create polygon lines of the visible points, simplified for the current zoom (in the drawing thread's scratch buffers).
+    util::ScratchBuffers& scratch_buffers(util::ScratchBuffers::local());
+    std::vector<QPointF>& points_px(scratch_buffers.pointsPx());
+    std::vector<int>& polyline_sizes(scratch_buffers.polylineSizes());
+    appendPolylinesPx(drawing_rect_world_coord, viewport, points_px, polyline_sizes);
 
     // Set the pen to use.
     painter.setPen(pen());
 
-    // Draw the polygon line.
-    painter.drawPolyline(polygon_line_px);
+    // Draw the polygon lines.
+    const QPointF* polyline_px(points_px.data());
+    for(const auto& polyline_size : polyline_sizes)
+    {
+        painter.drawPolyline(polyline_px, polyline_size);
+        polyline_px += polyline_size;
+    }
+}
+
+std::size_t GeometryLineString::memoryBytes() const
+{
+    // Return the size of the object, its vertices and its cached simplifications.
+    return sizeof(GeometryLineString) + m_points.memoryBytes() + simplifiedIndicesMemoryBytes();
 }
@@ -23,6 +23,7 @@
 
 // Local includes.
 #include "../../qwidgetmap_global.h"
+#include "../../util/VertexBuffer.h"
 #include "GeometryFixed.h"
 
 /// QWidgetMap namespace.
@@ -68,7 +69,7 @@ namespace qwm
                  * Fetches the list of points that form a line.
                  * @return the list of points that form a line.
                  */
-                std::vector<util::PointWorldCoord> points() const;
+                const util::VertexBuffer& points() const;
 
             public:
 
@@ -95,6 +96,16 @@ namespace qwm
                  */
                 bool touches(const Geometry& geometry, const Viewport& viewport) const final;
 
+                /**
+                 * Appends the polylines to draw, clipped to the drawing rect and simplified for the current zoom.
+                 * This allows line strings that share a pen to be drawn together.
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The current viewport to use.
+                 * @param points_px The buffer to append the points of the polylines to (world pixels).
+                 * @param polyline_sizes The buffer to append the number of points in each polyline to.
+                 */
+                void appendPolylinesPx(const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport, std::vector<QPointF>& points_px, std::vector<int>& polyline_sizes) const;
+
                 /**
                  * Draws the item to the provided painter.
                  * @param painter The painter to draw on.
@@ -103,10 +114,16 @@ namespace qwm
                  */
                 void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
 
+                /**
+                 * Estimates the number of bytes used by the line string (the object, its vertices and its cached simplifications).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
             private:
 
                 /// The points that the linestring is made up of.
-                std::vector<util::PointWorldCoord> m_points;
+                util::VertexBuffer m_points;
 
                 /// The fixed bounding box (calcualted on construction).
                 util::RectWorldCoord m_bounding_box_fixed { util::PointWorldCoord { 0.0, 0.0 }, util::PointWorldCoord { 0.0, 0.0 } };
@@ -0,0 +1,173 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "GeometryMultiLineString.h"
+
+// Local includes.
+#include "../../util/ScratchBuffers.h"
+
+using namespace qwm;
+using namespace qwm::draw::geometry;
+
+GeometryMultiLineString::GeometryMultiLineString(const std::vector<std::vector<util::PointWorldCoord>>& parts, QObject* parent)
+    : GeometryFixed(GeometryType::GeometryMultiLineString, parent)
+{
+    // Count the points, so the buffer is only allocated once.
+    std::size_t point_count(0);
+    for(const auto& part : parts)
+    {
+        point_count += part.size();
+    }
+
+    // Loop through each part to add it to the buffer.
+    std::vector<util::PointWorldCoord> points;
+    points.reserve(point_count);
+    m_part_offsets.reserve(parts.size() + 1);
+    for(const auto& part : parts)
+    {
+        // Add the part's offset and points.
+        m_part_offsets.push_back(points.size());
+        points.insert(points.end(), part.begin(), part.end());
+    }
+
+    // Add the final offset (the number of points).
+    m_part_offsets.push_back(points.size());
+
+    // Store the points.
+    m_points = util::VertexBuffer(points);
+
+    // Calculate the bounding box.
+    m_bounding_box_fixed = util::RectWorldCoord::fromQRectF(m_points.boundingRect());
+}
+
+std::size_t GeometryMultiLineString::partCount() const
+{
+    // Return the number of parts.
+    return m_part_offsets.size() - 1;
+}
+
+std::vector<util::PointWorldCoord> GeometryMultiLineString::part(const std::size_t& part_index) const
+{
+    // Return the part's points.
+    return m_points.toStdVector(m_part_offsets.at(part_index), m_part_offsets.at(part_index + 1));
+}
+
+const util::VertexBuffer& GeometryMultiLineString::points() const
+{
+    // Return the points.
+    return m_points;
+}
+
+const std::vector<std::size_t>& GeometryMultiLineString::partOffsets() const
+{
+    // Return the part offsets.
+    return m_part_offsets;
+}
+
+QPainterPath GeometryMultiLineString::toQPainterPath() const
+{
+    // Loop through each part to add it as a sub-path.
+    QPainterPath return_path;
+    for(std::size_t i = 0; i + 1 < m_part_offsets.size(); ++i)
+    {
+        // Loop through each point of the part.
+        for(std::size_t p = m_part_offsets[i]; p < m_part_offsets[i + 1]; ++p)
+        {
+            // Start the sub-path at the part's first point, and join each point after it.
+            if(p == m_part_offsets[i])
+            {
+                return_path.moveTo(m_points[p]);
+            }
+            else
+            {
+                return_path.lineTo(m_points[p]);
+            }
+        }
+    }
+
+    // Return the QPainterPath.
+    return return_path;
+}
+
+const util::RectWorldCoord& GeometryMultiLineString::boundingBoxFixed() const
+{
+    // Return the fixed bounding box.
+    return m_bounding_box_fixed;
+}
+
+util::RectWorldCoord GeometryMultiLineString::boundingBox(const Viewport& /*viewport*/) const
+{
+    // Return the fixed bounding box.
+    return boundingBoxFixed();
+}
+
+bool GeometryMultiLineString::touches(const Geometry& geometry, const Viewport& viewport) const
+{
+    // Default return success.
+    bool return_touches(false);
+
+    // Check we are visible.
+    if(isVisible(viewport))
+    {
+        // They have touched if the shapes intersect (our lines are stroked by the pen width as a fuzz factor).
+        return_touches = touchesShape(*this, viewport).intersects(touchesShape(geometry, viewport));
+    }
+
+    // Return our success.
+    return return_touches;
+}
+
+void GeometryMultiLineString::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+{
+    // Create polygon lines of the visible points of each part, simplified for the current zoom (in the drawing thread's scratch buffers).
+    util::ScratchBuffers& scratch_buffers(util::ScratchBuffers::local());
+    std::vector<QPointF>& points_px(scratch_buffers.pointsPx());
+    std::vector<int>& polyline_sizes(scratch_buffers.polylineSizes());
+    for(std::size_t i = 0; i + 1 < m_part_offsets.size(); ++i)
+    {
+        appendClippedPolylinesPx(m_points, drawing_rect_world_coord, viewport, points_px, polyline_sizes, m_part_offsets[i], m_part_offsets[i + 1]);
+    }
+
+    // Loop through each visible polygon line to add it to the path as a sub-path.
+    QPainterPath path_px;
+    const QPointF* polyline_px(points_px.data());
+    for(const auto& polyline_size : polyline_sizes)
+    {
+        path_px.moveTo(polyline_px[0]);
+        for(int p = 1; p < polyline_size; ++p)
+        {
+            path_px.lineTo(polyline_px[p]);
+        }
+        polyline_px += polyline_size;
+    }
+
+    // Set the pen to use.
+    painter.setPen(pen());
+
+    // Set the brush to use (lines are never filled).
+    painter.setBrush(Qt::NoBrush);
+
+    // Draw the path.
+    painter.drawPath(path_px);
+}
+
+std::size_t GeometryMultiLineString::memoryBytes() const
+{
+    // Return the size of the object, its vertices, part offsets and cached simplifications.
+    return sizeof(GeometryMultiLineString) + m_points.memoryBytes() + (m_part_offsets.capacity() * sizeof(std::size_t)) + simplifiedIndicesMemoryBytes();
+}
@@ -0,0 +1,160 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt includes.
+#include <QtGui/QPainterPath>
+
+// STL includes.
+#include <cstddef>
+#include <vector>
+
+// Local includes.
+#include "../../qwidgetmap_global.h"
+#include "../../util/VertexBuffer.h"
+#include "GeometryFixed.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Drawable namespace.
+    namespace draw
+    {
+
+        /// Geometry namespace.
+        namespace geometry
+        {
+
+            /**
+             * Implementation of the drawable multi-part line string geometry item.
+             * The points of every part are stored in one contiguous buffer, with the offset of each part's first point.
+             */
+            class QWIDGETMAP_EXPORT GeometryMultiLineString : public GeometryFixed
+            {
+                Q_OBJECT
+
+            public:
+
+                /**
+                 * This constructor takes a list of parts (each a list of points that form a line) to be displayed.
+                 * @param parts The list of parts (world coordinates).
+                 * @param parent QObject parent ownership.
+                 */
+                explicit GeometryMultiLineString(const std::vector<std::vector<util::PointWorldCoord>>& parts, QObject* parent = nullptr);
+
+                /// Disable copy constructor.
+                GeometryMultiLineString(const GeometryMultiLineString&) = delete;
+
+                /// Disable copy assignment.
+                GeometryMultiLineString& operator=(const GeometryMultiLineString&) = delete;
+
+                /// Destructor.
+                ~GeometryMultiLineString() = default;
+
+            public:
+
+                /**
+                 * Fetches the number of parts.
+                 * @return the number of parts.
+                 */
+                std::size_t partCount() const;
+
+                /**
+                 * Fetches the list of points that form a part.
+                 * @param part_index The index of the part.
+                 * @return the list of points that form the part (world coordinates).
+                 */
+                std::vector<util::PointWorldCoord> part(const std::size_t& part_index) const;
+
+                /**
+                 * Fetches the points of every part (world coordinates), in one contiguous buffer.
+                 * @return the points of every part.
+                 */
+                const util::VertexBuffer& points() const;
+
+                /**
+                 * Fetches the offset of each part's first point in the points, followed by the number of points.
+                 * @return the part offsets.
+                 */
+                const std::vector<std::size_t>& partOffsets() const;
+
+                /**
+                 * Fetches the QPainterPath representation of the line strings (each part is a separate sub-path, created from the points each call).
+                 * @return the QPainterPath representation of the line strings (world coordinates).
+                 */
+                QPainterPath toQPainterPath() const;
+
+            public:
+
+                /**
+                 * Fetches the fixed bounding box (world coordinates).
+                 * @return the fixed bounding box.
+                 */
+                const util::RectWorldCoord& boundingBoxFixed() const final;
+
+            public:
+
+                /**
+                 * Fetches the bounding box (world coordinates).
+                 * @param viewport The current viewport to use.
+                 * @return the bounding box.
+                 */
+                util::RectWorldCoord boundingBox(const Viewport& viewport) const final;
+
+                /**
+                 * Checks if the geometry touches (intersects) with another geometry.
+                 * @param geometry The geometry to check against.
+                 * @param viewport The current viewport to use.
+                 * @return whether the geometries touch (intersects).
+                 */
+                bool touches(const Geometry& geometry, const Viewport& viewport) const final;
+
+                /**
+                 * Draws the item to the provided painter.
+                 * @param painter The painter to draw on.
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The current viewport to use.
+                 */
+                void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
+
+                /**
+                 * Estimates the number of bytes used by the multi line string (the object, its vertices, part offsets and cached simplifications).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
+            private:
+
+                /// The points that the parts are made up of.
+                util::VertexBuffer m_points;
+
+                /// The offset of each part's first point in the points (followed by the number of points).
+                std::vector<std::size_t> m_part_offsets;
+
+                /// The fixed bounding box (calculated on construction).
+                util::RectWorldCoord m_bounding_box_fixed { util::PointWorldCoord { 0.0, 0.0 }, util::PointWorldCoord { 0.0, 0.0 } };
+
+            };
+
+        }
+
+    }
+
+}
@@ -0,0 +1,185 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "GeometryMultiPolygon.h"
+
+using namespace qwm;
+using namespace qwm::draw::geometry;
+
+GeometryMultiPolygon::GeometryMultiPolygon(const std::vector<std::vector<std::vector<util::PointWorldCoord>>>& polygons, QObject* parent)
+    : GeometryFixed(GeometryType::GeometryMultiPolygon, parent)
+{
+    // Count the rings and points, so the buffers are only allocated once.
+    std::size_t ring_count(0);
+    std::size_t point_count(0);
+    for(const auto& polygon : polygons)
+    {
+        ring_count += polygon.size();
+        for(const auto& ring : polygon)
+        {
+            point_count += ring.size();
+        }
+    }
+
+    // Loop through each polygon to add its rings to the buffer.
+    std::vector<util::PointWorldCoord> points;
+    points.reserve(point_count);
+    m_ring_offsets.reserve(ring_count + 1);
+    m_polygon_offsets.reserve(polygons.size() + 1);
+    for(const auto& polygon : polygons)
+    {
+        // Add the polygon's offset.
+        m_polygon_offsets.push_back(m_ring_offsets.size());
+
+        // Loop through each ring to add its offset and points.
+        for(const auto& ring : polygon)
+        {
+            m_ring_offsets.push_back(points.size());
+            points.insert(points.end(), ring.begin(), ring.end());
+        }
+    }
+
+    // Add the final offsets (the number of points/rings).
+    m_ring_offsets.push_back(points.size());
+    m_polygon_offsets.push_back(m_ring_offsets.size() - 1);
+
+    // Store the points.
+    m_points = util::VertexBuffer(points);
+
+    // Calculate the bounding box.
+    m_bounding_box_fixed = util::RectWorldCoord::fromQRectF(m_points.boundingRect());
+}
+
+std::size_t GeometryMultiPolygon::polygonCount() const
+{
+    // Return the number of polygons.
+    return m_polygon_offsets.size() - 1;
+}
+
+std::size_t GeometryMultiPolygon::ringCount() const
+{
+    // Return the number of rings.
+    return m_ring_offsets.size() - 1;
+}
+
+std::vector<util::PointWorldCoord> GeometryMultiPolygon::ring(const std::size_t& ring_index) const
+{
+    // Return the ring's points.
+    return m_points.toStdVector(m_ring_offsets.at(ring_index), m_ring_offsets.at(ring_index + 1));
+}
+
+const util::VertexBuffer& GeometryMultiPolygon::points() const
+{
+    // Return the points.
+    return m_points;
+}
+
+const std::vector<std::size_t>& GeometryMultiPolygon::ringOffsets() const
+{
+    // Return the ring offsets.
+    return m_ring_offsets;
+}
+
+const std::vector<std::size_t>& GeometryMultiPolygon::polygonOffsets() const
+{
+    // Return the polygon offsets.
+    return m_polygon_offsets;
+}
+
+QPainterPath GeometryMultiPolygon::toQPainterPath() const
+{
+    // Holes are not filled (each hole is contained within an odd number of rings).
+    QPainterPath return_path;
+    return_path.setFillRule(Qt::OddEvenFill);
+
+    // Loop through each ring to add it as a closed sub-path.
+    for(std::size_t i = 0; i + 1 < m_ring_offsets.size(); ++i)
+    {
+        return_path.addPolygon(m_points.toQPolygonF(m_ring_offsets[i], m_ring_offsets[i + 1]));
+        return_path.closeSubpath();
+    }
+
+    // Return the QPainterPath.
+    return return_path;
+}
+
+const util::RectWorldCoord& GeometryMultiPolygon::boundingBoxFixed() const
+{
+    // Return the fixed bounding box.
+    return m_bounding_box_fixed;
+}
+
+util::RectWorldCoord GeometryMultiPolygon::boundingBox(const Viewport& /*viewport*/) const
+{
+    // Return the fixed bounding box.
+    return boundingBoxFixed();
+}
+
+bool GeometryMultiPolygon::touches(const Geometry& geometry, const Viewport& viewport) const
+{
+    // Default return success.
+    bool return_touches(false);
+
+    // Check we are visible.
+    if(isVisible(viewport))
+    {
+        // They have touched if the shapes intersect (a geometry that is entirely within a hole does not touch).
+        return_touches = toQPainterPath().intersects(touchesShape(geometry, viewport));
+    }
+
+    // Return our success.
+    return return_touches;
+}
+
+void GeometryMultiPolygon::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+{
+    // Holes are not filled (each hole is contained within an odd number of rings).
+    QPainterPath path_px;
+    path_px.setFillRule(Qt::OddEvenFill);
+
+    // Loop through each ring to add its visible polygon (simplified for the current zoom) to the path.
+    for(std::size_t i = 0; i + 1 < m_ring_offsets.size(); ++i)
+    {
+        // Add the ring as a closed sub-path (the ring is held in the drawing thread's scratch buffers).
+        const std::vector<QPointF>& ring_px(clippedPolygonPx(m_points, drawing_rect_world_coord, viewport, m_ring_offsets[i], m_ring_offsets[i + 1]));
+        if(ring_px.empty() == false)
+        {
+            path_px.moveTo(ring_px.front());
+            for(std::size_t p = 1; p < ring_px.size(); ++p)
+            {
+                path_px.lineTo(ring_px[p]);
+            }
+            path_px.closeSubpath();
+        }
+    }
+
+    // Set the pen to use.
+    painter.setPen(pen());
+
+    // Set the brush to use.
+    painter.setBrush(brush());
+
+    // Draw the path.
+    painter.drawPath(path_px);
+}
+
+std::size_t GeometryMultiPolygon::memoryBytes() const
+{
+    // Return the size of the object, its vertices, ring/polygon offsets and cached simplifications.
+    return sizeof(GeometryMultiPolygon) + m_points.memoryBytes() + ((m_ring_offsets.capacity() + m_polygon_offsets.capacity()) * sizeof(std::size_t)) + simplifiedIndicesMemoryBytes();
+}
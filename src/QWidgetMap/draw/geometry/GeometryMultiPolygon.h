@@ -0,0 +1,177 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt includes.
+#include <QtGui/QPainterPath>
+
+// STL includes.
+#include <cstddef>
+#include <vector>
+
+// Local includes.
+#include "../../qwidgetmap_global.h"
+#include "../../util/VertexBuffer.h"
+#include "GeometryFixed.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Drawable namespace.
+    namespace draw
+    {
+
+        /// Geometry namespace.
+        namespace geometry
+        {
+
+            /**
+             * Implementation of the drawable multi-part polygon geometry item, where each polygon can have holes.
+             * The points of every ring are stored in one contiguous buffer, with the offset of each ring's first point and the
+             * offset of each polygon's first ring (a polygon's first ring is its exterior, and any further rings are its holes).
+             */
+            class QWIDGETMAP_EXPORT GeometryMultiPolygon : public GeometryFixed
+            {
+                Q_OBJECT
+
+            public:
+
+                /**
+                 * This constructor takes a list of polygons to be displayed.
+                 * Each polygon is a list of rings (each a list of points), the first being the exterior and any further rings its holes.
+                 * @param polygons The list of polygons (world coordinates).
+                 * @param parent QObject parent ownership.
+                 */
+                explicit GeometryMultiPolygon(const std::vector<std::vector<std::vector<util::PointWorldCoord>>>& polygons, QObject* parent = nullptr);
+
+                /// Disable copy constructor.
+                GeometryMultiPolygon(const GeometryMultiPolygon&) = delete;
+
+                /// Disable copy assignment.
+                GeometryMultiPolygon& operator=(const GeometryMultiPolygon&) = delete;
+
+                /// Destructor.
+                ~GeometryMultiPolygon() = default;
+
+            public:
+
+                /**
+                 * Fetches the number of polygons.
+                 * @return the number of polygons.
+                 */
+                std::size_t polygonCount() const;
+
+                /**
+                 * Fetches the number of rings (across all polygons).
+                 * @return the number of rings.
+                 */
+                std::size_t ringCount() const;
+
+                /**
+                 * Fetches the list of points that form a ring.
+                 * @param ring_index The index of the ring (across all polygons).
+                 * @return the list of points that form the ring (world coordinates).
+                 */
+                std::vector<util::PointWorldCoord> ring(const std::size_t& ring_index) const;
+
+                /**
+                 * Fetches the points of every ring (world coordinates), in one contiguous buffer.
+                 * @return the points of every ring.
+                 */
+                const util::VertexBuffer& points() const;
+
+                /**
+                 * Fetches the offset of each ring's first point in the points, followed by the number of points.
+                 * @return the ring offsets.
+                 */
+                const std::vector<std::size_t>& ringOffsets() const;
+
+                /**
+                 * Fetches the offset of each polygon's first ring in the rings, followed by the number of rings.
+                 * @return the polygon offsets.
+                 */
+                const std::vector<std::size_t>& polygonOffsets() const;
+
+                /**
+                 * Fetches the QPainterPath representation of the polygons (odd-even filled so that the holes are not filled, created from the points each call).
+                 * @return the QPainterPath representation of the polygons (world coordinates).
+                 */
+                QPainterPath toQPainterPath() const;
+
+            public:
+
+                /**
+                 * Fetches the fixed bounding box (world coordinates).
+                 * @return the fixed bounding box.
+                 */
+                const util::RectWorldCoord& boundingBoxFixed() const final;
+
+            public:
+
+                /**
+                 * Fetches the bounding box (world coordinates).
+                 * @param viewport The current viewport to use.
+                 * @return the bounding box.
+                 */
+                util::RectWorldCoord boundingBox(const Viewport& viewport) const final;
+
+                /**
+                 * Checks if the geometry touches (intersects) with another geometry.
+                 * @param geometry The geometry to check against.
+                 * @param viewport The current viewport to use.
+                 * @return whether the geometries touch (intersects).
+                 */
+                bool touches(const Geometry& geometry, const Viewport& viewport) const final;
+
+                /**
+                 * Draws the item to the provided painter.
+                 * @param painter The painter to draw on.
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The current viewport to use.
+                 */
+                void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
+
+                /**
+                 * Estimates the number of bytes used by the multi polygon (the object, its vertices, ring/polygon offsets and cached simplifications).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
+            private:
+
+                /// The points that the rings are made up of.
+                util::VertexBuffer m_points;
+
+                /// The offset of each ring's first point in the points (followed by the number of points).
+                std::vector<std::size_t> m_ring_offsets;
+
+                /// The offset of each polygon's first ring in the rings (followed by the number of rings).
+                std::vector<std::size_t> m_polygon_offsets;
+
+                /// The fixed bounding box (calculated on construction).
+                util::RectWorldCoord m_bounding_box_fixed { util::PointWorldCoord { 0.0, 0.0 }, util::PointWorldCoord { 0.0, 0.0 } };
+
+            };
+
+        }
+
+    }
+
+}
@@ -32,16 +32,53 @@ GeometryPoint::GeometryPoint(const util::PointWorldCoord& point_coord, QObject*
 
 }
 
-const util::PointWorldCoord& GeometryPoint::coord() const
+util::PointWorldCoord GeometryPoint::coord() const
 {
+    // Gain a lock to protect the point.
+    QMutexLocker locker(&m_point_coord_mutex);
+
     // Return the point to be displayed.
     return m_point_coord;
 }
 
+void GeometryPoint::setCoord(const util::PointWorldCoord& point_coord)
+{
+    // Set the point, and keep track of the previous point.
+    util::PointWorldCoord previous_point_coord(point_coord);
+    if(exchangeCoord(point_coord, previous_point_coord))
+    {
+        // Emit that the point has changed (allows the layer to relocate the point).
+        emit coordChanged(previous_point_coord);
+
+        // Emit that we need to redraw to display this change.
+        emit requestRedraw();
+    }
+}
+
+bool GeometryPoint::exchangeCoord(const util::PointWorldCoord& point_coord, util::PointWorldCoord& previous_point_coord)
+{
+    // Gain a lock to protect the point.
+    QMutexLocker locker(&m_point_coord_mutex);
+
+    // Keep track of the previous point.
+    previous_point_coord = m_point_coord;
+
+    // Only update the point if it has changed.
+    const bool changed(m_point_coord != point_coord);
+    if(changed)
+    {
+        // Set the point to be displayed.
+        m_point_coord = point_coord;
+    }
+
+    // Return whether the point has changed.
+    return changed;
+}
+
 util::RectWorldCoord GeometryPoint::boundingBox(const Viewport& viewport) const
 {
     // Calculate the world point in pixels.
-    const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, m_point_coord));
+    const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, coord()));
 
     // To ensure a point exists, give it a 1x1 size.
     const QSizeF object_size_px(1.0, 1.0);
@@ -83,6 +120,22 @@ bool GeometryPoint::touches(const Geometry& geometry, const Viewport& viewport)
                 // Finished.
                 break;
             }
+            case GeometryType::GeometryMultiLineString:
+            {
+                // Set touches response based on multi line string vs point check.
+                return_touches = geometry.touches(*this, viewport);
+
+                // Finished.
+                break;
+            }
+            case GeometryType::GeometryMultiPolygon:
+            {
+                // Set touches response based on multi polygon vs point check.
+                return_touches = geometry.touches(*this, viewport);
+
+                // Finished.
+                break;
+            }
             case GeometryType::GeometryPoint:
             {
                 // They have touched if the bounding boxes intersect.
@@ -109,7 +162,7 @@ bool GeometryPoint::touches(const Geometry& geometry, const Viewport& viewport)
 void GeometryPoint::draw(QPainter& painter, const util::RectWorldCoord& /*drawing_rect_world_coord*/, const Viewport& viewport) const
 {
     // Calculate the point in pixels.
-    const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, m_point_coord));
+    const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, coord()));
 
     // Set the pen to use.
     painter.setPen(pen());
@@ -117,3 +170,9 @@ void GeometryPoint::draw(QPainter& painter, const util::RectWorldCoord& /*drawin
     // Draw the point.
     painter.drawPoint(point_px);
 }
+
+std::size_t GeometryPoint::memoryBytes() const
+{
+    // Return the size of the object.
+    return sizeof(GeometryPoint);
+}
@@ -18,6 +18,9 @@
 
 #pragma once
 
+// Qt includes.
+#include <QtCore/QMutex>
+
 // Local includes.
 #include "../../qwidgetmap_global.h"
 #include "Geometry.h"
@@ -65,7 +68,24 @@ namespace qwm
                  * Fetches the point to be displayed (world coordinates).
                  * @return the point to be displayed (world coordinates).
                  */
-                const util::PointWorldCoord& coord() const;
+                util::PointWorldCoord coord() const;
+
+                /**
+                 * Set the point to be displayed (world coordinates).
+                 * The owning layer is notified so that it can relocate the point within its spatial index.
+                 * A point moved outside of the world bounds is removed from the owning layer.
+                 * @param point_coord The point to be displayed (world coordinates).
+                 */
+                void setCoord(const util::PointWorldCoord& point_coord);
+
+                /**
+                 * Set the point to be displayed (world coordinates), without emitting any signals.
+                 * This is used by a layer that relocates the point within its spatial index itself.
+                 * @param point_coord The point to be displayed (world coordinates).
+                 * @param previous_point_coord Set to the previous point that was displayed (world coordinates).
+                 * @return whether the point has changed.
+                 */
+                bool exchangeCoord(const util::PointWorldCoord& point_coord, util::PointWorldCoord& previous_point_coord);
 
             public:
 
@@ -92,10 +112,27 @@ namespace qwm
                  */
                 void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const override;
 
+                /**
+                 * Estimates the number of bytes used by the point (the object).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const override;
+
+            signals:
+
+                /**
+                 * Signal emitted when the point to be displayed has changed.
+                 * @param previous_point_coord The previous point that was displayed (world coordinates).
+                 */
+                void coordChanged(const util::PointWorldCoord& previous_point_coord) const;
+
             private:
 
                 /// The point to be displayed (world coordinates).
-                const util::PointWorldCoord m_point_coord;
+                util::PointWorldCoord m_point_coord;
+
+                /// Mutex to protect the point to be displayed.
+                mutable QMutex m_point_coord_mutex;
 
             };
 
@@ -18,44 +18,32 @@
 
 #include "GeometryPointArrow.h"
 
+// Local includes.
+#include "../../util/SpriteAtlas.h"
+
 using namespace qwm;
 using namespace qwm::draw::geometry;
 
 GeometryPointArrow::GeometryPointArrow(const util::PointWorldCoord& point_coord, const QSizeF& size_px, QObject* parent)
-    : GeometryPointImage(point_coord, QPixmap(size_px.toSize()), parent)
+    : GeometryPointImage(point_coord, size_px, parent)
 {
     // Update the shape (to draw the initial image pixmap).
     updateShape();
 }
 
-void GeometryPointArrow::updateShape()
+void GeometryPointArrow::generateShape()
 {
-    // Create a pixmap of the required size.
-    QPixmap image_pixmap(sizePx().toSize());
-
-    // Reset the image pixmap.
-    image_pixmap.fill(Qt::transparent);
-
-    // Create a painter for the image pixmap.
-    QPainter painter(&image_pixmap);
-
-    // Ensure antialiasing is enabled.
-    painter.setRenderHints(QPainter::Antialiasing, true);
-
-    // Set the pen and brush.
-    painter.setPen(pen());
-    painter.setBrush(brush());
-
-    // Add points to create arrow shape.
-    QPolygonF arrow;
-    arrow << util::PointPx((image_pixmap.width() / 2.0), 0.0);
-    arrow << util::PointPx(image_pixmap.width(), image_pixmap.height());
-    arrow << util::PointPx((image_pixmap.width() / 2.0), (image_pixmap.height() / 2.0));
-    arrow << util::PointPx(0.0, image_pixmap.height());
-
-    // Draw the arrow.
-    painter.drawPolygon(arrow);
-
-    // Set the image pixmap.
-    setImage(image_pixmap, false);
+    // Set the image pixmap to the shared sprite (identical arrows share one pixmap).
+    assignImage(util::SpriteAtlas::get().sprite("arrow", sizePx().toSize(), pen(), brush(), [](QPainter& painter, const QSize& size_px)
+        {
+            // Add points to create arrow shape.
+            QPolygonF arrow;
+            arrow << util::PointPx((size_px.width() / 2.0), 0.0);
+            arrow << util::PointPx(size_px.width(), size_px.height());
+            arrow << util::PointPx((size_px.width() / 2.0), (size_px.height() / 2.0));
+            arrow << util::PointPx(0.0, size_px.height());
+
+            // Draw the arrow.
+            painter.drawPolygon(arrow);
+        }));
 }
@@ -62,9 +62,9 @@ namespace qwm
             protected:
 
                 /**
-                 * Updates the shape (draws an arrow on to the image pixmap).
+                 * Generates the shape (draws an arrow on to the image pixmap).
                  */
-                void updateShape() final;
+                void generateShape() final;
 
             };
 
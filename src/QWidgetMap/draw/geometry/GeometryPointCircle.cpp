@@ -18,38 +18,35 @@
 
 #include "GeometryPointCircle.h"
 
+// Local includes.
+#include "../../util/SpriteAtlas.h"
+
 using namespace qwm;
 using namespace qwm::draw::geometry;
 
 GeometryPointCircle::GeometryPointCircle(const util::PointWorldCoord& point_coord, const QSizeF& size_px, QObject* parent)
-    : GeometryPointImage(point_coord, QPixmap(size_px.toSize()), parent)
+    : GeometryPointImage(point_coord, size_px, parent)
 {
     // Update the shape (to draw the initial image pixmap).
     updateShape();
 }
 
-void GeometryPointCircle::updateShape()
+std::shared_ptr<QPixmap> GeometryPointCircle::sprite(const QSizeF& size_px, const QPen& pen, const QBrush& brush)
 {
-    // Create a pixmap of the required size.
-    QPixmap image_pixmap(sizePx().toSize());
-
-    // Reset the image pixmap.
-    image_pixmap.fill(Qt::transparent);
-
-    // Create a painter for the image pixmap.
-    QPainter painter(&image_pixmap);
-
-    // Ensure antialiasing is enabled.
-    painter.setRenderHints(QPainter::Antialiasing, true);
-
-    // Set the pen and brush.
-    painter.setPen(pen());
-    painter.setBrush(brush());
-
-    // Draw the ellipse.
-    const double center_px(image_pixmap.width() / 2.0);
-    painter.drawEllipse(util::PointWorldPx(center_px, center_px), center_px - pen().widthF(), center_px - pen().widthF());
+    // Capture the pen width (the circle is inset by it).
+    const qreal pen_width_px(pen.widthF());
+
+    // Return the shared sprite (identical circles share one pixmap).
+    return util::SpriteAtlas::get().sprite("circle", size_px.toSize(), pen, brush, [pen_width_px](QPainter& painter, const QSize& sprite_size_px)
+        {
+            // Draw the ellipse.
+            const double center_px(sprite_size_px.width() / 2.0);
+            painter.drawEllipse(util::PointWorldPx(center_px, center_px), center_px - pen_width_px, center_px - pen_width_px);
+        });
+}
 
-    // Set the image pixmap.
-    setImage(image_pixmap, false);
+void GeometryPointCircle::generateShape()
+{
+    // Set the image pixmap to the circle sprite.
+    assignImage(sprite(sizePx(), pen(), brush()));
 }
@@ -59,12 +59,23 @@ namespace qwm
                 /// Destructor.
                 ~GeometryPointCircle() = default;
 
+            public:
+
+                /**
+                 * Fetches the (shared) circle sprite for the size, pen and brush.
+                 * @param size_px The circle size (pixels).
+                 * @param pen The pen to draw the circle with.
+                 * @param brush The brush to fill the circle with.
+                 * @return the circle sprite.
+                 */
+                static std::shared_ptr<QPixmap> sprite(const QSizeF& size_px, const QPen& pen, const QBrush& brush);
+
             protected:
 
                 /**
-                 * Updates the shape (draws a circle on to the image pixmap).
+                 * Generates the shape (draws a circle on to the image pixmap).
                  */
-                void updateShape() final;
+                void generateShape() final;
 
             };
 
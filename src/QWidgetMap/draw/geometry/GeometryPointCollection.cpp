@@ -0,0 +1,638 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "GeometryPointCollection.h"
+
+// Qt includes.
+#include <QtCore/QDebug>
+
+// STL includes.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Local includes.
+#include "../../projection/Projection.h"
+#include "../../util/MemoryUsage.h"
+#include "GeometryPointCircle.h"
+#include "GeometryPointShape.h"
+
+using namespace qwm;
+using namespace qwm::draw::geometry;
+
+namespace
+{
+    /// The number of points to aim for in each grid index cell.
+    const double m_index_points_per_cell(8.0);
+
+    /// The maximum number of grid index columns/rows.
+    const std::size_t m_index_cells_maximum(4096);
+
+    /// Marks the end of a grid index cell's appended points.
+    const std::uint32_t m_index_no_point(std::numeric_limits<std::uint32_t>::max());
+
+    /// The maximum number of pixels to track when skipping points drawn on the same pixel.
+    const std::size_t m_pixel_mask_maximum(std::size_t(1) << 26);
+
+    /**
+     * Calculates the grid cell that a value falls within (clamped to the grid).
+     * @param value The value.
+     * @param minimum The minimum value covered by the grid.
+     * @param size The size of the range covered by the grid.
+     * @param cells The number of grid cells.
+     * @return the grid cell.
+     */
+    std::size_t cellOf(const double& value, const double& minimum, const double& size, const std::size_t& cells)
+    {
+        // Calculate the (unclamped) cell.
+        const double cell(size > 0.0 ? ((value - minimum) / size) * double(cells) : 0.0);
+
+        // Return the cell, clamped to the grid.
+        return cell <= 0.0 ? 0 : std::min(cells - 1, std::size_t(cell));
+    }
+}
+
+GeometryPointCollection::GeometryPointCollection(QObject* parent)
+    : Drawable(DrawableType::GeometryPointCollection, parent)
+{
+
+}
+
+std::size_t GeometryPointCollection::styleCount() const
+{
+    // Gain a lock to protect the styles.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the number of styles.
+    return m_styles.size();
+}
+
+std::size_t GeometryPointCollection::addStyle(const QPen& pen, const QBrush& brush, const QSizeF& size_px)
+{
+    // Gain a lock to protect the styles.
+    QMutexLocker locker(&m_mutex);
+
+    // The style index to return.
+    std::size_t return_style_index(m_styles.size());
+
+    // Can another style be indexed?
+    if(m_styles.size() <= std::numeric_limits<std::uint16_t>::max())
+    {
+        // Add the style (with its shared circle sprite).
+        Style style;
+        style.m_pen = pen;
+        style.m_brush = brush;
+        style.m_size_px = size_px;
+        style.m_sprite = GeometryPointCircle::sprite(size_px, pen, brush);
+        m_styles.push_back(style);
+
+        // Update the largest circle size.
+        m_maximum_size_px = m_maximum_size_px.expandedTo(size_px);
+    }
+    else
+    {
+        // Log the error.
+        qDebug() << "Unable to add style to point collection, the maximum number of styles has been reached.";
+    }
+
+    // Return the style index.
+    return return_style_index;
+}
+
+std::size_t GeometryPointCollection::pointCount() const
+{
+    // Gain a lock to protect the points.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the number of points.
+    return m_longitudes.size();
+}
+
+void GeometryPointCollection::reserve(const std::size_t& count)
+{
+    // Gain a lock to protect the points.
+    QMutexLocker locker(&m_mutex);
+
+    // Reserve the storage for each array.
+    m_longitudes.reserve(count);
+    m_latitudes.reserve(count);
+    m_style_indices.reserve(count);
+    m_row_ids.reserve(count);
+}
+
+bool GeometryPointCollection::addPoint(const util::PointWorldCoord& point_coord, const std::size_t& style_index, const std::uint32_t& row_id)
+{
+    // Default return success.
+    bool success(false);
+
+    {
+        // Gain a lock to protect the points.
+        QMutexLocker locker(&m_mutex);
+
+        // Does the style exist and can another point be indexed?
+        if(style_index < m_styles.size() && m_longitudes.size() < std::numeric_limits<std::uint32_t>::max())
+        {
+            // Add the point.
+            m_longitudes.push_back(point_coord.longitude());
+            m_latitudes.push_back(point_coord.latitude());
+            m_style_indices.push_back(std::uint16_t(style_index));
+            m_row_ids.push_back(row_id);
+
+            // Append the point to the grid index.
+            indexPoint(m_longitudes.size() - 1);
+
+            // Success!
+            success = true;
+        }
+    }
+
+    // Was the point added?
+    if(success)
+    {
+        // Emit that we need to redraw to display this change.
+        emit requestRedraw();
+    }
+
+    // Return our success.
+    return success;
+}
+
+std::size_t GeometryPointCollection::addPoints(const std::vector<util::PointWorldCoord>& points_coord, const std::size_t& style_index, const std::uint32_t& first_row_id)
+{
+    // Keep track of the number of points added.
+    std::size_t return_count(0);
+
+    {
+        // Gain a lock to protect the points.
+        QMutexLocker locker(&m_mutex);
+
+        // Does the style exist?
+        if(style_index < m_styles.size())
+        {
+            // Calculate the number of points that can be indexed.
+            return_count = std::min(points_coord.size(), std::size_t(std::numeric_limits<std::uint32_t>::max()) - m_longitudes.size());
+
+            // Reserve the storage for the points.
+            m_longitudes.reserve(m_longitudes.size() + return_count);
+            m_latitudes.reserve(m_latitudes.size() + return_count);
+            m_style_indices.reserve(m_style_indices.size() + return_count);
+            m_row_ids.reserve(m_row_ids.size() + return_count);
+
+            // Loop through each point and add it.
+            for(std::size_t i = 0; i < return_count; ++i)
+            {
+                m_longitudes.push_back(points_coord[i].longitude());
+                m_latitudes.push_back(points_coord[i].latitude());
+                m_style_indices.push_back(std::uint16_t(style_index));
+                m_row_ids.push_back(std::uint32_t(first_row_id + i));
+
+                // Append the point to the grid index.
+                indexPoint(m_longitudes.size() - 1);
+            }
+        }
+    }
+
+    // Were any points added?
+    if(return_count > 0)
+    {
+        // Emit that we need to redraw to display this change.
+        emit requestRedraw();
+    }
+
+    // Return the number of points added.
+    return return_count;
+}
+
+void GeometryPointCollection::clearPoints()
+{
+    {
+        // Gain a lock to protect the points.
+        QMutexLocker locker(&m_mutex);
+
+        // Release the points and the grid index.
+        std::vector<double>().swap(m_longitudes);
+        std::vector<double>().swap(m_latitudes);
+        std::vector<std::uint16_t>().swap(m_style_indices);
+        std::vector<std::uint32_t>().swap(m_row_ids);
+        std::vector<std::uint32_t>().swap(m_index_cell_offsets);
+        std::vector<std::uint32_t>().swap(m_index_points);
+        std::vector<std::uint32_t>().swap(m_index_cell_appended);
+        std::vector<std::uint32_t>().swap(m_index_appended_previous);
+        m_index_valid = false;
+    }
+
+    // Emit that we need to redraw to display this change.
+    emit requestRedraw();
+}
+
+util::PointWorldCoord GeometryPointCollection::pointCoord(const std::size_t& index) const
+{
+    // Gain a lock to protect the points.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the point.
+    return util::PointWorldCoord(m_longitudes.at(index), m_latitudes.at(index));
+}
+
+std::size_t GeometryPointCollection::styleIndex(const std::size_t& index) const
+{
+    // Gain a lock to protect the points.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the style index.
+    return m_style_indices.at(index);
+}
+
+std::uint32_t GeometryPointCollection::rowId(const std::size_t& index) const
+{
+    // Gain a lock to protect the points.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the attribute row id.
+    return m_row_ids.at(index);
+}
+
+std::vector<std::size_t> GeometryPointCollection::pointsWithin(const util::RectWorldCoord& range_coord) const
+{
+    // The points to return.
+    std::vector<std::size_t> return_indices;
+
+    // Gain a lock to protect the points.
+    QMutexLocker locker(&m_mutex);
+
+    // Ensure the grid index is up-to-date.
+    buildIndex();
+
+    // Collect each point within the (normalised) range.
+    forEachPointWithin(range_coord.normalized(), [&return_indices](const std::size_t& index)
+    {
+        return_indices.push_back(index);
+    });
+
+    // Return the points.
+    return return_indices;
+}
+
+std::vector<std::size_t> GeometryPointCollection::touches(const Geometry& geometry, const Viewport& viewport) const
+{
+    // The points to return.
+    std::vector<std::size_t> return_indices;
+
+    // Check we are visible.
+    if(isVisible(viewport))
+    {
+        // Captures a point that could touch the geometry.
+        struct Candidate
+        {
+            /// The index of the point.
+            std::size_t m_index;
+
+            /// The point (world coordinates).
+            util::PointWorldCoord m_point_coord;
+
+            /// The circle size (pixels).
+            QSizeF m_size_px;
+        };
+
+        // Fetch the geometry's bounding box.
+        const util::RectWorldCoord geometry_rect_coord(geometry.boundingBox(viewport));
+
+        // Find the points whose circles could touch the geometry's bounding box.
+        std::vector<Candidate> candidates;
+        {
+            // Gain a lock to protect the points.
+            QMutexLocker locker(&m_mutex);
+
+            // Ensure the grid index is up-to-date.
+            buildIndex();
+
+            // Collect each point within the bounding box (padded by the largest circle).
+            const qreal padding_px(std::max(m_maximum_size_px.width(), m_maximum_size_px.height()) / 2.0);
+            forEachPointWithin(paddedRange(geometry_rect_coord, padding_px, viewport), [this, &candidates](const std::size_t& index)
+            {
+                candidates.push_back(Candidate { index, util::PointWorldCoord(m_longitudes[index], m_latitudes[index]), m_styles[m_style_indices[index]].m_size_px });
+            });
+        }
+
+        // Calculate the geometry's bounding box in pixels.
+        const QRectF geometry_rect_px(QRectF(projection::toPointWorldPx(viewport, geometry_rect_coord.topLeftCoord()), projection::toPointWorldPx(viewport, geometry_rect_coord.bottomRightCoord())).normalized());
+
+        // Loop through each candidate point.
+        for(const auto& candidate : candidates)
+        {
+            // Is the geometry a point?
+            bool touched(false);
+            if(geometry.geometryType() == GeometryType::GeometryPoint)
+            {
+                // They have touched if the bounding boxes intersect (as per GeometryPoint).
+                const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, candidate.m_point_coord));
+                touched = QRectF(point_px.x() - (candidate.m_size_px.width() / 2.0), point_px.y() - (candidate.m_size_px.height() / 2.0), candidate.m_size_px.width(), candidate.m_size_px.height()).intersects(geometry_rect_px);
+            }
+            else
+            {
+                // Let the geometry check against the point's shape (as per GeometryPoint).
+                const GeometryPointShape point_shape(candidate.m_point_coord, candidate.m_size_px);
+                touched = geometry.touches(point_shape, viewport);
+            }
+
+            // Has the point touched?
+            if(touched)
+            {
+                // Add the point.
+                return_indices.push_back(candidate.m_index);
+            }
+        }
+    }
+
+    // Return the points.
+    return return_indices;
+}
+
+void GeometryPointCollection::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+{
+    // The sprite and the pixmap fragments of each style.
+    std::vector<QPixmap> sprites;
+    std::vector<std::vector<QPainter::PixmapFragment>> fragments;
+
+    {
+        // Gain a lock to protect the points.
+        QMutexLocker locker(&m_mutex);
+
+        // Ensure the grid index is up-to-date.
+        buildIndex();
+
+        // Capture each style's sprite.
+        std::vector<QRectF> source_rects;
+        for(const auto& style : m_styles)
+        {
+            sprites.push_back(*(style.m_sprite));
+            source_rects.push_back(QRectF(QPointF(0.0, 0.0), QSizeF(style.m_sprite->size())));
+        }
+
+        // Calculate the drawing rect in pixels (padded by the largest circle, so that partially visible circles are drawn).
+        const qreal padding_px(std::max(m_maximum_size_px.width(), m_maximum_size_px.height()) / 2.0);
+        const QRectF drawing_rect_px(QRectF(projection::toPointWorldPx(viewport, drawing_rect_world_coord.topLeftCoord()), projection::toPointWorldPx(viewport, drawing_rect_world_coord.bottomRightCoord())).normalized().adjusted(-padding_px, -padding_px, padding_px, padding_px));
+
+        // Each style tracks the pixels already drawn, so that points that land on the same pixel are only drawn once.
+        const std::size_t mask_width(std::size_t(std::ceil(drawing_rect_px.width())) + 1);
+        const std::size_t mask_height(std::size_t(std::ceil(drawing_rect_px.height())) + 1);
+        const bool mask_enabled(mask_width * mask_height <= m_pixel_mask_maximum);
+        std::vector<std::vector<bool>> masks(m_styles.size());
+
+        // Loop through each point within the drawing rect.
+        fragments.resize(m_styles.size());
+        forEachPointWithin(paddedRange(drawing_rect_world_coord, padding_px, viewport), [&](const std::size_t& index)
+        {
+            // Calculate the point in pixels, relative to the drawing rect.
+            const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, util::PointWorldCoord(m_longitudes[index], m_latitudes[index])));
+            const qreal x_px(point_px.x() - drawing_rect_px.left());
+            const qreal y_px(point_px.y() - drawing_rect_px.top());
+
+            // Is the point within the drawing rect?
+            if(x_px >= 0.0 && y_px >= 0.0 && x_px < mask_width && y_px < mask_height)
+            {
+                // Has the pixel already been drawn with this style?
+                const std::size_t style_index(m_style_indices[index]);
+                bool drawn(false);
+                if(mask_enabled)
+                {
+                    // Fetch the style's mask (creating it the first time it is needed).
+                    std::vector<bool>& mask(masks[style_index]);
+                    if(mask.empty())
+                    {
+                        mask.resize(mask_width * mask_height, false);
+                    }
+
+                    // Check and mark the pixel.
+                    const std::size_t pixel((std::size_t(y_px) * mask_width) + std::size_t(x_px));
+                    drawn = mask[pixel];
+                    mask[pixel] = true;
+                }
+
+                // Should the point be drawn?
+                if(drawn == false)
+                {
+                    // Add the point to the style's batch.
+                    fragments[style_index].push_back(QPainter::PixmapFragment::create(point_px, source_rects[style_index]));
+                }
+            }
+        });
+    }
+
+    // Loop through each style and draw its points with a single call.
+    for(std::size_t i = 0; i < fragments.size(); ++i)
+    {
+        // Does the style have any points to draw?
+        if(fragments[i].empty() == false)
+        {
+            // Draw the points.
+            painter.drawPixmapFragments(fragments[i].data(), int(fragments[i].size()), sprites[i]);
+        }
+    }
+}
+
+std::size_t GeometryPointCollection::memoryBytes() const
+{
+    // Gain a lock to protect the styles, points and grid index.
+    QMutexLocker locker(&m_mutex);
+
+    // Add the point arrays and grid index to the size of the object.
+    std::size_t return_bytes(sizeof(GeometryPointCollection));
+    return_bytes += (m_longitudes.capacity() + m_latitudes.capacity()) * sizeof(double);
+    return_bytes += m_style_indices.capacity() * sizeof(std::uint16_t);
+    return_bytes += (m_row_ids.capacity() + m_index_cell_offsets.capacity() + m_index_points.capacity()) * sizeof(std::uint32_t);
+    return_bytes += (m_index_cell_appended.capacity() + m_index_appended_previous.capacity()) * sizeof(std::uint32_t);
+
+    // Add the styles and their sprites.
+    return_bytes += m_styles.capacity() * sizeof(Style);
+    for(const auto& style : m_styles)
+    {
+        if(style.m_sprite != nullptr)
+        {
+            return_bytes += util::MemoryUsage::pixmapBytes(*style.m_sprite);
+        }
+    }
+
+    // Return the estimated number of bytes.
+    return return_bytes;
+}
+
+QRectF GeometryPointCollection::paddedRange(const util::RectWorldCoord& rect_coord, const qreal& padding_px, const Viewport& viewport)
+{
+    // Calculate the rect in pixels, padded.
+    const QRectF rect_px(QRectF(projection::toPointWorldPx(viewport, rect_coord.topLeftCoord()), projection::toPointWorldPx(viewport, rect_coord.bottomRightCoord())).normalized().adjusted(-padding_px, -padding_px, padding_px, padding_px));
+
+    // Convert the padded corners back to world coordinates.
+    const util::PointWorldCoord top_left_coord(projection::toPointWorldCoord(viewport, util::PointWorldPx(rect_px.left(), rect_px.top())));
+    const util::PointWorldCoord bottom_right_coord(projection::toPointWorldCoord(viewport, util::PointWorldPx(rect_px.right(), rect_px.bottom())));
+
+    // Return the normalised range.
+    return QRectF(QPointF(std::min(top_left_coord.longitude(), bottom_right_coord.longitude()), std::min(top_left_coord.latitude(), bottom_right_coord.latitude())),
+                  QPointF(std::max(top_left_coord.longitude(), bottom_right_coord.longitude()), std::max(top_left_coord.latitude(), bottom_right_coord.latitude())));
+}
+
+void GeometryPointCollection::buildIndex() const
+{
+    // Has the grid index been invalidated?
+    if(m_index_valid == false)
+    {
+        // Calculate the range covered by the points.
+        double longitude_minimum(std::numeric_limits<double>::max());
+        double latitude_minimum(std::numeric_limits<double>::max());
+        double longitude_maximum(std::numeric_limits<double>::lowest());
+        double latitude_maximum(std::numeric_limits<double>::lowest());
+        for(std::size_t i = 0; i < m_longitudes.size(); ++i)
+        {
+            longitude_minimum = std::min(longitude_minimum, m_longitudes[i]);
+            latitude_minimum = std::min(latitude_minimum, m_latitudes[i]);
+            longitude_maximum = std::max(longitude_maximum, m_longitudes[i]);
+            latitude_maximum = std::max(latitude_maximum, m_latitudes[i]);
+        }
+        m_index_range_coord = m_longitudes.empty() ? QRectF() : QRectF(QPointF(longitude_minimum, latitude_minimum), QPointF(longitude_maximum, latitude_maximum));
+
+        // Calculate the grid size, aiming for roughly square cells with a few points in each.
+        const double cells(std::max(1.0, double(m_longitudes.size()) / m_index_points_per_cell));
+        double columns(1.0);
+        if(m_index_range_coord.width() > 0.0)
+        {
+            // Split the cells between the columns/rows by the aspect ratio (or all into columns if the points are on a line of latitude).
+            columns = m_index_range_coord.height() > 0.0 ? std::min(cells, std::sqrt(cells * (m_index_range_coord.width() / m_index_range_coord.height()))) : cells;
+        }
+        m_index_columns = std::min(m_index_cells_maximum, std::max(std::size_t(1), std::size_t(std::ceil(columns))));
+        m_index_rows = m_index_range_coord.height() > 0.0 ? std::min(m_index_cells_maximum, std::max(std::size_t(1), std::size_t(std::ceil(cells / double(m_index_columns))))) : 1;
+
+        // Count the points in each cell.
+        std::vector<std::uint32_t> cell_of_points(m_longitudes.size());
+        m_index_cell_offsets.assign((m_index_columns * m_index_rows) + 1, 0);
+        for(std::size_t i = 0; i < m_longitudes.size(); ++i)
+        {
+            const std::size_t column(cellOf(m_longitudes[i], m_index_range_coord.left(), m_index_range_coord.width(), m_index_columns));
+            const std::size_t row(cellOf(m_latitudes[i], m_index_range_coord.top(), m_index_range_coord.height(), m_index_rows));
+            cell_of_points[i] = std::uint32_t((row * m_index_columns) + column);
+            ++m_index_cell_offsets[cell_of_points[i] + 1];
+        }
+
+        // Convert the counts into offsets.
+        for(std::size_t i = 1; i < m_index_cell_offsets.size(); ++i)
+        {
+            m_index_cell_offsets[i] += m_index_cell_offsets[i - 1];
+        }
+
+        // Place each point in its cell.
+        std::vector<std::uint32_t> cell_positions(m_index_cell_offsets.begin(), m_index_cell_offsets.end() - 1);
+        m_index_points.resize(m_longitudes.size());
+        for(std::size_t i = 0; i < m_longitudes.size(); ++i)
+        {
+            m_index_points[cell_positions[cell_of_points[i]]++] = std::uint32_t(i);
+        }
+
+        // No points have been appended to the cells yet.
+        m_index_cell_appended.clear();
+        m_index_appended_previous.clear();
+
+        // The grid index is now valid.
+        m_index_valid = true;
+    }
+}
+
+void GeometryPointCollection::indexPoint(const std::size_t& index)
+{
+    // Is the grid index valid, and is the point within the range it covers?
+    if(m_index_valid && m_index_points.empty() == false &&
+       m_longitudes[index] >= m_index_range_coord.left() && m_longitudes[index] <= m_index_range_coord.right() &&
+       m_latitudes[index] >= m_index_range_coord.top() && m_latitudes[index] <= m_index_range_coord.bottom())
+    {
+        // Have the cells become crowded?
+        if(m_index_appended_previous.size() >= m_index_points.size())
+        {
+            // Invalidate the grid index, so that it is rebuilt with more cells.
+            m_index_valid = false;
+        }
+        else
+        {
+            // Allocate the appended points of each cell, if this is the first point appended.
+            if(m_index_cell_appended.empty())
+            {
+                m_index_cell_appended.assign(m_index_columns * m_index_rows, m_index_no_point);
+            }
+
+            // Append the point to its cell.
+            const std::size_t column(cellOf(m_longitudes[index], m_index_range_coord.left(), m_index_range_coord.width(), m_index_columns));
+            const std::size_t row(cellOf(m_latitudes[index], m_index_range_coord.top(), m_index_range_coord.height(), m_index_rows));
+            const std::size_t cell((row * m_index_columns) + column);
+            m_index_appended_previous.push_back(m_index_cell_appended[cell]);
+            m_index_cell_appended[cell] = std::uint32_t(index);
+        }
+    }
+    else
+    {
+        // Invalidate the grid index, so that it is rebuilt to cover the point.
+        m_index_valid = false;
+    }
+}
+
+template <typename Function>
+void GeometryPointCollection::forEachPointWithin(const QRectF& range_coord, Function function) const
+{
+    // Does the range overlap the points at all?
+    if(m_index_points.empty() == false &&
+       range_coord.left() <= m_index_range_coord.right() && range_coord.right() >= m_index_range_coord.left() &&
+       range_coord.top() <= m_index_range_coord.bottom() && range_coord.bottom() >= m_index_range_coord.top())
+    {
+        // Calls the function for a point, if it is within the range.
+        const auto visit = [this, &range_coord, &function](const std::size_t& index)
+        {
+            // Is the point within the range?
+            if(m_longitudes[index] >= range_coord.left() && m_longitudes[index] <= range_coord.right() &&
+               m_latitudes[index] >= range_coord.top() && m_latitudes[index] <= range_coord.bottom())
+            {
+                // Call the function for the point.
+                function(index);
+            }
+        };
+
+        // Calculate the cells the range covers.
+        const std::size_t column_first(cellOf(range_coord.left(), m_index_range_coord.left(), m_index_range_coord.width(), m_index_columns));
+        const std::size_t column_last(cellOf(range_coord.right(), m_index_range_coord.left(), m_index_range_coord.width(), m_index_columns));
+        const std::size_t row_first(cellOf(range_coord.top(), m_index_range_coord.top(), m_index_range_coord.height(), m_index_rows));
+        const std::size_t row_last(cellOf(range_coord.bottom(), m_index_range_coord.top(), m_index_range_coord.height(), m_index_rows));
+
+        // Loop through each cell.
+        for(std::size_t row = row_first; row <= row_last; ++row)
+        {
+            for(std::size_t column = column_first; column <= column_last; ++column)
+            {
+                // Loop through each point in the cell.
+                const std::size_t cell((row * m_index_columns) + column);
+                for(std::size_t i = m_index_cell_offsets[cell]; i < m_index_cell_offsets[cell + 1]; ++i)
+                {
+                    visit(m_index_points[i]);
+                }
+
+                // Loop through each point appended to the cell since the grid index was built.
+                if(m_index_cell_appended.empty() == false)
+                {
+                    for(std::uint32_t index = m_index_cell_appended[cell]; index != m_index_no_point; index = m_index_appended_previous[index - m_index_points.size()])
+                    {
+                        visit(index);
+                    }
+                }
+            }
+        }
+    }
+}
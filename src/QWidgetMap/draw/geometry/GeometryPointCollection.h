@@ -0,0 +1,297 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QMutex>
+#include <QtCore/QSizeF>
+#include <QtGui/QBrush>
+#include <QtGui/QPen>
+#include <QtGui/QPixmap>
+
+// STL includes.
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Local includes.
+#include "../../qwidgetmap_global.h"
+#include "../../util/Point.h"
+#include "../../util/Rect.h"
+#include "../../Viewport.h"
+#include "../Drawable.h"
+#include "Geometry.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Drawable namespace.
+    namespace draw
+    {
+
+        /// Geometry namespace.
+        namespace geometry
+        {
+
+            /**
+             * Implementation of a drawable collection of (potentially millions of) circle points.
+             * Rather than one GeometryPoint object per point, the points are stored as arrays (coordinates, style index and
+             * attribute row id) and share a style table. The points are indexed by a uniform grid, which is built the first
+             * time it is needed. Points added within the grid's range are appended to their cells, the grid is only rebuilt
+             * once a point is added outside its range or its cells become crowded. Points are referred to by their index in
+             * the collection.
+             */
+            class QWIDGETMAP_EXPORT GeometryPointCollection : public Drawable
+            {
+                Q_OBJECT
+
+            public:
+
+                /**
+                 * This is used to construct an (empty) point collection.
+                 * @param parent QObject parent ownership.
+                 */
+                explicit GeometryPointCollection(QObject* parent = nullptr);
+
+                /// Disable copy constructor.
+                GeometryPointCollection(const GeometryPointCollection&) = delete;
+
+                /// Disable copy assignment.
+                GeometryPointCollection& operator=(const GeometryPointCollection&) = delete;
+
+                /// Destructor.
+                virtual ~GeometryPointCollection() = default;
+
+            public:
+
+                /**
+                 * Fetches the number of styles.
+                 * @return the number of styles.
+                 */
+                std::size_t styleCount() const;
+
+                /**
+                 * Adds a style that points can be drawn with (points are drawn as circles, like GeometryPointCircle).
+                 * At most 65536 styles can be added.
+                 * @param pen The pen to draw the circle with.
+                 * @param brush The brush to fill the circle with.
+                 * @param size_px The circle size (pixels).
+                 * @return the style index (or styleCount() if the style could not be added).
+                 */
+                std::size_t addStyle(const QPen& pen, const QBrush& brush, const QSizeF& size_px = QSizeF(10.0, 10.0));
+
+                /**
+                 * Fetches the number of points.
+                 * @return the number of points.
+                 */
+                std::size_t pointCount() const;
+
+                /**
+                 * Reserves storage for a number of points (to avoid reallocation when adding them).
+                 * @param count The number of points to reserve storage for.
+                 */
+                void reserve(const std::size_t& count);
+
+                /**
+                 * Adds a point.
+                 * @param point_coord The point to add (world coordinates).
+                 * @param style_index The style index to draw the point with.
+                 * @param row_id The attribute row id of the point.
+                 * @return whether the point was added (the style index must exist).
+                 */
+                bool addPoint(const util::PointWorldCoord& point_coord, const std::size_t& style_index = 0, const std::uint32_t& row_id = 0);
+
+                /**
+                 * Adds points that share a style, with consecutive attribute row ids.
+                 * @param points_coord The points to add (world coordinates).
+                 * @param style_index The style index to draw the points with.
+                 * @param first_row_id The attribute row id of the first point.
+                 * @return the number of points added.
+                 */
+                std::size_t addPoints(const std::vector<util::PointWorldCoord>& points_coord, const std::size_t& style_index = 0, const std::uint32_t& first_row_id = 0);
+
+                /**
+                 * Removes all points (the styles are kept).
+                 */
+                void clearPoints();
+
+                /**
+                 * Fetches a point.
+                 * @param index The index of the point.
+                 * @return the point (world coordinates).
+                 */
+                util::PointWorldCoord pointCoord(const std::size_t& index) const;
+
+                /**
+                 * Fetches the style index of a point.
+                 * @param index The index of the point.
+                 * @return the style index (or styleCount() if the style could not be added).of the point.
+                 */
+                std::size_t styleIndex(const std::size_t& index) const;
+
+                /**
+                 * Fetches the attribute row id of a point.
+                 * @param index The index of the point.
+                 * @return the attribute row id of the point.
+                 */
+                std::uint32_t rowId(const std::size_t& index) const;
+
+                /**
+                 * Fetches the points within a range.
+                 * @param range_coord The range to search (world coordinates).
+                 * @return the indices of the points within the range.
+                 */
+                std::vector<std::size_t> pointsWithin(const util::RectWorldCoord& range_coord) const;
+
+                /**
+                 * Checks which points touch (intersect) with a geometry (each point is treated as its circle's bounding box).
+                 * @param geometry The geometry to compare against.
+                 * @param viewport The viewport to use.
+                 * @return the indices of the points that touch.
+                 */
+                std::vector<std::size_t> touches(const Geometry& geometry, const Viewport& viewport) const;
+
+                /**
+                 * Draws the item to the provided painter.
+                 * @param painter The painter to draw on.
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The current viewport to use.
+                 */
+                void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
+
+                /**
+                 * Estimates the number of bytes used by the point collection (the object, its point arrays, styles and grid index).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
+            signals:
+
+                /**
+                 * Signal emitted when points in the collection are clicked.
+                 * @param indices The indices of the points clicked.
+                 */
+                void pointsClicked(const std::vector<std::size_t>& indices) const;
+
+            private:
+
+                /// Captures a style that points can be drawn with.
+                struct Style
+                {
+                    /// The pen to draw the circle with.
+                    QPen m_pen;
+
+                    /// The brush to fill the circle with.
+                    QBrush m_brush;
+
+                    /// The circle size (pixels).
+                    QSizeF m_size_px;
+
+                    /// The circle sprite.
+                    std::shared_ptr<QPixmap> m_sprite;
+                };
+
+                /**
+                 * Converts a rect in world coordinates into a longitude/latitude range, padded by a number of pixels.
+                 * @param rect_coord The rect to convert (world coordinates).
+                 * @param padding_px The padding to add to each side (pixels).
+                 * @param viewport The viewport to use.
+                 * @return the padded range (world coordinates, normalised so that the left/top are the minimum longitude/latitude).
+                 */
+                static QRectF paddedRange(const util::RectWorldCoord& rect_coord, const qreal& padding_px, const Viewport& viewport);
+
+                /**
+                 * Builds the grid index, if the points have changed since it was last built.
+                 * The mutex must be locked by the caller.
+                 */
+                void buildIndex() const;
+
+                /**
+                 * Appends a point to its grid index cell, or invalidates the grid index if the point is outside the range
+                 * covered by the grid or the cells have become crowded (twice the points the grid was built for).
+                 * The mutex must be locked by the caller.
+                 * @param index The index of the point.
+                 */
+                void indexPoint(const std::size_t& index);
+
+                /**
+                 * Calls a function for each point within a range, using the grid index.
+                 * The mutex must be locked and the grid index built by the caller.
+                 * @param range_coord The range to search (world coordinates, normalised).
+                 * @param function The function to call with the index of each point within the range.
+                 */
+                template <typename Function>
+                void forEachPointWithin(const QRectF& range_coord, Function function) const;
+
+            private:
+
+                /// Mutex to protect the styles, points and grid index.
+                mutable QMutex m_mutex;
+
+                /// The styles.
+                std::vector<Style> m_styles;
+
+                /// The largest circle size of the styles (pixels).
+                QSizeF m_maximum_size_px;
+
+                /// The longitude of each point.
+                std::vector<double> m_longitudes;
+
+                /// The latitude of each point.
+                std::vector<double> m_latitudes;
+
+                /// The style index of each point.
+                std::vector<std::uint16_t> m_style_indices;
+
+                /// The attribute row id of each point.
+                std::vector<std::uint32_t> m_row_ids;
+
+                /// Whether the grid index is valid for the current points.
+                mutable bool m_index_valid { false };
+
+                /// The range covered by the grid index (world coordinates, normalised).
+                mutable QRectF m_index_range_coord;
+
+                /// The number of grid index columns.
+                mutable std::size_t m_index_columns { 0 };
+
+                /// The number of grid index rows.
+                mutable std::size_t m_index_rows { 0 };
+
+                /// The offset of each grid cell's first point in the grid index points (plus a final end offset).
+                mutable std::vector<std::uint32_t> m_index_cell_offsets;
+
+                /// The point indices, ordered by grid cell.
+                mutable std::vector<std::uint32_t> m_index_points;
+
+                /// The last point appended to each grid cell since the grid index was built (allocated on the first append).
+                mutable std::vector<std::uint32_t> m_index_cell_appended;
+
+                /// The previous point appended to the same grid cell, for each point appended since the grid index was built.
+                mutable std::vector<std::uint32_t> m_index_appended_previous;
+
+            };
+
+        }
+
+    }
+
+}
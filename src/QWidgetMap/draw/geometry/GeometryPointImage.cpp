@@ -18,8 +18,15 @@
 
 #include "GeometryPointImage.h"
 
+// Qt includes.
+#include <QtGui/QTransform>
+
+// STL includes.
+#include <algorithm>
+
 // Local includes.
 #include "../../projection/Projection.h"
+#include "../../util/MemoryUsage.h"
 
 using namespace qwm;
 using namespace qwm::draw::geometry;
@@ -37,6 +44,12 @@ GeometryPointImage::GeometryPointImage(const util::PointWorldCoord& point_coord,
 
 }
 
+GeometryPointImage::GeometryPointImage(const util::PointWorldCoord& point_coord, const QSizeF& size_px, QObject* parent)
+    : GeometryPointShape(point_coord, size_px, parent)
+{
+
+}
+
 const QPixmap& GeometryPointImage::image() const
 {
     // Is the image pixmap currently null?
@@ -79,22 +92,49 @@ void GeometryPointImage::setImage(const QPixmap& new_image, const bool& update_s
     setSizePx(m_image->size(), update_shape);
 }
 
-void GeometryPointImage::draw(QPainter& painter, const util::RectWorldCoord& /*drawing_rect_world_coord*/, const Viewport& viewport) const
+void GeometryPointImage::assignImage(const std::shared_ptr<QPixmap>& new_image)
 {
-    // Calculate the pixmap rect in world coordinates.
-    const util::RectWorldCoord pixmap_rect_world_coord(boundingBox(viewport));
+    // Set the image pixmap.
+    m_image = new_image;
 
-    // Calculate the pixmap rect to draw within.
-    const util::RectWorldPx pixmap_rect_px(projection::toPointWorldPx(viewport, pixmap_rect_world_coord.topLeftCoord()), projection::toPointWorldPx(viewport, pixmap_rect_world_coord.bottomRightCoord()));
+    // Update the size (pixels), without updating the shape.
+    assignSizePx(image().size());
+}
+
+QPainter::PixmapFragment GeometryPointImage::pixmapFragment(const Viewport& viewport) const
+{
+    // Calculate the shape rect's top-left point in pixels.
+    const util::PointWorldPx top_left_point_px(calculateTopLeftPoint(projection::toPointWorldPx(viewport, coord()), alignmentType(), sizePx()));
 
-    // Translate to center point with required rotation.
-    painter.translate(pixmap_rect_px.centerPx());
-    painter.rotate(rotation());
+    // Calculate the center of the shape rect (the point the image is rotated about).
+    const QPointF center_px(top_left_point_px.x() + (sizePx().width() / 2.0), top_left_point_px.y() + (sizePx().height() / 2.0));
 
-    // Draw the pixmap.
-    painter.drawPixmap(-pixmap_rect_px.width() / 2.0, -pixmap_rect_px.height() / 2.0, image());
+    // The image is drawn from the shape rect's top-left, so offset to the image's center (if the sizes differ) and rotate it.
+    const QSize image_size_px(image().size());
+    const QPointF image_offset_px(QTransform().rotate(rotation()).map(QPointF((image_size_px.width() - sizePx().width()) / 2.0, (image_size_px.height() - sizePx().height()) / 2.0)));
+
+    // Return the pixmap fragment.
+    return QPainter::PixmapFragment::create(center_px + image_offset_px, QRectF(0.0, 0.0, image_size_px.width(), image_size_px.height()), 1.0, 1.0, rotation());
+}
+
+void GeometryPointImage::draw(QPainter& painter, const util::RectWorldCoord& /*drawing_rect_world_coord*/, const Viewport& viewport) const
+{
+    // Fetch the pixmap fragment.
+    const QPainter::PixmapFragment pixmap_fragment(pixmapFragment(viewport));
+
+    // Draw the pixmap (rotated about its center).
+    painter.drawPixmapFragments(&pixmap_fragment, 1, image());
+}
+
+std::size_t GeometryPointImage::memoryBytes() const
+{
+    // Add the image pixmap, split between everything that shares it (ie: sprites shared by identical shapes).
+    std::size_t image_bytes(0);
+    if(m_image != nullptr)
+    {
+        image_bytes = util::MemoryUsage::pixmapBytes(*m_image) / std::size_t(std::max(m_image.use_count(), 1L));
+    }
 
-    // Un-translate.
-    painter.rotate(-rotation());
-    painter.translate(-pixmap_rect_px.centerPx());
+    // Return the size of the object and its share of the image pixmap.
+    return sizeof(GeometryPointImage) + image_bytes;
 }
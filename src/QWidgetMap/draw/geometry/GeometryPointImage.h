@@ -19,6 +19,7 @@
 #pragma once
 
 // Qt includes.
+#include <QtGui/QPainter>
 #include <QtGui/QPixmap>
 
 // Local includes.
@@ -80,6 +81,16 @@ namespace qwm
                 /// Destructor.
                 ~GeometryPointImage() = default;
 
+            protected:
+
+                /**
+                 * This constructor creates a point without an image pixmap, for derived classes that set it themselves.
+                 * @param point_coord The point to draw the image at (world coordinates).
+                 * @param size_px The size of the image pixmap (pixels).
+                 * @param parent QObject parent ownership.
+                 */
+                GeometryPointImage(const util::PointWorldCoord& point_coord, const QSizeF& size_px, QObject* parent = nullptr);
+
             public:
 
                 /**
@@ -102,6 +113,14 @@ namespace qwm
                  */
                 void setImage(const QPixmap& new_image, const bool& update_shape = true);
 
+                /**
+                 * Fetches the pixmap fragment that draws the image pixmap at the point (with its rotation).
+                 * Points that share an image pixmap can be drawn together, by passing their fragments to QPainter::drawPixmapFragments.
+                 * @param viewport The current viewport to use.
+                 * @return the pixmap fragment (in world pixels).
+                 */
+                QPainter::PixmapFragment pixmapFragment(const Viewport& viewport) const;
+
             public:
 
                 /**
@@ -112,6 +131,21 @@ namespace qwm
                  */
                 void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
 
+                /**
+                 * Estimates the number of bytes used by the image point (the object and its share of the image pixmap).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
+            protected:
+
+                /**
+                 * Set the image pixmap to draw, and the size (pixels) to match it, without emitting any signals.
+                 * This is used by derived classes that generate their image pixmap in generateShape().
+                 * @param new_image The image pixmap to draw.
+                 */
+                void assignImage(const std::shared_ptr<QPixmap>& new_image);
+
             private:
 
                 /// The image pixmap to draw.
@@ -30,42 +30,6 @@ GeometryPointShape::GeometryPointShape(const util::PointWorldCoord& point_coord,
 
 }
 
-void GeometryPointShape::setPen(const std::shared_ptr<QPen>& pen)
-{
-    // Set the pen to draw with.
-    Geometry::setPen(pen);
-
-    // Update the shape.
-    updateShape();
-}
-
-void GeometryPointShape::setPen(const QPen& pen)
-{
-    // Set the pen to draw with.
-    Geometry::setPen(pen);
-
-    // Update the shape.
-    updateShape();
-}
-
-void GeometryPointShape::setBrush(const std::shared_ptr<QBrush>& brush)
-{
-    // Set the brush to draw with.
-    Geometry::setBrush(brush);
-
-    // Update the shape.
-    updateShape();
-}
-
-void GeometryPointShape::setBrush(const QBrush& brush)
-{
-    // Set the brush to draw with.
-    Geometry::setBrush(brush);
-
-    // Update the shape.
-    updateShape();
-}
-
 const QSizeF& GeometryPointShape::sizePx() const
 {
     // Return the size of the shape (pixels).
@@ -153,8 +117,34 @@ util::RectWorldCoord GeometryPointShape::boundingBox(const Viewport& viewport) c
     return util::RectWorldCoord(projection::toPointWorldCoord(viewport, top_left_point_px), projection::toPointWorldCoord(viewport, bottom_right_point_px));
 }
 
+std::size_t GeometryPointShape::memoryBytes() const
+{
+    // Return the size of the object.
+    return sizeof(GeometryPointShape);
+}
+
+void GeometryPointShape::styleChanged()
+{
+    // Generate the shape with the new pen/brush.
+    generateShape();
+}
+
 void GeometryPointShape::updateShape()
 {
+    // Generate the shape.
+    generateShape();
+
     // Emit that we need to redraw to display this change.
     emit requestRedraw();
 }
+
+void GeometryPointShape::generateShape()
+{
+    // Nothing to generate by default.
+}
+
+void GeometryPointShape::assignSizePx(const QSizeF& size_px)
+{
+    // Set the size of the shape (pixels).
+    m_size_px = size_px;
+}
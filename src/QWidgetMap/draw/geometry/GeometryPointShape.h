@@ -61,30 +61,6 @@ namespace qwm
 
             public:
 
-                /**
-                 * Sets the pen to draw the shape with (outline).
-                 * @param pen The QPen to use for drawing.
-                 */
-                void setPen(const std::shared_ptr<QPen>& pen) final;
-
-                /**
-                 * Sets the pen to draw the shape with (outline).
-                 * @param pen The QPen to use for drawing.
-                 */
-                void setPen(const QPen& pen) final;
-
-                /**
-                 * Sets the brush to draw the shape with (fill).
-                 * @param brush The QBrush to use for drawing.
-                 */
-                void setBrush(const std::shared_ptr<QBrush>& brush) final;
-
-                /**
-                 * Sets the brush to draw the shape with (fill).
-                 * @param brush The QBrush to use for drawing.
-                 */
-                void setBrush(const QBrush& brush) final;
-
                 /**
                  * Fetches the size of the shape (pixels).
                  * @return the size of the shape (pixels).
@@ -134,12 +110,34 @@ namespace qwm
                  */
                 virtual util::RectWorldCoord boundingBox(const Viewport& viewport) const override;
 
+                /**
+                 * Estimates the number of bytes used by the shape (the object).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const override;
+
             protected:
 
                 /**
-                 * Updates the shape.
+                 * Updates the shape, as the pen/brush has changed (without emitting any signals).
+                 */
+                void styleChanged() final;
+
+                /**
+                 * Updates the shape, and emits that we need to redraw to display this change.
+                 */
+                void updateShape();
+
+                /**
+                 * Generates the shape (without emitting any signals).
+                 */
+                virtual void generateShape();
+
+                /**
+                 * Sets the size of the shape (pixels), without updating the shape or emitting any signals.
+                 * @param size_px The size of the shape to set (pixels).
                  */
-                virtual void updateShape();
+                void assignSizePx(const QSizeF& size_px);
 
             private:
 
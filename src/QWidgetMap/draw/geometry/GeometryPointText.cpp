@@ -19,6 +19,7 @@
 
 // Local includes.
 #include "../../projection/Projection.h"
+#include "../../util/MemoryUsage.h"
 
 using namespace qwm;
 using namespace qwm::draw::geometry;
@@ -36,9 +37,39 @@ void GeometryPointText::draw(QPainter& painter, const util::RectWorldCoord& /*dr
     painter.setPen(pen());
     painter.setFont(font());
 
-    // Calculate the requried bounding box.
-    const QRectF bounding_rect(painter.boundingRect(QRect(), m_text.c_str()));
+    // Draw annotation text (using the cached layout, so that the text is not shaped again each frame).
+    painter.drawStaticText(qwm::projection::toPointWorldPx(viewport, coord()), textLayout());
+}
+
+QRectF GeometryPointText::textRectPx(const Viewport& viewport) const
+{
+    // Return the text rect at the point.
+    return QRectF(qwm::projection::toPointWorldPx(viewport, coord()), textLayout().size());
+}
+
+std::size_t GeometryPointText::memoryBytes() const
+{
+    // Gain a lock to protect the text layout.
+    QMutexLocker locker(&m_text_layout_mutex);
+
+    // Return the size of the object, its text and its text layout.
+    return sizeof(GeometryPointText) + m_text.capacity() + util::MemoryUsage::staticTextBytes(m_text_layout);
+}
+
+QStaticText GeometryPointText::textLayout() const
+{
+    // Gain a lock to protect the text layout.
+    QMutexLocker locker(&m_text_layout_mutex);
+
+    // Does the text need to be laid out (first use, or the font has changed)?
+    if(m_text_layout_valid == false || m_text_layout_font != font())
+    {
+        // Lay out the text.
+        m_text_layout_font = font();
+        m_text_layout = layoutText(QString::fromStdString(m_text), font());
+        m_text_layout_valid = true;
+    }
 
-    // Draw annotation text (using rect so that new line characters are drawn).
-    painter.drawText(QRectF(qwm::projection::toPointWorldPx(viewport, coord()), bounding_rect.size()), Qt::TextWordWrap, m_text.c_str());
+    // Return a (shallow) copy of the text layout.
+    return m_text_layout;
 }
@@ -68,11 +68,44 @@ namespace qwm
                  */
                 void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
 
+                /**
+                 * Fetches the rect that the text occupies, used to declutter the text against labels.
+                 * @param viewport The current viewport to use.
+                 * @return the text rect in world pixels.
+                 */
+                QRectF textRectPx(const Viewport& viewport) const final;
+
+                /**
+                 * Estimates the number of bytes used by the text point (the object, its text and its text layout).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
+            private:
+
+                /**
+                 * Fetches the text layout (the text is laid out once, and again only when the font changes).
+                 * @return the text layout.
+                 */
+                QStaticText textLayout() const;
+
             private:
 
                 /// Text to be drawn.
                 const std::string m_text;
 
+                /// Mutex to protect the text layout.
+                mutable QMutex m_text_layout_mutex;
+
+                /// Whether the text layout is valid.
+                mutable bool m_text_layout_valid { false };
+
+                /// The font that the text has been laid out with.
+                mutable QFont m_text_layout_font;
+
+                /// The text layout.
+                mutable QStaticText m_text_layout;
+
             };
 
         }
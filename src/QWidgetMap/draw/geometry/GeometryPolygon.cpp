@@ -17,9 +17,6 @@
 
 #include "GeometryPolygon.h"
 
-// Local includes.
-#include "../../projection/Projection.h"
-
 using namespace qwm;
 using namespace qwm::draw::geometry;
 
@@ -27,30 +24,20 @@ GeometryPolygon::GeometryPolygon(const std::vector<util::PointWorldCoord>& point
     : GeometryFixed(GeometryType::GeometryPolygon, parent),
       m_points(points)
 {
-    // Pre-calculate the QPolygonF and bounding box.
-
-    // Loop through each point to add to the polygon.
-    m_qpolygonf.clear();
-    for(const auto& point : m_points)
-    {
-        // Add the point to be drawn.
-        m_qpolygonf.append(point);
-    }
-
     // Calculate the bounding box.
-    m_bounding_box_fixed = util::RectWorldCoord::fromQRectF(m_qpolygonf.boundingRect());
+    m_bounding_box_fixed = util::RectWorldCoord::fromQRectF(m_points.boundingRect());
 }
 
-std::vector<util::PointWorldCoord> GeometryPolygon::points() const
+const util::VertexBuffer& GeometryPolygon::points() const
 {
     // Return the points.
     return m_points;
 }
 
-const QPolygonF& GeometryPolygon::toQPolygonF() const
+QPolygonF GeometryPolygon::toQPolygonF() const
 {
     // Return the QPolygonF.
-    return m_qpolygonf;
+    return m_points.toQPolygonF();
 }
 
 const util::RectWorldCoord& GeometryPolygon::boundingBoxFixed() const
@@ -92,6 +79,22 @@ bool GeometryPolygon::touches(const Geometry& geometry, const Viewport& viewport
                 // Finished.
                 break;
             }
+            case GeometryType::GeometryMultiLineString:
+            {
+                // Set touches response based on multi line string vs polygon check.
+                return_touches = geometry.touches(*this, viewport);
+
+                // Finished.
+                break;
+            }
+            case GeometryType::GeometryMultiPolygon:
+            {
+                // Set touches response based on multi polygon vs polygon check.
+                return_touches = geometry.touches(*this, viewport);
+
+                // Finished.
+                break;
+            }
             case GeometryType::GeometryPoint:
             {
                 // They have touched if the polygons intersect (point/widget polygon is its bounding box).
@@ -115,17 +118,10 @@ bool GeometryPolygon::touches(const Geometry& geometry, const Viewport& viewport
     return return_touches;
 }
 
-void GeometryPolygon::draw(QPainter& painter, const util::RectWorldCoord& /*drawing_rect_world_coord*/, const Viewport& viewport) const
+void GeometryPolygon::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
 {
-    // Create a polygon of the points.
-    QPolygonF polygon;
-
-    // Loop through each point to add to the polygon.
-    for(const auto& point : m_points)
-    {
-        // Add the point to be drawn.
-        polygon.append(projection::toPointWorldPx(viewport, point));
-    }
+    // Create a polygon of the visible points, simplified for the current zoom (in the drawing thread's scratch buffers).
+    const std::vector<QPointF>& polygon_px(clippedPolygonPx(m_points, drawing_rect_world_coord, viewport));
 
     // Set the pen to use.
     painter.setPen(pen());
@@ -134,5 +130,11 @@ void GeometryPolygon::draw(QPainter& painter, const util::RectWorldCoord& /*draw
     painter.setBrush(brush());
 
     // Draw the polygon line.
-    painter.drawPolygon(polygon);
+    painter.drawPolygon(polygon_px.data(), int(polygon_px.size()));
+}
+
+std::size_t GeometryPolygon::memoryBytes() const
+{
+    // Return the size of the object, its vertices and its cached simplifications.
+    return sizeof(GeometryPolygon) + m_points.memoryBytes() + simplifiedIndicesMemoryBytes();
 }
@@ -22,6 +22,7 @@
 
 // Local includes.
 #include "../../qwidgetmap_global.h"
+#include "../../util/VertexBuffer.h"
 #include "GeometryFixed.h"
 
 /// QWidgetMap namespace.
@@ -67,13 +68,13 @@ namespace qwm
                  * Fetches the list of points that form the polygon (world coordinates).
                  * @return the list of points that form the polygon (world coordinates).
                  */
-                std::vector<util::PointWorldCoord> points() const;
+                const util::VertexBuffer& points() const;
 
                 /**
-                 * Fetches the QPolygonF representation of the polygon.
+                 * Fetches the QPolygonF representation of the polygon (created from the points each call).
                  * @return the QPolygonF representation of the polygon.
                  */
-                const QPolygonF& toQPolygonF() const;
+                QPolygonF toQPolygonF() const;
 
             public:
 
@@ -108,13 +109,16 @@ namespace qwm
                  */
                 void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
 
+                /**
+                 * Estimates the number of bytes used by the polygon (the object, its vertices and its cached simplifications).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
             private:
 
                 /// The points that the polygon is made up of.
-                std::vector<util::PointWorldCoord> m_points;
-
-                /// The QPolygonF structure of the polygon points (calcualted on construction).
-                QPolygonF m_qpolygonf;
+                util::VertexBuffer m_points;
 
                 /// The fixed bounding box (calcualted on construction).
                 util::RectWorldCoord m_bounding_box_fixed { util::PointWorldCoord { 0.0, 0.0 }, util::PointWorldCoord { 0.0, 0.0 } };
@@ -24,8 +24,12 @@
 // GDAL includes.
 #include <gdal/ogrsf_frmts.h>
 
+// STL includes.
+#include <algorithm>
+
 // Local includes.
 #include "../../projection/Projection.h"
+#include "../../util/ScratchBuffers.h"
 
 using namespace qwm;
 using namespace qwm::draw::other;
@@ -56,6 +60,34 @@ namespace
         // Return the valid layer names.
         return return_layer_names;
     }
+
+    /**
+     * Projects the points of a line string/ring into world pixels.
+     * @param ogr_line_string The line string/ring to project.
+     * @param viewport The viewport to project the points for.
+     * @return the projected points, held in the drawing thread's scratch buffers (valid until the next line string/ring is projected).
+     */
+    const std::vector<QPointF>& toPointsPx(const OGRLineString& ogr_line_string, const qwm::Viewport& viewport)
+    {
+        // Fetch the scratch buffer, sized once up front for the points.
+        std::vector<QPointF>& return_points_px(qwm::util::ScratchBuffers::local().pointsPx(std::size_t(std::max(ogr_line_string.getNumPoints(), 0))));
+
+        // Prepare storage for point.
+        OGRPoint ogr_point;
+
+        // Loop through the points.
+        for(int i = 0; i < ogr_line_string.getNumPoints(); ++i)
+        {
+            // Fetch the point.
+            ogr_line_string.getPoint(i, &ogr_point);
+
+            // Add the point to be drawn.
+            return_points_px.push_back(qwm::projection::toPointWorldPx(viewport, qwm::util::PointWorldCoord(ogr_point.getX(), ogr_point.getY())));
+        }
+
+        // Return the projected points.
+        return return_points_px;
+    }
 }
 
 ESRIShapefile::ESRIShapefile(const std::string& file_path, const std::vector<std::string>& layer_names, QObject* parent)
@@ -70,6 +102,26 @@ ESRIShapefile::ESRIShapefile(const std::string& file_path, const std::vector<std
     {
         // Open the file.
         m_ogr_data_set = OGRSFDriverRegistrar::Open(file_path.c_str(), FALSE);
+
+        // Do we have a data set open?
+        if(m_ogr_data_set != nullptr)
+        {
+            // Count the features in the layers drawn (all layers if no layer names are given).
+            for(int i = 0; i < m_ogr_data_set->GetLayerCount(); ++i)
+            {
+                // Get layer (and check that it is drawn).
+                const auto ogr_layer(m_ogr_data_set->GetLayer(i));
+                if(ogr_layer != nullptr && (m_ogr_layer_names.empty() || std::find(m_ogr_layer_names.begin(), m_ogr_layer_names.end(), std::string(ogr_layer->GetName())) != m_ogr_layer_names.end()))
+                {
+                    // Fetch the feature count (-1 if it is unknown).
+                    const auto feature_count(ogr_layer->GetFeatureCount());
+                    if(feature_count > 0)
+                    {
+                        m_ogr_feature_count += std::size_t(feature_count);
+                    }
+                }
+            }
+        }
     }
     else
     {
@@ -256,6 +308,23 @@ void ESRIShapefile::draw(QPainter& painter, const util::RectWorldCoord& drawing_
     }
 }
 
+std::size_t ESRIShapefile::memoryBytes() const
+{
+    // Add the layer names and styles to the size of the object.
+    std::size_t return_bytes(sizeof(ESRIShapefile));
+    for(const auto& ogr_layer_name : m_ogr_layer_names)
+    {
+        return_bytes += sizeof(std::string) + ogr_layer_name.capacity();
+    }
+    return_bytes += (m_pen_polygon != nullptr ? sizeof(QPen) : 0) + (m_brush_polygon != nullptr ? sizeof(QBrush) : 0) + (m_pen_linestring != nullptr ? sizeof(QPen) : 0);
+
+    // Add the OGR data set (features are read from the file on demand, but the record offsets/sizes are held in memory).
+    return_bytes += m_ogr_feature_count * 8;
+
+    // Return the estimated number of bytes.
+    return return_bytes;
+}
+
 void ESRIShapefile::drawFeature(OGRFeature* ogr_feature, QPainter& painter, const Viewport& viewport) const
 {
     // Fetch geometries.
@@ -278,21 +347,8 @@ void ESRIShapefile::drawFeature(OGRFeature* ogr_feature, QPainter& painter, cons
         }
         else
         {
-            // Prepare storage for point.
-            OGRPoint ogr_point;
-
-            // Create a polygon of the points.
-            QPolygonF polygon_px;
-
-            // Loop through the points.
-            for(int i = 0; i < ogr_exterior_ring->getNumPoints(); ++i)
-            {
-                // Fetch the point.
-                ogr_exterior_ring->getPoint(i, &ogr_point);
-
-                // Add the point to be drawn.
-                polygon_px.append(projection::toPointWorldPx(viewport, util::PointWorldCoord(ogr_point.getX(), ogr_point.getY())));
-            }
+            // Create a polygon of the points (in the drawing thread's scratch buffers).
+            const std::vector<QPointF>& polygon_px(toPointsPx(*ogr_exterior_ring, viewport));
 
             // Set the pen to use.
             painter.setPen(penPolygon());
@@ -301,7 +357,7 @@ void ESRIShapefile::drawFeature(OGRFeature* ogr_feature, QPainter& painter, cons
             painter.setBrush(brushPolygon());
 
             // Draw the polygon line.
-            painter.drawPolygon(polygon_px);
+            painter.drawPolygon(polygon_px.data(), int(polygon_px.size()));
         }
     }
     else if(wkbFlatten(ogr_geometry->getGeometryType()) == wkbMultiPolygon)
@@ -328,21 +384,8 @@ void ESRIShapefile::drawFeature(OGRFeature* ogr_feature, QPainter& painter, cons
                 }
                 else
                 {
-                    // Prepare storage for point.
-                    OGRPoint ogr_point;
-
-                    // Create a polygon of the points.
-                    QPolygonF polygon_px;
-
-                    // Loop through the points.
-                    for(int i = 0; i < ogr_exterior_ring->getNumPoints(); ++i)
-                    {
-                        // Fetch the point.
-                        ogr_exterior_ring->getPoint(i, &ogr_point);
-
-                        // Add the point to be drawn.
-                        polygon_px.append(projection::toPointWorldPx(viewport, util::PointWorldCoord(ogr_point.getX(), ogr_point.getY())));
-                    }
+                    // Create a polygon of the points (in the drawing thread's scratch buffers).
+                    const std::vector<QPointF>& polygon_px(toPointsPx(*ogr_exterior_ring, viewport));
 
                     // Set the pen to use.
                     painter.setPen(penPolygon());
@@ -351,7 +394,7 @@ void ESRIShapefile::drawFeature(OGRFeature* ogr_feature, QPainter& painter, cons
                     painter.setBrush(brushPolygon());
 
                     // Draw the polygon line.
-                    painter.drawPolygon(polygon_px);
+                    painter.drawPolygon(polygon_px.data(), int(polygon_px.size()));
                 }
             }
         }
@@ -361,26 +404,13 @@ void ESRIShapefile::drawFeature(OGRFeature* ogr_feature, QPainter& painter, cons
         // Cast to a line string.
         const auto ogr_line_string(static_cast<OGRLineString*>(ogr_geometry));
 
-        // Prepare storage for point.
-        OGRPoint ogr_point;
-
-        // Create a polygon of the points.
-        QPolygonF polygon_line_px;
-
-        // Loop through the points.
-        for(int i = 0; i < ogr_line_string->getNumPoints(); ++i)
-        {
-            // Fetch the point.
-            ogr_line_string->getPoint(i, &ogr_point);
-
-            // Add the point to be drawn.
-            polygon_line_px.append(projection::toPointWorldPx(viewport, util::PointWorldCoord(ogr_point.getX(), ogr_point.getY())));
-        }
+        // Create a polygon line of the points (in the drawing thread's scratch buffers).
+        const std::vector<QPointF>& polygon_line_px(toPointsPx(*ogr_line_string, viewport));
 
         // Set the pen to use.
         painter.setPen(penLineString());
 
         // Draw the polygon line.
-        painter.drawPolyline(polygon_line_px);
+        painter.drawPolyline(polygon_line_px.data(), int(polygon_line_px.size()));
     }
 }
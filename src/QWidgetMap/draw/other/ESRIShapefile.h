@@ -22,6 +22,7 @@
 #include <QtGui/QPen>
 
 // STL includes.
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -145,6 +146,12 @@ namespace qwm
                  */
                 void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
 
+                /**
+                 * Estimates the number of bytes used by the ESRI Shapefile (the object, its styles and an estimate of the OGR data set's record index).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
             protected:
 
                 /**
@@ -163,6 +170,9 @@ namespace qwm
                 /// The OGR layer names.
                 std::vector<std::string> m_ogr_layer_names;
 
+                /// The number of features in the OGR layers drawn (counted when the data set is opened).
+                std::size_t m_ogr_feature_count { 0 };
+
                 /// The pen to use when drawing a polygon.
                 mutable std::shared_ptr<QPen> m_pen_polygon;
 
@@ -0,0 +1,626 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Heatmap.h"
+
+// Qt includes.
+#include <QtGui/QPainter>
+
+// STL includes.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+// Local includes.
+#include "../../projection/Projection.h"
+
+using namespace qwm;
+using namespace qwm::draw::other;
+
+namespace
+{
+    /**
+     * Runs a function over a range, split into contiguous chunks across the available hardware threads.
+     * @param count The size of the range.
+     * @param minimum_chunk The minimum size of each chunk (smaller ranges are run on the calling thread).
+     * @param function The function to run for each chunk (chunk index, begin, end).
+     * @param maximum_chunks The maximum number of chunks to split the range into.
+     * @return the number of chunks the range was split into.
+     */
+    std::size_t parallelFor(const std::size_t& count, const std::size_t& minimum_chunk, const std::function<void(std::size_t, std::size_t, std::size_t)>& function, const std::size_t& maximum_chunks = std::numeric_limits<std::size_t>::max())
+    {
+        // Calculate how many chunks to split the range into.
+        const std::size_t chunks(std::max(std::size_t(1), std::min(std::min(std::size_t(std::max(1u, std::thread::hardware_concurrency())), maximum_chunks), count / std::max(std::size_t(1), minimum_chunk))));
+
+        // Is it worth using threads?
+        if(chunks == 1)
+        {
+            // Run the whole range on this thread.
+            function(0, 0, count);
+        }
+        else
+        {
+            // Run each chunk after the first on its own thread (the first chunk is run on this thread).
+            std::vector<std::thread> threads;
+            threads.reserve(chunks - 1);
+            try
+            {
+                for(std::size_t c = 1; c < chunks; ++c)
+                {
+                    threads.emplace_back(function, c, (count * c) / chunks, (count * (c + 1)) / chunks);
+                }
+            }
+            catch(const std::system_error&)
+            {
+                // Unable to start another thread, the remaining chunks are run on this thread below.
+            }
+
+            // Run the first chunk, and each chunk that could not be run on its own thread.
+            function(0, 0, count / chunks);
+            for(std::size_t c = threads.size() + 1; c < chunks; ++c)
+            {
+                function(c, (count * c) / chunks, (count * (c + 1)) / chunks);
+            }
+
+            // Wait for the chunks to finish.
+            for(auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // Return the number of chunks.
+        return chunks;
+    }
+
+    /**
+     * Blurs the rows of a grid with a 1D kernel (the grid is transposed by the caller to blur the columns).
+     * @param grid The grid to blur.
+     * @param width The width of the grid.
+     * @param height The height of the grid.
+     * @param kernel The kernel to blur with (odd length, centered).
+     * @return the blurred grid.
+     */
+    std::vector<float> blurRows(const std::vector<float>& grid, const std::size_t& width, const std::size_t& height, const std::vector<float>& kernel)
+    {
+        // The blurred grid.
+        std::vector<float> return_grid(grid.size(), 0.0f);
+
+        // Blur the rows (each row is independent, so they are split across threads).
+        const int kernel_radius(int(kernel.size() / 2));
+        parallelFor(height, 64, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            // Blur each row in the chunk.
+            for(std::size_t y = begin; y < end; ++y)
+            {
+                // Fetch the row to read from and write to.
+                const float* row_in(grid.data() + y * width);
+                float* row_out(return_grid.data() + y * width);
+
+                // Accumulate each kernel tap across the whole row (the inner loop is contiguous, so the compiler can vectorise it).
+                for(int k = -kernel_radius; k <= kernel_radius; ++k)
+                {
+                    const float weight(kernel.at(std::size_t(k + kernel_radius)));
+                    const std::size_t x_begin(std::size_t(std::max(0, -k)));
+                    const std::size_t x_end(std::size_t(std::max(0, int(width) - std::max(0, k))));
+                    for(std::size_t x = x_begin; x < x_end; ++x)
+                    {
+                        row_out[x] += weight * row_in[std::size_t(int(x) + k)];
+                    }
+                }
+            }
+        });
+
+        // Return the blurred grid.
+        return return_grid;
+    }
+
+    /**
+     * Transposes a grid.
+     * @param grid The grid to transpose.
+     * @param width The width of the grid.
+     * @param height The height of the grid.
+     * @return the transposed grid.
+     */
+    std::vector<float> transpose(const std::vector<float>& grid, const std::size_t& width, const std::size_t& height)
+    {
+        // The transposed grid.
+        std::vector<float> return_grid(grid.size());
+
+        // Copy each cell into its transposed position.
+        for(std::size_t y = 0; y < height; ++y)
+        {
+            for(std::size_t x = 0; x < width; ++x)
+            {
+                return_grid[x * height + y] = grid[y * width + x];
+            }
+        }
+
+        // Return the transposed grid.
+        return return_grid;
+    }
+}
+
+Heatmap::Heatmap(const std::vector<util::PointWorldCoord>& points, QObject* parent)
+    : Drawable(DrawableType::Heatmap, parent),
+      m_points(std::make_shared<const std::vector<util::PointWorldCoord>>(points))
+{
+    // Set the default colour ramp (transparent blue through to red).
+    setColourStops(QGradientStops
+    {
+        QGradientStop(0.0, QColor(0, 0, 255, 0)),
+        QGradientStop(0.25, QColor(0, 0, 255, 160)),
+        QGradientStop(0.5, QColor(0, 255, 255, 200)),
+        QGradientStop(0.75, QColor(255, 255, 0, 220)),
+        QGradientStop(1.0, QColor(255, 0, 0, 240))
+    });
+}
+
+std::size_t Heatmap::pointCount() const
+{
+    // Gain a lock to protect the points.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the number of points.
+    return m_points->size();
+}
+
+void Heatmap::setPoints(const std::vector<util::PointWorldCoord>& points)
+{
+    {
+        // Gain a lock to protect the points.
+        QMutexLocker locker(&m_mutex);
+
+        // Set the points (and invalidate the caches).
+        m_points = std::make_shared<const std::vector<util::PointWorldCoord>>(points);
+        ++m_points_generation;
+        ++m_generation;
+    }
+
+    // Emit that we need to redraw to display this change.
+    emit requestRedraw();
+}
+
+qreal Heatmap::radiusPx() const
+{
+    // Gain a lock to protect the settings.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the radius of the Gaussian kernel.
+    return m_radius_px;
+}
+
+void Heatmap::setRadiusPx(const qreal& radius_px)
+{
+    {
+        // Gain a lock to protect the settings.
+        QMutexLocker locker(&m_mutex);
+
+        // Set the radius of the Gaussian kernel (and invalidate the caches).
+        m_radius_px = radius_px;
+        ++m_generation;
+    }
+
+    // Emit that we need to redraw to display this change.
+    emit requestRedraw();
+}
+
+qreal Heatmap::cellSizePx() const
+{
+    // Gain a lock to protect the settings.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the size of each density grid cell.
+    return m_cell_size_px;
+}
+
+void Heatmap::setCellSizePx(const qreal& cell_size_px)
+{
+    {
+        // Gain a lock to protect the settings.
+        QMutexLocker locker(&m_mutex);
+
+        // Set the size of each density grid cell (and invalidate the caches).
+        m_cell_size_px = std::max(cell_size_px, 1.0);
+        ++m_generation;
+    }
+
+    // Emit that we need to redraw to display this change.
+    emit requestRedraw();
+}
+
+QGradientStops Heatmap::colourStops() const
+{
+    // Gain a lock to protect the settings.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the colour ramp stops.
+    return m_colour_stops;
+}
+
+void Heatmap::setColourStops(const QGradientStops& colour_stops)
+{
+    {
+        // Gain a lock to protect the settings.
+        QMutexLocker locker(&m_mutex);
+
+        // Set the colour ramp stops and lookup table (and invalidate the caches).
+        m_colour_stops = colour_stops;
+        m_colour_ramp = colourRamp(colour_stops);
+        ++m_generation;
+    }
+
+    // Emit that we need to redraw to display this change.
+    emit requestRedraw();
+}
+
+qreal Heatmap::densityMaximum() const
+{
+    // Gain a lock to protect the settings.
+    QMutexLocker locker(&m_mutex);
+
+    // Return the density maximum.
+    return m_density_maximum;
+}
+
+void Heatmap::setDensityMaximum(const qreal& density_maximum)
+{
+    {
+        // Gain a lock to protect the settings.
+        QMutexLocker locker(&m_mutex);
+
+        // Set the density maximum (and invalidate the caches).
+        m_density_maximum = std::max(density_maximum, 0.0);
+        ++m_generation;
+    }
+
+    // Emit that we need to redraw to display this change.
+    emit requestRedraw();
+}
+
+void Heatmap::draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const
+{
+    // Calculate the drawing rect in world pixels.
+    const QRectF drawing_rect_px(QRectF(projection::toPointWorldPx(viewport, drawing_rect_world_coord.topLeftCoord()), projection::toPointWorldPx(viewport, drawing_rect_world_coord.bottomRightCoord())).normalized());
+
+    // Take a copy of the points and settings (so that the heatmap can be rendered without holding the lock).
+    bool cached(false);
+    std::shared_ptr<const std::vector<util::PointWorldCoord>> points;
+    std::size_t points_generation(0);
+    std::size_t generation(0);
+    qreal radius_px(0.0);
+    qreal cell_size_px(0.0);
+    qreal density_maximum(0.0);
+    std::vector<QRgb> colour_ramp;
+    {
+        // Gain a lock to protect the points, settings and caches.
+        QMutexLocker locker(&m_mutex);
+
+        // Is the cached heatmap image still valid for the drawing rect?
+        const std::pair<int, int> key(projection::epsgNumber(viewport), viewport.zoom());
+        if(m_cached_generation == m_generation && m_cached_key == key && m_cached_rect_px.contains(drawing_rect_px) && m_cached_image.isNull() == false)
+        {
+            // Draw the cached heatmap image.
+            painter.drawImage(m_cached_rect_px, m_cached_image);
+            cached = true;
+        }
+        else
+        {
+            // Take the copies.
+            points = m_points;
+            points_generation = m_points_generation;
+            generation = m_generation;
+            radius_px = m_radius_px;
+            cell_size_px = m_cell_size_px;
+            density_maximum = m_density_maximum;
+            colour_ramp = m_colour_ramp;
+        }
+    }
+
+    // Do we need to render the heatmap?
+    if(cached == false)
+    {
+        // Render a margin around the drawing rect, so that the heatmap can be re-used whilst panning.
+        const QRectF rect_px(drawing_rect_px.adjusted(-drawing_rect_px.width() / 4.0, -drawing_rect_px.height() / 4.0, drawing_rect_px.width() / 4.0, drawing_rect_px.height() / 4.0));
+
+        // Fetch the projected points, and the automatic density maximum (if required).
+        const auto points_px(pointsPx(points, points_generation, viewport));
+        if(density_maximum <= 0.0)
+        {
+            density_maximum = automaticDensityMaximum(*points_px, generation, radius_px, viewport);
+        }
+
+        // Render the heatmap image.
+        const QImage image(render(*points_px, rect_px, radius_px, cell_size_px, density_maximum, colour_ramp));
+
+        // Draw the heatmap image.
+        painter.drawImage(rect_px, image);
+
+        // Gain a lock to protect the caches.
+        QMutexLocker locker(&m_mutex);
+
+        // Cache the heatmap image (if the points/settings have not changed whilst rendering).
+        if(generation == m_generation)
+        {
+            m_cached_image = image;
+            m_cached_rect_px = rect_px;
+            m_cached_key = std::make_pair(projection::epsgNumber(viewport), viewport.zoom());
+            m_cached_generation = generation;
+        }
+    }
+}
+
+std::size_t Heatmap::memoryBytes() const
+{
+    // Gain a lock to protect the heatmap's points, settings and caches.
+    QMutexLocker locker(&m_mutex);
+
+    // Add the points and colour ramp to the size of the object.
+    std::size_t return_bytes(sizeof(Heatmap));
+    return_bytes += m_points->capacity() * sizeof(util::PointWorldCoord);
+    return_bytes += m_colour_ramp.capacity() * sizeof(QRgb);
+
+    // Add the projected points of each zoom.
+    for(const auto& points_px : m_points_px)
+    {
+        return_bytes += sizeof(decltype(m_points_px)::value_type) + (4 * sizeof(void*)) + (points_px.second->capacity() * sizeof(double));
+    }
+
+    // Add the cached heatmap image.
+    return_bytes += std::size_t(m_cached_image.bytesPerLine()) * std::size_t(m_cached_image.height());
+
+    // Return the estimated number of bytes.
+    return return_bytes;
+}
+
+std::shared_ptr<const std::vector<double>> Heatmap::pointsPx(const std::shared_ptr<const std::vector<util::PointWorldCoord>>& points, const std::size_t& points_generation, const Viewport& viewport) const
+{
+    // Fetch the projected points for this projection/zoom.
+    const std::pair<int, int> key(projection::epsgNumber(viewport), viewport.zoom());
+    {
+        // Gain a lock to protect the caches.
+        QMutexLocker locker(&m_mutex);
+
+        // Have the points changed since they were last projected?
+        if(m_points_px_generation != points_generation)
+        {
+            // Clear the projected points.
+            m_points_px.clear();
+            m_points_px_generation = points_generation;
+        }
+
+        // Have the points already been projected?
+        const auto itr_find(m_points_px.find(key));
+        if(itr_find != m_points_px.end())
+        {
+            // Return the projected points.
+            return itr_find->second;
+        }
+    }
+
+    // Project the points (split across threads, as projection is expensive for millions of points).
+    auto points_px(std::make_shared<std::vector<double>>(points->size() * 2));
+    parallelFor(points->size(), 50000, [&](std::size_t, std::size_t begin, std::size_t end)
+    {
+        // Project each point in the chunk.
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            const util::PointWorldPx point_px(projection::toPointWorldPx(viewport, points->at(i)));
+            (*points_px)[i * 2] = point_px.x();
+            (*points_px)[i * 2 + 1] = point_px.y();
+        }
+    });
+
+    // Gain a lock to protect the caches.
+    QMutexLocker locker(&m_mutex);
+
+    // Cache the projected points (if the points have not changed whilst projecting).
+    if(m_points_px_generation == points_generation)
+    {
+        // Bound the memory used by the cache (each zoom holds a copy of every point).
+        if(m_points_px.size() >= 4)
+        {
+            m_points_px.clear();
+        }
+        m_points_px[key] = points_px;
+    }
+
+    // Return the projected points.
+    return points_px;
+}
+
+qreal Heatmap::automaticDensityMaximum(const std::vector<double>& points_px, const std::size_t& generation, const qreal& radius_px, const Viewport& viewport) const
+{
+    // Has the automatic density maximum already been calculated for this projection/zoom?
+    const std::pair<int, int> key(projection::epsgNumber(viewport), viewport.zoom());
+    {
+        // Gain a lock to protect the caches.
+        QMutexLocker locker(&m_mutex);
+
+        // Return the cached automatic density maximum.
+        if(m_automatic_density_maximum_generation == generation && m_automatic_density_maximum_key == key)
+        {
+            return m_automatic_density_maximum;
+        }
+    }
+
+    // Count the points that fall within each kernel radius sized cell (only occupied cells are stored).
+    const double cell_size_px(std::max(radius_px, 1.0));
+    std::unordered_map<std::uint64_t, std::size_t> cell_counts;
+    std::size_t count_maximum(0);
+    for(std::size_t i = 0; i + 1 < points_px.size(); i += 2)
+    {
+        const std::uint64_t cell_x(std::uint32_t(std::int64_t(std::floor(points_px[i] / cell_size_px))));
+        const std::uint64_t cell_y(std::uint32_t(std::int64_t(std::floor(points_px[i + 1] / cell_size_px))));
+        count_maximum = std::max(count_maximum, ++cell_counts[(cell_x << 32) | cell_y]);
+    }
+
+    // Gain a lock to protect the caches.
+    QMutexLocker locker(&m_mutex);
+
+    // Cache the automatic density maximum (if the points/settings have not changed whilst calculating).
+    if(generation == m_generation)
+    {
+        m_automatic_density_maximum = qreal(count_maximum);
+        m_automatic_density_maximum_key = key;
+        m_automatic_density_maximum_generation = generation;
+    }
+
+    // Return the automatic density maximum.
+    return qreal(count_maximum);
+}
+
+QImage Heatmap::render(const std::vector<double>& points_px, const QRectF& rect_px, const qreal& radius_px, const qreal& cell_size_px, const qreal& density_maximum, const std::vector<QRgb>& colour_ramp)
+{
+    // Calculate the Gaussian kernel (in grid cells, truncated at 3 standard deviations).
+    const double sigma_cells(std::max(radius_px / cell_size_px, 0.5));
+    const int kernel_radius(int(std::ceil(sigma_cells * 3.0)));
+    std::vector<float> kernel;
+    float kernel_sum(0.0f);
+    for(int k = -kernel_radius; k <= kernel_radius; ++k)
+    {
+        kernel.push_back(float(std::exp(-(k * k) / (2.0 * sigma_cells * sigma_cells))));
+        kernel_sum += kernel.back();
+    }
+    for(auto& weight : kernel)
+    {
+        weight /= kernel_sum;
+    }
+
+    // Calculate the grid, which is padded by the kernel radius so that points just outside the rect still contribute.
+    const std::size_t image_width(std::size_t(std::max(1.0, std::ceil(rect_px.width() / cell_size_px))));
+    const std::size_t image_height(std::size_t(std::max(1.0, std::ceil(rect_px.height() / cell_size_px))));
+    const std::size_t grid_width(image_width + std::size_t(kernel_radius) * 2);
+    const std::size_t grid_height(image_height + std::size_t(kernel_radius) * 2);
+    const double grid_left_px(rect_px.left() - kernel_radius * cell_size_px);
+    const double grid_top_px(rect_px.top() - kernel_radius * cell_size_px);
+
+    // Accumulate the points into a partial grid per thread (so no locking is required), then sum the partial grids.
+    // The number of threads is capped so that the partial grids stay within a memory budget (32 MB) for large grids.
+    const std::size_t point_count(points_px.size() / 2);
+    const std::size_t partial_grids_maximum(std::max(std::size_t(1), (std::size_t(32) * 1024 * 1024) / std::max(std::size_t(1), grid_width * grid_height * sizeof(float))));
+    std::vector<std::vector<float>> partial_grids(std::min(std::size_t(std::max(1u, std::thread::hardware_concurrency())), partial_grids_maximum));
+    const std::size_t chunks(parallelFor(point_count, 100000, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        // Clear the chunk's partial grid.
+        std::vector<float>& partial_grid(partial_grids.at(chunk));
+        partial_grid.assign(grid_width * grid_height, 0.0f);
+        // Add each point in the chunk to the cell it lands in.
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            const double x((points_px[i * 2] - grid_left_px) / cell_size_px);
+            const double y((points_px[i * 2 + 1] - grid_top_px) / cell_size_px);
+            if(x >= 0.0 && y >= 0.0 && x < double(grid_width) && y < double(grid_height))
+            {
+                partial_grid[std::size_t(y) * grid_width + std::size_t(x)] += 1.0f;
+            }
+        }
+    }, partial_grids.size()));
+    std::vector<float> grid(std::move(partial_grids.front()));
+    for(std::size_t c = 1; c < chunks; ++c)
+    {
+        const std::vector<float>& partial_grid(partial_grids.at(c));
+        for(std::size_t i = 0; i < grid.size(); ++i)
+        {
+            grid[i] += partial_grid[i];
+        }
+    }
+
+    // Blur the grid (rows, then columns via a transpose, as the Gaussian kernel is separable).
+    grid = blurRows(grid, grid_width, grid_height, kernel);
+    grid = transpose(blurRows(transpose(grid, grid_width, grid_height), grid_height, grid_width, kernel), grid_height, grid_width);
+
+    // Calculate the grid density of the density maximum, as the peak of that many points stacked on the same spot (the
+    // kernel's centre weight squared). This does not depend on the rect, so the colours are stable whilst panning.
+    const float kernel_centre(kernel.at(std::size_t(kernel_radius)));
+    const float grid_density_maximum(float(density_maximum) * kernel_centre * kernel_centre);
+
+    // Colour the image using the colour ramp.
+    QImage return_image(int(image_width), int(image_height), QImage::Format_ARGB32);
+    return_image.fill(Qt::transparent);
+    if(grid_density_maximum > 0.0f && colour_ramp.empty() == false)
+    {
+        const float scale(float(colour_ramp.size() - 1) / grid_density_maximum);
+        for(std::size_t y = 0; y < image_height; ++y)
+        {
+            const float* row(grid.data() + (y + std::size_t(kernel_radius)) * grid_width + std::size_t(kernel_radius));
+            QRgb* scan_line(reinterpret_cast<QRgb*>(return_image.scanLine(int(y))));
+            for(std::size_t x = 0; x < image_width; ++x)
+            {
+                // Leave empty cells transparent.
+                if(row[x] > 0.0f)
+                {
+                    scan_line[x] = colour_ramp[std::min(colour_ramp.size() - 1, std::size_t(row[x] * scale))];
+                }
+            }
+        }
+    }
+
+    // Return the heatmap image.
+    return return_image;
+}
+
+std::vector<QRgb> Heatmap::colourRamp(const QGradientStops& colour_stops)
+{
+    // The colour ramp lookup table.
+    std::vector<QRgb> return_colour_ramp;
+
+    // Check we have colour stops.
+    if(colour_stops.isEmpty() == false)
+    {
+        // Sort the colour stops by position.
+        std::vector<QGradientStop> stops(colour_stops.begin(), colour_stops.end());
+        std::sort(stops.begin(), stops.end(), [](const QGradientStop& lhs, const QGradientStop& rhs) { return lhs.first < rhs.first; });
+
+        // Loop through each lookup table entry.
+        for(int i = 0; i < 256; ++i)
+        {
+            // Find the colour stops either side of the entry's position.
+            const qreal position(i / 255.0);
+            const auto itr_upper(std::lower_bound(stops.begin(), stops.end(), position, [](const QGradientStop& stop, const qreal& value) { return stop.first < value; }));
+            if(itr_upper == stops.begin())
+            {
+                // Before the first colour stop.
+                return_colour_ramp.push_back(itr_upper->second.rgba());
+            }
+            else if(itr_upper == stops.end())
+            {
+                // After the last colour stop.
+                return_colour_ramp.push_back(stops.back().second.rgba());
+            }
+            else
+            {
+                // Interpolate between the colour stops.
+                const auto itr_lower(itr_upper - 1);
+                const qreal t((position - itr_lower->first) / std::max(itr_upper->first - itr_lower->first, 1e-9));
+                const auto interpolate = [t](const int& lower, const int& upper) { return int(lower + (upper - lower) * t); };
+                return_colour_ramp.push_back(qRgba(interpolate(itr_lower->second.red(), itr_upper->second.red()),
+                                                   interpolate(itr_lower->second.green(), itr_upper->second.green()),
+                                                   interpolate(itr_lower->second.blue(), itr_upper->second.blue()),
+                                                   interpolate(itr_lower->second.alpha(), itr_upper->second.alpha())));
+            }
+        }
+    }
+
+    // Return the colour ramp lookup table.
+    return return_colour_ramp;
+}
@@ -0,0 +1,263 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QMutex>
+#include <QtCore/QRectF>
+#include <QtGui/QGradient>
+#include <QtGui/QImage>
+
+// STL includes.
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Local includes.
+#include "../../qwidgetmap_global.h"
+#include "../../util/Point.h"
+#include "../../Viewport.h"
+#include "../Drawable.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Drawable namespace.
+    namespace draw
+    {
+
+        /// Other/Miscellaneous namespace.
+        namespace other
+        {
+
+            /**
+             * Implementation of the drawable heatmap item.
+             * Renders the kernel-density of a (potentially very large) set of points, rather than each point individually.
+             * The density is accumulated on a grid aligned to the drawing rect (split across threads), smoothed with a separable
+             * Gaussian blur and coloured using a colour ramp. The colour ramp is normalised against a density maximum that does not
+             * depend on the drawing rect, so colours are stable whilst panning. The projected points are cached per zoom, and the
+             * rendered grid is cached (with a margin around the drawing rect) so that panning within it does not re-render the heatmap.
+             */
+            class QWIDGETMAP_EXPORT Heatmap : public Drawable
+            {
+                Q_OBJECT
+
+            public:
+
+                /**
+                 * This is used to construct a Heatmap.
+                 * @param points The points to calculate the density of (world coordinates).
+                 * @param parent QObject parent ownership.
+                 */
+                explicit Heatmap(const std::vector<util::PointWorldCoord>& points, QObject* parent = nullptr);
+
+                /// Disable copy constructor.
+                Heatmap(const Heatmap&) = delete;
+
+                /// Disable copy assignment.
+                Heatmap& operator=(const Heatmap&) = delete;
+
+                /// Destructor.
+                virtual ~Heatmap() = default;
+
+            public:
+
+                /**
+                 * Fetches the number of points.
+                 * @return the number of points.
+                 */
+                std::size_t pointCount() const;
+
+                /**
+                 * Sets the points to calculate the density of.
+                 * @param points The points to calculate the density of (world coordinates).
+                 */
+                void setPoints(const std::vector<util::PointWorldCoord>& points);
+
+                /**
+                 * Fetches the radius (standard deviation) of the Gaussian kernel.
+                 * @return the radius of the Gaussian kernel in pixels.
+                 */
+                qreal radiusPx() const;
+
+                /**
+                 * Sets the radius (standard deviation) of the Gaussian kernel.
+                 * @param radius_px The radius of the Gaussian kernel in pixels.
+                 */
+                void setRadiusPx(const qreal& radius_px);
+
+                /**
+                 * Fetches the size of each density grid cell.
+                 * @return the size of each density grid cell in pixels.
+                 */
+                qreal cellSizePx() const;
+
+                /**
+                 * Sets the size of each density grid cell (larger cells are quicker to render, but blockier).
+                 * @param cell_size_px The size of each density grid cell in pixels.
+                 */
+                void setCellSizePx(const qreal& cell_size_px);
+
+                /**
+                 * Fetches the colour ramp stops.
+                 * @return the colour ramp stops.
+                 */
+                QGradientStops colourStops() const;
+
+                /**
+                 * Sets the colour ramp stops, used to colour the density (0.0 is the lowest density and 1.0 the highest).
+                 * @param colour_stops The colour ramp stops.
+                 */
+                void setColourStops(const QGradientStops& colour_stops);
+
+                /**
+                 * Fetches the density maximum.
+                 * @return the number of stacked points that maps to the top of the colour ramp (0 if automatic).
+                 */
+                qreal densityMaximum() const;
+
+                /**
+                 * Sets the density maximum, the number of points stacked on the same spot that maps to the top of the colour ramp.
+                 * When automatic, this is the largest number of points that fall within a kernel radius sized cell (across all
+                 * of the points at the zoom level, not just those within the drawing rect).
+                 * @param density_maximum The number of stacked points that maps to the top of the colour ramp (0 for automatic).
+                 */
+                void setDensityMaximum(const qreal& density_maximum);
+
+                /**
+                 * Draws the item to the provided painter.
+                 * @param painter The painter to draw on.
+                 * @param drawing_rect_world_coord The drawing rect in world coordinates.
+                 * @param viewport The current viewport to use.
+                 */
+                void draw(QPainter& painter, const util::RectWorldCoord& drawing_rect_world_coord, const Viewport& viewport) const final;
+
+                /**
+                 * Estimates the number of bytes used by the heatmap (the object, its points, projected points and cached image).
+                 * @return the estimated number of bytes used.
+                 */
+                std::size_t memoryBytes() const final;
+
+            private:
+
+                /**
+                 * Fetches the points projected into world pixels for the viewport's zoom.
+                 * The points are projected the first time each zoom is drawn and cached.
+                 * @param points The points to project.
+                 * @param points_generation The generation of the points.
+                 * @param viewport The viewport to project the points for.
+                 * @return the projected points, as interleaved x/y world pixels.
+                 */
+                std::shared_ptr<const std::vector<double>> pointsPx(const std::shared_ptr<const std::vector<util::PointWorldCoord>>& points, const std::size_t& points_generation, const Viewport& viewport) const;
+
+                /**
+                 * Fetches the automatic density maximum for the viewport's zoom.
+                 * This is calculated the first time each zoom is drawn (after the points/settings change) and cached.
+                 * @param points_px The projected points, as interleaved x/y world pixels.
+                 * @param generation The generation of the points/settings.
+                 * @param radius_px The radius of the Gaussian kernel in pixels.
+                 * @param viewport The viewport the points were projected for.
+                 * @return the largest number of points that fall within a kernel radius sized cell.
+                 */
+                qreal automaticDensityMaximum(const std::vector<double>& points_px, const std::size_t& generation, const qreal& radius_px, const Viewport& viewport) const;
+
+                /**
+                 * Renders the heatmap image.
+                 * @param points_px The projected points, as interleaved x/y world pixels.
+                 * @param rect_px The rect to render in world pixels.
+                 * @param radius_px The radius of the Gaussian kernel in pixels.
+                 * @param cell_size_px The size of each density grid cell in pixels.
+                 * @param density_maximum The number of stacked points that maps to the top of the colour ramp.
+                 * @param colour_ramp The colour ramp to use.
+                 * @return the heatmap image (one pixel per density grid cell).
+                 */
+                static QImage render(const std::vector<double>& points_px, const QRectF& rect_px, const qreal& radius_px, const qreal& cell_size_px, const qreal& density_maximum, const std::vector<QRgb>& colour_ramp);
+
+                /**
+                 * Calculates the colour ramp lookup table from colour stops.
+                 * @param colour_stops The colour ramp stops.
+                 * @return the colour ramp lookup table (256 entries).
+                 */
+                static std::vector<QRgb> colourRamp(const QGradientStops& colour_stops);
+
+            private:
+
+                /// Mutex to protect the heatmap's points, settings and caches.
+                mutable QMutex m_mutex;
+
+                /// The points to calculate the density of.
+                std::shared_ptr<const std::vector<util::PointWorldCoord>> m_points;
+
+                /// The generation of the points (incremented whenever they change, to invalidate the projected points).
+                std::size_t m_points_generation { 0 };
+
+                /// The generation of the points/settings (incremented whenever they change, to invalidate the heatmap image).
+                std::size_t m_generation { 0 };
+
+                /// The radius of the Gaussian kernel in pixels.
+                qreal m_radius_px { 15.0 };
+
+                /// The size of each density grid cell in pixels.
+                qreal m_cell_size_px { 2.0 };
+
+                /// The colour ramp stops.
+                QGradientStops m_colour_stops;
+
+                /// The colour ramp lookup table.
+                std::vector<QRgb> m_colour_ramp;
+
+                /// The number of stacked points that maps to the top of the colour ramp (0 if automatic).
+                qreal m_density_maximum { 0.0 };
+
+                /// The cached automatic density maximum.
+                mutable qreal m_automatic_density_maximum { 0.0 };
+
+                /// The projection (epsg number) and zoom of the cached automatic density maximum.
+                mutable std::pair<int, int> m_automatic_density_maximum_key { -1, -1 };
+
+                /// The generation of the cached automatic density maximum.
+                mutable std::size_t m_automatic_density_maximum_generation { 0 };
+
+                /// The projected points (interleaved x/y world pixels), keyed by projection (epsg number) and zoom.
+                mutable std::map<std::pair<int, int>, std::shared_ptr<const std::vector<double>>> m_points_px;
+
+                /// The generation of the projected points.
+                mutable std::size_t m_points_px_generation { 0 };
+
+                /// The cached heatmap image.
+                mutable QImage m_cached_image;
+
+                /// The rect (world pixels) the cached heatmap image covers.
+                mutable QRectF m_cached_rect_px;
+
+                /// The projection (epsg number) and zoom of the cached heatmap image.
+                mutable std::pair<int, int> m_cached_key { -1, -1 };
+
+                /// The generation of the cached heatmap image.
+                mutable std::size_t m_cached_generation { 0 };
+
+            };
+
+        }
+
+    }
+
+}
@@ -16,7 +16,9 @@
  */
 
 // STL includes.
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
 // Local includes.
 #include "Algorithms.h"
@@ -76,3 +78,245 @@ PointWorldCoord algorithms::destinationPoint(const PointWorldCoord& start_point,
     // Return the destination point.
     return PointWorldCoord(destination_longitude_rad * (180.0 / M_PI), destination_latitude_rad * (180.0 / M_PI));
 }
+
+std::vector<std::size_t> algorithms::simplify(const QPolygonF& points, const double& tolerance)
+{
+    // Track which points are kept.
+    std::vector<std::size_t> return_indices;
+
+    // Check we have enough points to simplify.
+    if(points.size() < 3)
+    {
+        // Keep all of the points.
+        for(int i = 0; i < points.size(); ++i)
+        {
+            return_indices.push_back(std::size_t(i));
+        }
+    }
+    else
+    {
+        // Mark the first and last points as kept.
+        std::vector<bool> points_kept(std::size_t(points.size()), false);
+        points_kept.front() = true;
+        points_kept.back() = true;
+
+        // Use an explicit stack of ranges to avoid deep recursion on large lines.
+        std::vector<std::pair<int, int>> ranges;
+        ranges.emplace_back(0, points.size() - 1);
+        while(ranges.empty() == false)
+        {
+            // Take the next range to simplify.
+            const std::pair<int, int> range(ranges.back());
+            ranges.pop_back();
+
+            // Calculate the segment between the range's end points.
+            const QPointF& start_point(points.at(range.first));
+            const QPointF segment(points.at(range.second) - start_point);
+            const double segment_length_squared(QPointF::dotProduct(segment, segment));
+
+            // Find the point furthest from the segment.
+            double furthest_distance_squared(0.0);
+            int furthest_index(-1);
+            for(int i = range.first + 1; i < range.second; ++i)
+            {
+                // Calculate the squared distance from the point to the segment.
+                const QPointF offset(points.at(i) - start_point);
+                double distance_squared(QPointF::dotProduct(offset, offset));
+                if(segment_length_squared > 0.0)
+                {
+                    // Clamp the projection onto the segment.
+                    const double t(std::max(0.0, std::min(1.0, QPointF::dotProduct(offset, segment) / segment_length_squared)));
+                    const QPointF delta(offset - segment * t);
+                    distance_squared = QPointF::dotProduct(delta, delta);
+                }
+
+                // Is this the furthest point so far?
+                if(distance_squared > furthest_distance_squared)
+                {
+                    furthest_distance_squared = distance_squared;
+                    furthest_index = i;
+                }
+            }
+
+            // Keep the furthest point and split the range if it is outside the tolerance.
+            if(furthest_index != -1 && furthest_distance_squared > tolerance * tolerance)
+            {
+                points_kept.at(std::size_t(furthest_index)) = true;
+                ranges.emplace_back(range.first, furthest_index);
+                ranges.emplace_back(furthest_index, range.second);
+            }
+        }
+
+        // Collect the indices of the kept points.
+        for(std::size_t i = 0; i < points_kept.size(); ++i)
+        {
+            if(points_kept.at(i))
+            {
+                return_indices.push_back(i);
+            }
+        }
+    }
+
+    // Return the kept indices.
+    return return_indices;
+}
+
+int algorithms::outcode(const QPointF& point, const QRectF& rect)
+{
+    // Start inside the rect.
+    int return_outcode(0);
+
+    // Check the horizontal sides.
+    if(point.x() < rect.left())
+    {
+        return_outcode |= 1;
+    }
+    else if(point.x() > rect.right())
+    {
+        return_outcode |= 2;
+    }
+
+    // Check the vertical sides.
+    if(point.y() < rect.top())
+    {
+        return_outcode |= 4;
+    }
+    else if(point.y() > rect.bottom())
+    {
+        return_outcode |= 8;
+    }
+
+    // Return the outcode.
+    return return_outcode;
+}
+
+bool algorithms::clipLine(QPointF& start_point, QPointF& end_point, const QRectF& rect)
+{
+    // The parametric range of the segment that is inside the rect.
+    double t_minimum(0.0);
+    double t_maximum(1.0);
+
+    // The direction of the segment.
+    const double delta_x(end_point.x() - start_point.x());
+    const double delta_y(end_point.y() - start_point.y());
+
+    // The (p, q) pairs for the left, right, top and bottom edges.
+    const double p[4] = { -delta_x, delta_x, -delta_y, delta_y };
+    const double q[4] = { start_point.x() - rect.left(), rect.right() - start_point.x(), start_point.y() - rect.top(), rect.bottom() - start_point.y() };
+
+    // Loop through each edge to narrow the range.
+    for(int i = 0; i < 4; ++i)
+    {
+        if(p[i] == 0.0)
+        {
+            // The segment is parallel to the edge, so it is either fully outside or unaffected.
+            if(q[i] < 0.0)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // Calculate where the segment crosses the edge.
+            const double t(q[i] / p[i]);
+            if(p[i] < 0.0)
+            {
+                // Entering the edge.
+                t_minimum = std::max(t_minimum, t);
+            }
+            else
+            {
+                // Leaving the edge.
+                t_maximum = std::min(t_maximum, t);
+            }
+
+            // Nothing remains inside the rect.
+            if(t_minimum > t_maximum)
+            {
+                return false;
+            }
+        }
+    }
+
+    // Update the points to the clipped range.
+    const QPointF original_start_point(start_point);
+    start_point = QPointF(original_start_point.x() + t_minimum * delta_x, original_start_point.y() + t_minimum * delta_y);
+    end_point = QPointF(original_start_point.x() + t_maximum * delta_x, original_start_point.y() + t_maximum * delta_y);
+
+    // Return that part of the segment is inside.
+    return true;
+}
+
+QPolygonF algorithms::clipPolygon(const QPolygonF& polygon, const QRectF& rect)
+{
+    // Clip a copy of the polygon.
+    std::vector<QPointF> points(polygon.begin(), polygon.end());
+    std::vector<QPointF> scratch;
+    clipPolygon(points, scratch, rect);
+
+    // Return the clipped polygon.
+    QPolygonF return_polygon;
+    return_polygon.reserve(int(points.size()));
+    for(const auto& point : points)
+    {
+        return_polygon.append(point);
+    }
+    return return_polygon;
+}
+
+void algorithms::clipPolygon(std::vector<QPointF>& polygon, std::vector<QPointF>& scratch, const QRectF& rect)
+{
+    // Loop through each edge (left, right, top, bottom).
+    for(int edge = 0; edge < 4 && polygon.empty() == false; ++edge)
+    {
+        // Helpers to check whether a point is inside the edge and where a segment crosses it.
+        const auto inside = [&rect, edge](const QPointF& point)
+        {
+            switch(edge)
+            {
+                case 0: return point.x() >= rect.left();
+                case 1: return point.x() <= rect.right();
+                case 2: return point.y() >= rect.top();
+                default: return point.y() <= rect.bottom();
+            }
+        };
+        const auto intersect = [&rect, edge](const QPointF& start_point, const QPointF& end_point)
+        {
+            const QPointF delta(end_point - start_point);
+            switch(edge)
+            {
+                case 0: return start_point + delta * ((rect.left() - start_point.x()) / delta.x());
+                case 1: return start_point + delta * ((rect.right() - start_point.x()) / delta.x());
+                case 2: return start_point + delta * ((rect.top() - start_point.y()) / delta.y());
+                default: return start_point + delta * ((rect.bottom() - start_point.y()) / delta.y());
+            }
+        };
+
+        // Clip the polygon against the edge (into the scratch buffer, which then becomes the polygon).
+        scratch.clear();
+        QPointF previous_point(polygon.back());
+        bool previous_inside(inside(previous_point));
+        for(const auto& point : polygon)
+        {
+            // Is the current point inside the edge?
+            const bool point_inside(inside(point));
+
+            // Add the crossing point if the segment crosses the edge.
+            if(point_inside != previous_inside)
+            {
+                scratch.push_back(intersect(previous_point, point));
+            }
+
+            // Keep the point if it is inside the edge.
+            if(point_inside)
+            {
+                scratch.push_back(point);
+            }
+
+            // Move on to the next segment.
+            previous_point = point;
+            previous_inside = point_inside;
+        }
+        polygon.swap(scratch);
+    }
+}
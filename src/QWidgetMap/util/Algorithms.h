@@ -17,6 +17,10 @@
 
 #pragma once
 
+// Qt includes.
+#include <QtCore/QRectF>
+#include <QtGui/QPolygonF>
+
 // STL includes.
 #include <vector>
 
@@ -60,6 +64,48 @@ namespace qwm
              */
             QWIDGETMAP_EXPORT PointWorldCoord destinationPoint(const PointWorldCoord& start_point, const double& distance_m, const double& bearing_deg);
 
+            /**
+             * Simplifies a line using the Douglas-Peucker algorithm.
+             * @param points The points of the line to simplify.
+             * @param tolerance The maximum distance a removed point can be from the simplified line.
+             * @return the indices of the points that are kept, in order (the first and last points are always kept).
+             */
+            QWIDGETMAP_EXPORT std::vector<std::size_t> simplify(const QPolygonF& points, const double& tolerance);
+
+            /**
+             * Calculates the Cohen-Sutherland outcode of a point against a rect.
+             * Two points whose outcodes share a bit lie on the same outer side of the rect, so the segment between them is not visible.
+             * @param point The point to use.
+             * @param rect The rect to use (must be normalized).
+             * @return the outcode (0 if the point is inside the rect).
+             */
+            QWIDGETMAP_EXPORT int outcode(const QPointF& point, const QRectF& rect);
+
+            /**
+             * Clips a line segment to a rect using the Liang-Barsky algorithm.
+             * @param start_point The start point of the segment, updated to the clipped start point.
+             * @param end_point The end point of the segment, updated to the clipped end point.
+             * @param rect The rect to clip to (must be normalized).
+             * @return whether any part of the segment is inside the rect.
+             */
+            QWIDGETMAP_EXPORT bool clipLine(QPointF& start_point, QPointF& end_point, const QRectF& rect);
+
+            /**
+             * Clips a polygon to a rect using the Sutherland-Hodgman algorithm.
+             * @param polygon The polygon to clip.
+             * @param rect The rect to clip to (must be normalized).
+             * @return the clipped polygon (empty if the polygon is outside the rect).
+             */
+            QWIDGETMAP_EXPORT QPolygonF clipPolygon(const QPolygonF& polygon, const QRectF& rect);
+
+            /**
+             * Clips a polygon to a rect in place using the Sutherland-Hodgman algorithm (no allocations once the buffers have capacity).
+             * @param polygon The polygon to clip, replaced by the clipped polygon (empty if the polygon is outside the rect).
+             * @param scratch A buffer used whilst clipping (its contents are overwritten).
+             * @param rect The rect to clip to (must be normalized).
+             */
+            QWIDGETMAP_EXPORT void clipPolygon(std::vector<QPointF>& polygon, std::vector<QPointF>& scratch, const QRectF& rect);
+
         }
 
     }
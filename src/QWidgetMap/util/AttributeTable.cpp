@@ -0,0 +1,696 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "AttributeTable.h"
+
+// Qt includes.
+#include <QtCore/QDebug>
+
+using namespace qwm::util;
+
+std::size_t AttributeTable::rowCount() const
+{
+    // Gain a read lock to protect the rows.
+    QReadLocker locker(&m_lock);
+
+    // Return the number of rows in use.
+    return m_rows_used.size() - m_rows_free.size();
+}
+
+std::size_t AttributeTable::addRow()
+{
+    // Gain a write lock to protect the rows.
+    QWriteLocker locker(&m_lock);
+
+    // The row allocated.
+    std::size_t return_row(0);
+
+    // Do we have a released row to reuse?
+    if(m_rows_free.empty() == false)
+    {
+        // Reuse the most recently released row (its values were cleared when it was released).
+        return_row = m_rows_free.back();
+        m_rows_free.pop_back();
+        m_rows_used[return_row] = 1;
+    }
+    else
+    {
+        // Append a new row.
+        return_row = m_rows_used.size();
+        m_rows_used.push_back(1);
+
+        // Grow each column to include the new row.
+        for(auto& column : m_columns)
+        {
+            resize(column, m_rows_used.size());
+        }
+    }
+
+    // Return the row allocated.
+    return return_row;
+}
+
+void AttributeTable::removeRow(const std::size_t& row)
+{
+    // Gain a write lock to protect the rows.
+    QWriteLocker locker(&m_lock);
+
+    // Check the row is in use.
+    if(row < m_rows_used.size() && m_rows_used[row] != 0)
+    {
+        // Clear the row's values.
+        for(auto& column : m_columns)
+        {
+            column.m_valid[row] = 0;
+            if(column.m_type == ColumnType::Variant)
+            {
+                column.m_variants[row] = QVariant();
+            }
+        }
+
+        // Release the row for reuse.
+        m_rows_used[row] = 0;
+        m_rows_free.push_back(row);
+    }
+}
+
+std::vector<std::string> AttributeTable::keys() const
+{
+    // Gain a read lock to protect the columns.
+    QReadLocker locker(&m_lock);
+
+    // Return the keys of the columns.
+    return m_column_keys;
+}
+
+AttributeTable::ColumnType AttributeTable::columnType(const std::string& key) const
+{
+    // Gain a read lock to protect the columns.
+    QReadLocker locker(&m_lock);
+
+    // Find the column.
+    const Column* column(findColumn(key));
+
+    // Return the column type.
+    return column == nullptr ? ColumnType::Null : column->m_type;
+}
+
+QVariant AttributeTable::value(const std::size_t& row, const std::string& key) const
+{
+    // Gain a read lock to protect the columns.
+    QReadLocker locker(&m_lock);
+
+    // Default return value.
+    QVariant return_value;
+
+    // Find the column.
+    const Column* column(findColumn(key));
+    if(column != nullptr && row < m_rows_used.size())
+    {
+        // Fetch the value.
+        return_value = columnValue(*column, row);
+    }
+
+    // Return the value.
+    return return_value;
+}
+
+std::vector<std::pair<std::string, QVariant>> AttributeTable::values(const std::size_t& row) const
+{
+    // Gain a read lock to protect the columns.
+    QReadLocker locker(&m_lock);
+
+    // The values to return.
+    std::vector<std::pair<std::string, QVariant>> return_values;
+
+    // Check the row exists.
+    if(row < m_rows_used.size())
+    {
+        // Loop through each column.
+        for(std::size_t i = 0; i < m_columns.size(); ++i)
+        {
+            // Does the row have a value in this column?
+            if(m_columns[i].m_valid[row] != 0)
+            {
+                // Add the key/value.
+                return_values.emplace_back(m_column_keys[i], columnValue(m_columns[i], row));
+            }
+        }
+    }
+
+    // Return the values.
+    return return_values;
+}
+
+void AttributeTable::setValue(const std::size_t& row, const std::string& key, const QVariant& value)
+{
+    // Gain a write lock to protect the columns.
+    QWriteLocker locker(&m_lock);
+
+    // Check the row is in use.
+    if(row >= m_rows_used.size() || m_rows_used[row] == 0)
+    {
+        // Row not allocated.
+        qDebug() << "Unable to set attribute value of unallocated row" << row;
+    }
+    else
+    {
+        // Find the column, creating it (interning the key) if it does not exist yet and we are setting a value.
+        auto itr_find(m_column_indices.find(key));
+        if(itr_find == m_column_indices.end() && value.isValid())
+        {
+            // Add the column, sized to the existing rows.
+            itr_find = m_column_indices.emplace(key, m_columns.size()).first;
+            m_column_keys.push_back(key);
+            m_columns.emplace_back();
+            resize(m_columns.back(), m_rows_used.size());
+        }
+
+        // Do we have a column to update?
+        if(itr_find != m_column_indices.end())
+        {
+            // Fetch the column.
+            Column& column(m_columns[itr_find->second]);
+
+            // Are we clearing the value?
+            if(value.isValid() == false)
+            {
+                // Clear the value.
+                column.m_valid[row] = 0;
+                if(column.m_type == ColumnType::Variant)
+                {
+                    column.m_variants[row] = QVariant();
+                }
+            }
+            else
+            {
+                // Change the column type if it does not store this value type.
+                const ColumnType value_type(valueType(value));
+                if(column.m_type != value_type)
+                {
+                    if(column.m_type == ColumnType::Null)
+                    {
+                        // Adopt the value type.
+                        convert(column, value_type);
+                    }
+                    else if(column.m_type == ColumnType::Integer && value_type == ColumnType::Double)
+                    {
+                        // Widen to doubles.
+                        convert(column, ColumnType::Double);
+                    }
+                    else if(column.m_type != ColumnType::Double || value_type != ColumnType::Integer)
+                    {
+                        // Mixed types, fall back to variants.
+                        convert(column, ColumnType::Variant);
+                    }
+                }
+
+                // Set the value.
+                column.m_valid[row] = 1;
+                switch(column.m_type)
+                {
+                    case ColumnType::Null:
+                    {
+                        // Never reached, the column type has been set above.
+                        break;
+                    }
+                    case ColumnType::Boolean:
+                    {
+                        column.m_integers[row] = value.toBool() ? 1 : 0;
+                        break;
+                    }
+                    case ColumnType::Integer:
+                    {
+                        column.m_integers[row] = value.toLongLong();
+                        break;
+                    }
+                    case ColumnType::Double:
+                    {
+                        column.m_doubles[row] = value.toDouble();
+                        break;
+                    }
+                    case ColumnType::String:
+                    {
+                        // Look up the string's code, adding it to the dictionary if it is new.
+                        const QString string(value.toString());
+                        auto itr_string(column.m_string_lookup.find(string));
+                        if(itr_string == column.m_string_lookup.end())
+                        {
+                            itr_string = column.m_string_lookup.emplace(string, std::uint32_t(column.m_strings.size())).first;
+                            column.m_strings.push_back(string);
+                        }
+                        column.m_string_codes[row] = itr_string->second;
+                        break;
+                    }
+                    case ColumnType::Variant:
+                    {
+                        column.m_variants[row] = value;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::vector<std::size_t> AttributeTable::rowsInRange(const std::string& key, const double& minimum, const double& maximum) const
+{
+    // Gain a read lock to protect the columns.
+    QReadLocker locker(&m_lock);
+
+    // The rows to return.
+    std::vector<std::size_t> return_rows;
+
+    // Find the column.
+    const Column* column(findColumn(key));
+    if(column != nullptr)
+    {
+        // Scan the column's contiguous values (specialised per column type, so the numeric scans do not go via variants).
+        const std::size_t row_count(m_rows_used.size());
+        switch(column->m_type)
+        {
+            case ColumnType::Boolean:
+            case ColumnType::Integer:
+            {
+                for(std::size_t row = 0; row < row_count; ++row)
+                {
+                    const double number(double(column->m_integers[row]));
+                    if(column->m_valid[row] != 0 && number >= minimum && number <= maximum)
+                    {
+                        return_rows.push_back(row);
+                    }
+                }
+                break;
+            }
+            case ColumnType::Double:
+            {
+                for(std::size_t row = 0; row < row_count; ++row)
+                {
+                    const double number(column->m_doubles[row]);
+                    if(column->m_valid[row] != 0 && number >= minimum && number <= maximum)
+                    {
+                        return_rows.push_back(row);
+                    }
+                }
+                break;
+            }
+            case ColumnType::Variant:
+            {
+                for(std::size_t row = 0; row < row_count; ++row)
+                {
+                    double number(0.0);
+                    if(columnNumber(*column, row, number) && number >= minimum && number <= maximum)
+                    {
+                        return_rows.push_back(row);
+                    }
+                }
+                break;
+            }
+            case ColumnType::Null:
+            case ColumnType::String:
+            {
+                // No numeric values to scan.
+                break;
+            }
+        }
+    }
+
+    // Return the rows.
+    return return_rows;
+}
+
+std::vector<std::size_t> AttributeTable::rowsEqual(const std::string& key, const QVariant& value) const
+{
+    // Gain a read lock to protect the columns.
+    QReadLocker locker(&m_lock);
+
+    // The rows to return.
+    std::vector<std::size_t> return_rows;
+
+    // Find the column.
+    const Column* column(findColumn(key));
+    if(column != nullptr)
+    {
+        // Scan the column's contiguous values.
+        const std::size_t row_count(m_rows_used.size());
+        switch(column->m_type)
+        {
+            case ColumnType::Boolean:
+            case ColumnType::Integer:
+            case ColumnType::Double:
+            {
+                // Compare numerically.
+                bool ok(false);
+                const double number(value.toDouble(&ok));
+                if(ok)
+                {
+                    for(std::size_t row = 0; row < row_count; ++row)
+                    {
+                        double row_number(0.0);
+                        if(columnNumber(*column, row, row_number) && row_number == number)
+                        {
+                            return_rows.push_back(row);
+                        }
+                    }
+                }
+                break;
+            }
+            case ColumnType::String:
+            {
+                // Compare the string codes (strings not in the dictionary cannot match).
+                const auto itr_string(column->m_string_lookup.find(value.toString()));
+                if(itr_string != column->m_string_lookup.end())
+                {
+                    for(std::size_t row = 0; row < row_count; ++row)
+                    {
+                        if(column->m_valid[row] != 0 && column->m_string_codes[row] == itr_string->second)
+                        {
+                            return_rows.push_back(row);
+                        }
+                    }
+                }
+                break;
+            }
+            case ColumnType::Variant:
+            {
+                for(std::size_t row = 0; row < row_count; ++row)
+                {
+                    if(column->m_valid[row] != 0 && column->m_variants[row] == value)
+                    {
+                        return_rows.push_back(row);
+                    }
+                }
+                break;
+            }
+            case ColumnType::Null:
+            {
+                // No values to scan.
+                break;
+            }
+        }
+    }
+
+    // Return the rows.
+    return return_rows;
+}
+
+std::vector<double> AttributeTable::numbers(const std::string& key, const std::vector<std::size_t>& rows, const double& default_value) const
+{
+    // Gain a read lock to protect the columns.
+    QReadLocker locker(&m_lock);
+
+    // The numeric values to return (default to the default value).
+    std::vector<double> return_numbers(rows.size(), default_value);
+
+    // Find the column.
+    const Column* column(findColumn(key));
+    if(column != nullptr)
+    {
+        // Fetch the numeric value of each row.
+        for(std::size_t i = 0; i < rows.size(); ++i)
+        {
+            if(rows[i] < m_rows_used.size())
+            {
+                columnNumber(*column, rows[i], return_numbers[i]);
+            }
+        }
+    }
+
+    // Return the numeric values.
+    return return_numbers;
+}
+
+std::size_t AttributeTable::memoryBytes() const
+{
+    // Gain a read lock to protect the columns/rows.
+    QReadLocker locker(&m_lock);
+
+    // Add the rows to the size of the table.
+    std::size_t return_bytes(sizeof(AttributeTable));
+    return_bytes += m_rows_used.capacity() * sizeof(unsigned char);
+    return_bytes += m_rows_free.capacity() * sizeof(std::size_t);
+
+    // Add each column.
+    for(std::size_t i = 0; i < m_columns.size(); ++i)
+    {
+        // The column's key (and its index entry).
+        const Column& column(m_columns[i]);
+        return_bytes += sizeof(Column) + sizeof(std::string) + ((4 * sizeof(void*)) + sizeof(std::pair<const std::string, std::size_t>)) + (2 * m_column_keys[i].capacity());
+
+        // The column's values.
+        return_bytes += column.m_valid.capacity() * sizeof(unsigned char);
+        return_bytes += column.m_integers.capacity() * sizeof(std::int64_t);
+        return_bytes += column.m_doubles.capacity() * sizeof(double);
+        return_bytes += column.m_string_codes.capacity() * sizeof(std::uint32_t);
+        return_bytes += column.m_variants.capacity() * sizeof(QVariant);
+
+        // The column's string dictionary (each string is held by the dictionary and its lookup).
+        return_bytes += column.m_strings.capacity() * sizeof(QString);
+        for(const auto& string : column.m_strings)
+        {
+            return_bytes += std::size_t(string.size()) * sizeof(QChar);
+        }
+        return_bytes += column.m_string_lookup.size() * ((4 * sizeof(void*)) + sizeof(std::pair<const QString, std::uint32_t>));
+    }
+
+    // Return the estimated number of bytes.
+    return return_bytes;
+}
+
+AttributeTable::ColumnType AttributeTable::valueType(const QVariant& value)
+{
+    // Default column type.
+    ColumnType return_type(ColumnType::Variant);
+
+    // Find the column type that stores the value.
+    switch(value.type())
+    {
+        case QVariant::Bool:
+        {
+            return_type = ColumnType::Boolean;
+            break;
+        }
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        {
+            return_type = ColumnType::Integer;
+            break;
+        }
+        case QVariant::Double:
+        {
+            return_type = ColumnType::Double;
+            break;
+        }
+        case QVariant::String:
+        {
+            return_type = ColumnType::String;
+            break;
+        }
+        default:
+        {
+            // Store as a variant.
+            break;
+        }
+    }
+
+    // Return the column type.
+    return return_type;
+}
+
+void AttributeTable::resize(Column& column, const std::size_t& size)
+{
+    // Resize whether each row has a value.
+    column.m_valid.resize(size, 0);
+
+    // Resize the container that matches the column type.
+    switch(column.m_type)
+    {
+        case ColumnType::Null:
+        {
+            // No values to store.
+            break;
+        }
+        case ColumnType::Boolean:
+        case ColumnType::Integer:
+        {
+            column.m_integers.resize(size, 0);
+            break;
+        }
+        case ColumnType::Double:
+        {
+            column.m_doubles.resize(size, 0.0);
+            break;
+        }
+        case ColumnType::String:
+        {
+            column.m_string_codes.resize(size, 0);
+            break;
+        }
+        case ColumnType::Variant:
+        {
+            column.m_variants.resize(size);
+            break;
+        }
+    }
+}
+
+void AttributeTable::convert(Column& column, const ColumnType& column_type)
+{
+    // Capture the existing values when changing to variants (before the column type changes).
+    std::vector<QVariant> variants;
+    if(column_type == ColumnType::Variant)
+    {
+        variants.resize(column.m_valid.size());
+        for(std::size_t row = 0; row < column.m_valid.size(); ++row)
+        {
+            variants[row] = columnValue(column, row);
+        }
+    }
+
+    // Capture the existing values when widening integers to doubles.
+    std::vector<double> doubles;
+    if(column_type == ColumnType::Double && column.m_type == ColumnType::Integer)
+    {
+        doubles.assign(column.m_integers.begin(), column.m_integers.end());
+    }
+
+    // Release the existing storage.
+    std::vector<std::int64_t>().swap(column.m_integers);
+    std::vector<double>().swap(column.m_doubles);
+    std::vector<std::uint32_t>().swap(column.m_string_codes);
+    std::vector<QString>().swap(column.m_strings);
+    column.m_string_lookup.clear();
+    std::vector<QVariant>().swap(column.m_variants);
+
+    // Set the column type.
+    column.m_type = column_type;
+
+    // Restore the converted values.
+    column.m_variants.swap(variants);
+    column.m_doubles.swap(doubles);
+
+    // Size the storage for the column type.
+    resize(column, column.m_valid.size());
+}
+
+QVariant AttributeTable::columnValue(const Column& column, const std::size_t& row)
+{
+    // Default return value.
+    QVariant return_value;
+
+    // Does the row have a value?
+    if(column.m_valid[row] != 0)
+    {
+        // Fetch the value from the container that matches the column type.
+        switch(column.m_type)
+        {
+            case ColumnType::Null:
+            {
+                // No values stored.
+                break;
+            }
+            case ColumnType::Boolean:
+            {
+                return_value = QVariant(column.m_integers[row] != 0);
+                break;
+            }
+            case ColumnType::Integer:
+            {
+                return_value = QVariant(qlonglong(column.m_integers[row]));
+                break;
+            }
+            case ColumnType::Double:
+            {
+                return_value = QVariant(column.m_doubles[row]);
+                break;
+            }
+            case ColumnType::String:
+            {
+                return_value = QVariant(column.m_strings[column.m_string_codes[row]]);
+                break;
+            }
+            case ColumnType::Variant:
+            {
+                return_value = column.m_variants[row];
+                break;
+            }
+        }
+    }
+
+    // Return the value.
+    return return_value;
+}
+
+bool AttributeTable::columnNumber(const Column& column, const std::size_t& row, double& return_number)
+{
+    // Whether the row has a numeric value.
+    bool success(false);
+
+    // Does the row have a value?
+    if(column.m_valid[row] != 0)
+    {
+        // Fetch the numeric value from the container that matches the column type.
+        switch(column.m_type)
+        {
+            case ColumnType::Boolean:
+            case ColumnType::Integer:
+            {
+                return_number = double(column.m_integers[row]);
+                success = true;
+                break;
+            }
+            case ColumnType::Double:
+            {
+                return_number = column.m_doubles[row];
+                success = true;
+                break;
+            }
+            case ColumnType::Variant:
+            {
+                bool ok(false);
+                const double number(column.m_variants[row].toDouble(&ok));
+                if(ok)
+                {
+                    return_number = number;
+                    success = true;
+                }
+                break;
+            }
+            case ColumnType::Null:
+            case ColumnType::String:
+            {
+                // No numeric value.
+                break;
+            }
+        }
+    }
+
+    // Return our success.
+    return success;
+}
+
+const AttributeTable::Column* AttributeTable::findColumn(const std::string& key) const
+{
+    // Find the column.
+    const auto itr_find(m_column_indices.find(key));
+
+    // Return the column, or nullptr if it does not exist.
+    return itr_find == m_column_indices.end() ? nullptr : &m_columns[itr_find->second];
+}
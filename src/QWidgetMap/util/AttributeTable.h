@@ -0,0 +1,283 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+
+// STL includes.
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Columnar storage of meta-data, shared by many drawable items.
+         * Each drawable item is allocated a row, and each meta-data key is interned as a typed column, so that values of
+         * the same key are stored contiguously (strings are dictionary encoded). This keeps the per-item overhead low and
+         * allows a key to be scanned across all rows in one pass (ie: for filtering/styling).
+         */
+        class QWIDGETMAP_EXPORT AttributeTable
+        {
+
+        public:
+
+            /// Column types.
+            enum class ColumnType
+            {
+                /// No values have been set.
+                Null,
+
+                /// Boolean values.
+                Boolean,
+
+                /// Integer values.
+                Integer,
+
+                /// Double values.
+                Double,
+
+                /// String values (dictionary encoded).
+                String,
+
+                /// Mixed/other values (stored as variants).
+                Variant
+            };
+
+        public:
+
+            /**
+             * This constructs an Attribute Table.
+             */
+            AttributeTable() = default;
+
+            /// Disable copy constructor.
+            AttributeTable(const AttributeTable&) = delete;
+
+            /// Disable copy assignment.
+            AttributeTable& operator=(const AttributeTable&) = delete;
+
+            /// Destructor.
+            ~AttributeTable() = default;
+
+        public:
+
+            /**
+             * Fetches the number of rows in use.
+             * @return the number of rows in use.
+             */
+            std::size_t rowCount() const;
+
+            /**
+             * Allocates a row (rows released previously are reused).
+             * @return the row allocated.
+             */
+            std::size_t addRow();
+
+            /**
+             * Releases a row, clearing its values.
+             * @param row The row to release.
+             */
+            void removeRow(const std::size_t& row);
+
+            /**
+             * Fetches the keys of the columns.
+             * @return the keys of the columns.
+             */
+            std::vector<std::string> keys() const;
+
+            /**
+             * Fetches the type of a column.
+             * @param key The key of the column.
+             * @return the type of the column (ColumnType::Null if the column does not exist).
+             */
+            ColumnType columnType(const std::string& key) const;
+
+            /**
+             * Fetches a value.
+             * @param row The row to fetch.
+             * @param key The key of the column to fetch.
+             * @return the value (invalid if not set). Integer values are returned as qlonglong.
+             */
+            QVariant value(const std::size_t& row, const std::string& key) const;
+
+            /**
+             * Fetches all the values set for a row.
+             * @param row The row to fetch.
+             * @return the key/values set for the row.
+             */
+            std::vector<std::pair<std::string, QVariant>> values(const std::size_t& row) const;
+
+            /**
+             * Set a value.
+             * Integer columns are widened to double columns when a double is set, any other mismatch of types changes the
+             * column to store variants.
+             * @param row The row to set.
+             * @param key The key of the column to set.
+             * @param value The value to set (an invalid value clears the value).
+             */
+            void setValue(const std::size_t& row, const std::string& key, const QVariant& value);
+
+            /**
+             * Fetches the rows with a numeric value within a range.
+             * @param key The key of the column to scan.
+             * @param minimum The minimum value (inclusive).
+             * @param maximum The maximum value (inclusive).
+             * @return the rows with a value within the range, in row order.
+             */
+            std::vector<std::size_t> rowsInRange(const std::string& key, const double& minimum, const double& maximum) const;
+
+            /**
+             * Fetches the rows with a value equal to a value.
+             * @param key The key of the column to scan.
+             * @param value The value to compare against.
+             * @return the rows with a value equal to the value, in row order.
+             */
+            std::vector<std::size_t> rowsEqual(const std::string& key, const QVariant& value) const;
+
+            /**
+             * Fetches the numeric values of multiple rows in one pass (ie: to style drawable items by value).
+             * @param key The key of the column to fetch.
+             * @param rows The rows to fetch.
+             * @param default_value The value to use for rows without a numeric value.
+             * @return the numeric value of each row.
+             */
+            std::vector<double> numbers(const std::string& key, const std::vector<std::size_t>& rows, const double& default_value = 0.0) const;
+
+            /**
+             * Estimates the number of bytes used by the table (the columns, string dictionaries and rows).
+             * @return the estimated number of bytes used.
+             */
+            std::size_t memoryBytes() const;
+
+        private:
+
+            /// Column storage (only the container that matches the column type is populated).
+            struct Column
+            {
+                /// The column type.
+                ColumnType m_type { ColumnType::Null };
+
+                /// Whether each row has a value.
+                std::vector<unsigned char> m_valid;
+
+                /// Boolean/integer values.
+                std::vector<std::int64_t> m_integers;
+
+                /// Double values.
+                std::vector<double> m_doubles;
+
+                /// String values, as codes into the string dictionary.
+                std::vector<std::uint32_t> m_string_codes;
+
+                /// The string dictionary.
+                std::vector<QString> m_strings;
+
+                /// The code of each string in the string dictionary.
+                std::map<QString, std::uint32_t> m_string_lookup;
+
+                /// Mixed/other values.
+                std::vector<QVariant> m_variants;
+            };
+
+            /**
+             * Fetches the column type that stores a value.
+             * @param value The value to check.
+             * @return the column type that stores the value.
+             */
+            static ColumnType valueType(const QVariant& value);
+
+            /**
+             * Resizes a column's storage.
+             * @param column The column to resize.
+             * @param size The number of rows.
+             */
+            static void resize(Column& column, const std::size_t& size);
+
+            /**
+             * Changes a column's type, converting the existing values.
+             * @param column The column to change.
+             * @param column_type The column type to change to.
+             */
+            static void convert(Column& column, const ColumnType& column_type);
+
+            /**
+             * Fetches a value from a column.
+             * @param column The column to fetch from.
+             * @param row The row to fetch.
+             * @return the value (invalid if not set).
+             */
+            static QVariant columnValue(const Column& column, const std::size_t& row);
+
+            /**
+             * Fetches a numeric value from a column.
+             * @param column The column to fetch from.
+             * @param row The row to fetch.
+             * @param return_number The numeric value.
+             * @return whether the row has a numeric value.
+             */
+            static bool columnNumber(const Column& column, const std::size_t& row, double& return_number);
+
+            /**
+             * Fetches a column.
+             * @param key The key of the column.
+             * @return the column, or nullptr if the column does not exist.
+             */
+            const Column* findColumn(const std::string& key) const;
+
+        private:
+
+            /// Lock to protect the columns/rows.
+            mutable QReadWriteLock m_lock;
+
+            /// The index of each column, keyed by the (interned) key.
+            std::map<std::string, std::size_t> m_column_indices;
+
+            /// The key of each column.
+            std::vector<std::string> m_column_keys;
+
+            /// The columns.
+            std::vector<Column> m_columns;
+
+            /// Whether each row is in use.
+            std::vector<unsigned char> m_rows_used;
+
+            /// The rows released, available for reuse.
+            std::vector<std::size_t> m_rows_free;
+
+        };
+
+    }
+
+}
@@ -0,0 +1,392 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// STD includes.
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <vector>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Persistent vector stored in immutable chunks.
+         * Copies share all of their chunks, and a modification only copies the list of chunks and the chunks it touches.
+         * Chunks hold around sqrt(size) objects, so adding or removing a single object costs O(sqrt(size)) rather than O(size).
+         */
+        template <class T>
+        class QWIDGETMAP_EXPORT ChunkedVector
+        {
+
+        private:
+
+            /// A chunk of objects (never modified once it has been published).
+            typedef std::vector<T> Chunk;
+
+            /// The list of chunks (never modified once it has been published).
+            typedef std::vector<std::shared_ptr<const Chunk>> Chunks;
+
+        public:
+
+            /// Forward iterator over the objects (in order).
+            class const_iterator
+            {
+
+            public:
+
+                /// Iterator traits.
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const T* pointer;
+                typedef const T& reference;
+
+            public:
+
+                /**
+                 * Iterator constructor.
+                 * @param chunks The list of chunks to iterate over.
+                 * @param chunk_index The index of the current chunk.
+                 */
+                const_iterator(const Chunks* chunks, const std::size_t& chunk_index)
+                    : m_chunks(chunks),
+                      m_chunk_index(chunk_index)
+                {
+
+                }
+
+            public:
+
+                /// Dereference operator.
+                reference operator*() const
+                {
+                    // Return the current object.
+                    return (*(*m_chunks)[m_chunk_index])[m_object_index];
+                }
+
+                /// Member access operator.
+                pointer operator->() const
+                {
+                    // Return the current object.
+                    return &(*(*m_chunks)[m_chunk_index])[m_object_index];
+                }
+
+                /// Pre-increment operator.
+                const_iterator& operator++()
+                {
+                    // Move to the next object, and on to the next chunk at the end of the current chunk (chunks are never empty).
+                    if(++m_object_index == (*m_chunks)[m_chunk_index]->size())
+                    {
+                        ++m_chunk_index;
+                        m_object_index = 0;
+                    }
+
+                    // Return the iterator.
+                    return *this;
+                }
+
+                /// Post-increment operator.
+                const_iterator operator++(int)
+                {
+                    // Move to the next object, and return the previous position.
+                    const const_iterator return_iterator(*this);
+                    ++(*this);
+                    return return_iterator;
+                }
+
+                /// Equality operator.
+                bool operator==(const const_iterator& other) const
+                {
+                    // Return whether the positions are the same.
+                    return m_chunk_index == other.m_chunk_index && m_object_index == other.m_object_index;
+                }
+
+                /// Inequality operator.
+                bool operator!=(const const_iterator& other) const
+                {
+                    // Return whether the positions are different.
+                    return (*this == other) == false;
+                }
+
+            private:
+
+                /// The list of chunks to iterate over.
+                const Chunks* m_chunks;
+
+                /// The index of the current chunk.
+                std::size_t m_chunk_index;
+
+                /// The index of the current object within the current chunk.
+                std::size_t m_object_index { 0 };
+
+            };
+
+        public:
+
+            /**
+             * Chunked Vector constructor.
+             */
+            ChunkedVector() = default;
+
+            /**
+             * Chunked Vector copy constructor.
+             * The chunks are shared with the original (they are never modified).
+             * @param other The chunked vector to copy.
+             */
+            ChunkedVector(const ChunkedVector& other) = default;
+
+            /**
+             * Chunked Vector copy assignment.
+             * The chunks are shared with the original (they are never modified).
+             * @param other The chunked vector to copy.
+             * @return this chunked vector.
+             */
+            ChunkedVector& operator=(const ChunkedVector& other) = default;
+
+            /// Destructor.
+            ~ChunkedVector() = default;
+
+        public:
+
+            /**
+             * Fetches whether the vector is empty.
+             * @return whether the vector is empty.
+             */
+            bool empty() const
+            {
+                // Return whether we have any objects.
+                return m_size == 0;
+            }
+
+            /**
+             * Fetches the number of objects.
+             * @return the number of objects.
+             */
+            std::size_t size() const
+            {
+                // Return the number of objects.
+                return m_size;
+            }
+
+            /**
+             * Fetches an iterator to the first object.
+             * @return an iterator to the first object.
+             */
+            const_iterator begin() const
+            {
+                // Return an iterator to the first chunk.
+                return const_iterator(m_chunks.get(), 0);
+            }
+
+            /**
+             * Fetches an iterator past the last object.
+             * @return an iterator past the last object.
+             */
+            const_iterator end() const
+            {
+                // Return an iterator past the last chunk.
+                return const_iterator(m_chunks.get(), m_chunks->size());
+            }
+
+            /**
+             * Fetches all objects.
+             * @return the objects (in order).
+             */
+            std::vector<T> values() const
+            {
+                // Copy the objects of each chunk.
+                std::vector<T> return_values;
+                return_values.reserve(m_size);
+                for(const auto& chunk : *m_chunks)
+                {
+                    return_values.insert(return_values.end(), chunk->begin(), chunk->end());
+                }
+
+                // Return the objects.
+                return return_values;
+            }
+
+            /**
+             * Fetches the estimated memory used by the chunks (excluding the objects' own heap allocations).
+             * @return the estimated memory used in bytes.
+             */
+            std::size_t memoryBytes() const
+            {
+                // Add the list of chunks.
+                std::size_t return_bytes(m_chunks->capacity() * sizeof(std::shared_ptr<const Chunk>));
+
+                // Add each chunk.
+                for(const auto& chunk : *m_chunks)
+                {
+                    return_bytes += sizeof(Chunk) + chunk->capacity() * sizeof(T);
+                }
+
+                // Return the memory used.
+                return return_bytes;
+            }
+
+            /**
+             * Appends objects to the end.
+             * Only the list of chunks and the last chunk are copied, the other chunks are shared.
+             * @param values The objects to append.
+             */
+            void append(const std::vector<T>& values)
+            {
+                // Do we have anything to append?
+                if(values.empty() == false)
+                {
+                    // Copy the list of chunks (it may be shared with other copies).
+                    const auto chunks(std::make_shared<Chunks>(*m_chunks));
+
+                    // Calculate how many objects each chunk should hold.
+                    const std::size_t chunk_size(chunkSize(m_size + values.size()));
+
+                    // Fill the last chunk first (copied, as it may be shared with other copies).
+                    auto itr_value(values.begin());
+                    if(chunks->empty() == false && chunks->back()->size() < chunk_size)
+                    {
+                        const auto chunk(std::make_shared<Chunk>());
+                        chunk->reserve(chunk_size);
+                        chunk->insert(chunk->end(), chunks->back()->begin(), chunks->back()->end());
+                        const std::size_t count(std::min(chunk_size - chunk->size(), static_cast<std::size_t>(std::distance(itr_value, values.end()))));
+                        chunk->insert(chunk->end(), itr_value, itr_value + static_cast<std::ptrdiff_t>(count));
+                        itr_value += static_cast<std::ptrdiff_t>(count);
+                        chunks->back() = chunk;
+                    }
+
+                    // Add the remaining objects in new chunks.
+                    while(itr_value != values.end())
+                    {
+                        const std::size_t count(std::min(chunk_size, static_cast<std::size_t>(std::distance(itr_value, values.end()))));
+                        chunks->push_back(std::make_shared<const Chunk>(itr_value, itr_value + static_cast<std::ptrdiff_t>(count)));
+                        itr_value += static_cast<std::ptrdiff_t>(count);
+                    }
+
+                    // Replace the list of chunks.
+                    m_chunks = chunks;
+                    m_size += values.size();
+                }
+            }
+
+            /**
+             * Removes objects.
+             * Only the list of chunks and the chunks that contain the objects are copied, the other chunks are shared.
+             * @param values The objects to remove.
+             * @return the objects that were removed.
+             */
+            std::vector<T> erase(const std::set<T>& values)
+            {
+                // The objects removed.
+                std::vector<T> return_values;
+
+                // The new list of chunks (only created once a chunk has changed).
+                std::shared_ptr<Chunks> chunks;
+
+                // Loop through each chunk.
+                for(std::size_t c = 0; c < m_chunks->size(); ++c)
+                {
+                    // Does the chunk contain any of the objects (once all the objects are found, the other chunks are kept as they are)?
+                    const auto& chunk((*m_chunks)[c]);
+                    const bool contains(return_values.size() < values.size() && std::any_of(chunk->begin(), chunk->end(), [&](const T& object) { return values.count(object) > 0; }));
+                    if(contains)
+                    {
+                        // Copy the chunks before this one, if this is the first chunk to change.
+                        if(chunks == nullptr)
+                        {
+                            chunks = std::make_shared<Chunks>(m_chunks->begin(), m_chunks->begin() + static_cast<std::ptrdiff_t>(c));
+                        }
+
+                        // Copy the objects to keep (single pass), and keep track of the objects removed.
+                        const auto chunk_kept(std::make_shared<Chunk>());
+                        chunk_kept->reserve(chunk->size());
+                        for(const auto& object : *chunk)
+                        {
+                            if(values.count(object) == 0)
+                            {
+                                chunk_kept->push_back(object);
+                            }
+                            else
+                            {
+                                return_values.push_back(object);
+                            }
+                        }
+
+                        // Keep the chunk if it still has any objects.
+                        if(chunk_kept->empty() == false)
+                        {
+                            chunks->push_back(chunk_kept);
+                        }
+                    }
+                    else if(chunks != nullptr)
+                    {
+                        // Keep the chunk as it is.
+                        chunks->push_back(chunk);
+                    }
+                }
+
+                // Did we remove anything?
+                if(chunks != nullptr)
+                {
+                    // Replace the list of chunks.
+                    m_chunks = chunks;
+                    m_size -= return_values.size();
+                }
+
+                // Return the objects removed.
+                return return_values;
+            }
+
+        private:
+
+            /**
+             * Calculates how many objects each chunk should hold.
+             * @param size The total number of objects.
+             * @return the number of objects each chunk should hold.
+             */
+            static std::size_t chunkSize(const std::size_t& size)
+            {
+                // Balance the cost of copying the list of chunks with the cost of copying a chunk (with a minimum chunk size).
+                return std::max(std::size_t(256), static_cast<std::size_t>(std::sqrt(static_cast<double>(size))));
+            }
+
+        private:
+
+            /// The list of chunks.
+            std::shared_ptr<const Chunks> m_chunks { std::make_shared<const Chunks>() };
+
+            /// The number of objects.
+            std::size_t m_size { 0 };
+
+        };
+
+    }
+
+}
@@ -0,0 +1,229 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ClusterContainer.h"
+
+// STL includes.
+#include <algorithm>
+#include <cmath>
+
+using namespace qwm::util;
+
+ClusterContainer::ClusterContainer(const int& zoom_maximum, const double& cell_size_px, const projection::EPSG& projection_epsg, const QSize& tile_size_px)
+    : m_zoom_maximum(std::max(zoom_maximum, 0)),
+      m_cell_size_px(cell_size_px),
+      m_projection_epsg(projection_epsg),
+      m_tile_size_px(tile_size_px),
+      m_viewport(QSizeF(), projection_epsg, tile_size_px),
+      m_cells(m_zoom_maximum + 1)
+{
+
+}
+
+int ClusterContainer::zoomMaximum() const
+{
+    // Return the maximum zoom level.
+    return m_zoom_maximum;
+}
+
+double ClusterContainer::cellSizePx() const
+{
+    // Return the cell size.
+    return m_cell_size_px;
+}
+
+const qwm::projection::EPSG& ClusterContainer::projection() const
+{
+    // Return the projection.
+    return m_projection_epsg;
+}
+
+const QSize& ClusterContainer::tileSizePx() const
+{
+    // Return the tile size.
+    return m_tile_size_px;
+}
+
+std::vector<ClusterContainer::Cluster> ClusterContainer::query(const RectWorldCoord& range_coord, const int& zoom) const
+{
+    // The clusters to return.
+    std::vector<Cluster> return_clusters;
+
+    // Is the zoom level clustered?
+    if(zoom >= 0 && zoom <= m_zoom_maximum)
+    {
+        // Calculate the cells that the range covers (the range may not be normalised).
+        const std::pair<long, long> top_left_cell(cell(range_coord.topLeftCoord(), zoom));
+        const std::pair<long, long> bottom_right_cell(cell(range_coord.bottomRightCoord(), zoom));
+        const long row_first(std::min(top_left_cell.first, bottom_right_cell.first));
+        const long row_last(std::max(top_left_cell.first, bottom_right_cell.first));
+        const long column_first(std::min(top_left_cell.second, bottom_right_cell.second));
+        const long column_last(std::max(top_left_cell.second, bottom_right_cell.second));
+
+        // Loop through each row of cells.
+        const auto& cells(m_cells[zoom]);
+        for(long row = row_first; row <= row_last; ++row)
+        {
+            // Loop through the cells in the row that are within the range (cells only exist if they contain points).
+            auto itr_cell(cells.lower_bound(std::make_pair(row, column_first)));
+            while(itr_cell != cells.end() && itr_cell->first.first == row && itr_cell->first.second <= column_last)
+            {
+                // Calculate the cell's top-left/bottom-right points.
+                const PointWorldPx cell_top_left_px(itr_cell->first.second * m_cell_size_px, itr_cell->first.first * m_cell_size_px);
+                const PointWorldPx cell_bottom_right_px(cell_top_left_px.x() + m_cell_size_px, cell_top_left_px.y() + m_cell_size_px);
+
+                // Add the cluster.
+                return_clusters.push_back(Cluster { PointWorldCoord(itr_cell->second.m_longitude_sum / itr_cell->second.m_count, itr_cell->second.m_latitude_sum / itr_cell->second.m_count),
+                                                    RectWorldCoord(toPointWorldCoord(cell_top_left_px, zoom), toPointWorldCoord(cell_bottom_right_px, zoom)),
+                                                    itr_cell->second.m_count });
+
+                // Move on to the next cell.
+                ++itr_cell;
+            }
+        }
+    }
+
+    // Return the clusters.
+    return return_clusters;
+}
+
+void ClusterContainer::insert(const PointWorldCoord& point_coord, const int& zoom_minimum, const int& zoom_maximum)
+{
+    // Loop through each clustered zoom level that the point is shown at.
+    for(int zoom = std::max(zoom_minimum, 0); zoom <= std::min(zoom_maximum, m_zoom_maximum); ++zoom)
+    {
+        // Add the point to its cell.
+        update(zoom, cell(point_coord, zoom), point_coord, 1);
+    }
+}
+
+void ClusterContainer::erase(const PointWorldCoord& point_coord, const int& zoom_minimum, const int& zoom_maximum)
+{
+    // Loop through each clustered zoom level that the point is shown at.
+    for(int zoom = std::max(zoom_minimum, 0); zoom <= std::min(zoom_maximum, m_zoom_maximum); ++zoom)
+    {
+        // Remove the point from its cell.
+        update(zoom, cell(point_coord, zoom), point_coord, -1);
+    }
+}
+
+void ClusterContainer::relocate(const PointWorldCoord& previous_point_coord, const PointWorldCoord& point_coord, const int& zoom_minimum, const int& zoom_maximum)
+{
+    // Loop through each clustered zoom level that the point is shown at.
+    for(int zoom = std::max(zoom_minimum, 0); zoom <= std::min(zoom_maximum, m_zoom_maximum); ++zoom)
+    {
+        // Move the point between cells (if the cell is unchanged, this only adjusts its mean point).
+        update(zoom, cell(previous_point_coord, zoom), previous_point_coord, -1);
+        update(zoom, cell(point_coord, zoom), point_coord, 1);
+    }
+}
+
+void ClusterContainer::clear()
+{
+    // Loop through each zoom level and remove its cells.
+    for(auto& cells : m_cells)
+    {
+        cells.clear();
+    }
+}
+
+std::size_t ClusterContainer::memoryBytes() const
+{
+    // Add the list of zoom levels to the size of the object.
+    std::size_t return_bytes(sizeof(ClusterContainer) + (m_cells.capacity() * sizeof(std::map<std::pair<long, long>, Cell>)));
+
+    // Add each cell (the map node and its allocation overhead).
+    return_bytes += cellCount() * (sizeof(std::map<std::pair<long, long>, Cell>::value_type) + (4 * sizeof(void*)));
+
+    // Return the memory used.
+    return return_bytes;
+}
+
+std::size_t ClusterContainer::cellCount() const
+{
+    // Count the cells at each zoom level.
+    std::size_t return_count(0);
+    for(const auto& cells : m_cells)
+    {
+        return_count += cells.size();
+    }
+
+    // Return the number of cells.
+    return return_count;
+}
+
+std::pair<long, long> ClusterContainer::cell(const PointWorldCoord& point_coord, const int& zoom) const
+{
+    // Project the point into world pixels.
+    const PointWorldPx point_px(toPointWorldPx(point_coord, zoom));
+
+    // Return the cell (row, column), measured from the top-left of the world.
+    return std::make_pair(static_cast<long>(std::floor(point_px.y() / m_cell_size_px)), static_cast<long>(std::floor(point_px.x() / m_cell_size_px)));
+}
+
+PointWorldPx ClusterContainer::toPointWorldPx(const PointWorldCoord& point_coord, const int& zoom) const
+{
+    // Project the point at zoom level 0, and scale it to the zoom level (the world is 2^zoom times larger).
+    const double scale(std::pow(2.0, zoom));
+    const PointWorldPx point_px(projection::toPointWorldPx(m_viewport, point_coord));
+
+    // Return the point clamped to the world (points near the poles are outside of some projections).
+    return PointWorldPx(std::min(std::max(point_px.x(), 0.0), projection::worldWidthPx(m_viewport)) * scale,
+                        std::min(std::max(point_px.y(), 0.0), projection::worldHeightPx(m_viewport)) * scale);
+}
+
+PointWorldCoord ClusterContainer::toPointWorldCoord(const PointWorldPx& point_px, const int& zoom) const
+{
+    // Scale the point back to zoom level 0, and convert it into coordinates.
+    const double scale(std::pow(2.0, zoom));
+    return projection::toPointWorldCoord(m_viewport, PointWorldPx(point_px.x() / scale, point_px.y() / scale));
+}
+
+void ClusterContainer::update(const int& zoom, const std::pair<long, long>& cell_index, const PointWorldCoord& point_coord, const int& count)
+{
+    // Is the point being added?
+    auto& cells(m_cells[zoom]);
+    if(count > 0)
+    {
+        // Add the point to the cell (created if required).
+        auto& cell_points(cells[cell_index]);
+        cell_points.m_longitude_sum += point_coord.longitude();
+        cell_points.m_latitude_sum += point_coord.latitude();
+        ++cell_points.m_count;
+    }
+    else
+    {
+        // Find the cell.
+        const auto itr_cell(cells.find(cell_index));
+        if(itr_cell != cells.end())
+        {
+            // Is this the last point in the cell?
+            if(itr_cell->second.m_count <= 1)
+            {
+                // Remove the cell.
+                cells.erase(itr_cell);
+            }
+            else
+            {
+                // Remove the point from the cell.
+                itr_cell->second.m_longitude_sum -= point_coord.longitude();
+                itr_cell->second.m_latitude_sum -= point_coord.latitude();
+                --itr_cell->second.m_count;
+            }
+        }
+    }
+}
@@ -0,0 +1,235 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// STL includes.
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Qt includes.
+#include <QtCore/QSize>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+#include "../Viewport.h"
+#include "../projection/Projection.h"
+#include "Point.h"
+#include "Rect.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Cluster container, that aggregates points into a grid of cells for each zoom level.
+         * The cells are square in projected world pixels (so each zoom level has half the cell size of the previous one in
+         * coordinates), and are updated incrementally as points are inserted/removed.
+         */
+        class QWIDGETMAP_EXPORT ClusterContainer
+        {
+
+        public:
+
+            /// Captures a cluster of points.
+            struct Cluster
+            {
+                /// The mean point of the points in the cluster (world coordinates).
+                PointWorldCoord m_point_coord;
+
+                /// The cell that the cluster covers (world coordinates).
+                RectWorldCoord m_cell_coord;
+
+                /// The number of points in the cluster.
+                std::size_t m_count;
+            };
+
+        public:
+
+            /**
+             * Cluster container constructor.
+             * @param zoom_maximum The maximum zoom level to cluster points at.
+             * @param cell_size_px The size of each cell in pixels.
+             * @param projection_epsg The projection that the points are displayed with (the cells are square in its world pixels).
+             * @param tile_size_px The size of a map tile in pixels (used to calculate the world pixels at each zoom level).
+             */
+            ClusterContainer(const int& zoom_maximum, const double& cell_size_px = 60.0, const projection::EPSG& projection_epsg = projection::EPSG::SphericalMercator, const QSize& tile_size_px = QSize(256, 256));
+
+            /// Disable copy constructor.
+            ClusterContainer(const ClusterContainer&) = delete;
+
+            /// Disable copy assignment.
+            ClusterContainer& operator=(const ClusterContainer&) = delete;
+
+            /// Destructor.
+            ~ClusterContainer() = default;
+
+        public:
+
+            /**
+             * Fetches the maximum zoom level that points are clustered at.
+             * @return the maximum zoom level that points are clustered at.
+             */
+            int zoomMaximum() const;
+
+            /**
+             * Fetches the size of each cell in pixels.
+             * @return the size of each cell in pixels.
+             */
+            double cellSizePx() const;
+
+            /**
+             * Fetches the projection that the points are displayed with.
+             * @return the projection that the points are displayed with.
+             */
+            const projection::EPSG& projection() const;
+
+            /**
+             * Fetches the size of a map tile in pixels.
+             * @return the size of a map tile in pixels.
+             */
+            const QSize& tileSizePx() const;
+
+            /**
+             * Fetches the clusters within the specified bounding box range at a zoom level.
+             * @param range_coord The bounding box range.
+             * @param zoom The zoom level.
+             * @return the clusters whose cells intersect the range.
+             */
+            std::vector<Cluster> query(const RectWorldCoord& range_coord, const int& zoom) const;
+
+            /**
+             * Inserts a point into the clusters.
+             * @param point_coord The point in coordinates.
+             * @param zoom_minimum The minimum zoom level the point is shown at.
+             * @param zoom_maximum The maximum zoom level the point is shown at.
+             */
+            void insert(const PointWorldCoord& point_coord, const int& zoom_minimum, const int& zoom_maximum);
+
+            /**
+             * Removes a point from the clusters.
+             * @param point_coord The point in coordinates.
+             * @param zoom_minimum The minimum zoom level the point is shown at.
+             * @param zoom_maximum The maximum zoom level the point is shown at.
+             */
+            void erase(const PointWorldCoord& point_coord, const int& zoom_minimum, const int& zoom_maximum);
+
+            /**
+             * Moves a point within the clusters (only the cells that it leaves/enters are changed).
+             * @param previous_point_coord The previous point in coordinates.
+             * @param point_coord The new point in coordinates.
+             * @param zoom_minimum The minimum zoom level the point is shown at.
+             * @param zoom_maximum The maximum zoom level the point is shown at.
+             */
+            void relocate(const PointWorldCoord& previous_point_coord, const PointWorldCoord& point_coord, const int& zoom_minimum, const int& zoom_maximum);
+
+            /**
+             * Removes all points from the clusters.
+             */
+            void clear();
+
+            /**
+             * Estimates the number of bytes used by the clusters (the object and the cells at each zoom level).
+             * @return the estimated number of bytes used.
+             */
+            std::size_t memoryBytes() const;
+
+            /**
+             * Fetches the number of cells (across all zoom levels).
+             * @return the number of cells.
+             */
+            std::size_t cellCount() const;
+
+        private:
+
+            /// Captures the points aggregated within a cell.
+            struct Cell
+            {
+                /// The sum of the longitudes of the points.
+                double m_longitude_sum;
+
+                /// The sum of the latitudes of the points.
+                double m_latitude_sum;
+
+                /// The number of points.
+                std::size_t m_count;
+            };
+
+            /**
+             * Calculates the cell (row, column) that contains a point at a zoom level.
+             * @param point_coord The point in coordinates.
+             * @param zoom The zoom level.
+             * @return the cell (row, column).
+             */
+            std::pair<long, long> cell(const PointWorldCoord& point_coord, const int& zoom) const;
+
+            /**
+             * Projects a point into world pixels at a zoom level (clamped to the world).
+             * @param point_coord The point in coordinates.
+             * @param zoom The zoom level.
+             * @return the point in world pixels.
+             */
+            PointWorldPx toPointWorldPx(const PointWorldCoord& point_coord, const int& zoom) const;
+
+            /**
+             * Converts a point in world pixels at a zoom level back into coordinates.
+             * @param point_px The point in world pixels.
+             * @param zoom The zoom level.
+             * @return the point in coordinates.
+             */
+            PointWorldCoord toPointWorldCoord(const PointWorldPx& point_px, const int& zoom) const;
+
+            /**
+             * Adds/removes a point to/from a cell.
+             * @param zoom The zoom level.
+             * @param cell_index The cell (row, column).
+             * @param point_coord The point in coordinates.
+             * @param count The number of points to add (1) or remove (-1).
+             */
+            void update(const int& zoom, const std::pair<long, long>& cell_index, const PointWorldCoord& point_coord, const int& count);
+
+        private:
+
+            /// The maximum zoom level to cluster points at.
+            const int m_zoom_maximum;
+
+            /// The size of each cell in pixels.
+            const double m_cell_size_px;
+
+            /// The projection that the points are displayed with.
+            const projection::EPSG m_projection_epsg;
+
+            /// The size of a map tile in pixels.
+            const QSize m_tile_size_px;
+
+            /// A viewport at zoom level 0, used to project points (world pixels at other zoom levels are scaled by 2^zoom).
+            const Viewport m_viewport;
+
+            /// The cells at each zoom level, keyed by (row, column).
+            std::vector<std::map<std::pair<long, long>, Cell>> m_cells;
+
+        };
+
+    }
+
+}
@@ -0,0 +1,104 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CollisionGrid.h"
+
+// STL includes.
+#include <cmath>
+
+using namespace qwm::util;
+
+CollisionGrid::CollisionGrid(const double& cell_size_px)
+    : m_cell_size_px(cell_size_px)
+{
+
+}
+
+bool CollisionGrid::collides(const QRectF& rect_px) const
+{
+    // Default return collides.
+    bool return_collides(false);
+
+    // Loop through each cell that the rect covers, until a collision is found.
+    const auto cell_range(cells(rect_px));
+    for(long column = cell_range.first.first; return_collides == false && column <= cell_range.second.first; ++column)
+    {
+        for(long row = cell_range.first.second; return_collides == false && row <= cell_range.second.second; ++row)
+        {
+            // Does the cell contain any rects?
+            const auto itr_find(m_cells.find(std::make_pair(column, row)));
+            if(itr_find != m_cells.end())
+            {
+                // Check the rect against each rect in the cell.
+                for(const auto& cell_rect_px : itr_find->second)
+                {
+                    if(cell_rect_px.intersects(rect_px))
+                    {
+                        // Collision found.
+                        return_collides = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Return whether the rect collides.
+    return return_collides;
+}
+
+bool CollisionGrid::insert(const QRectF& rect_px)
+{
+    // Default return success.
+    bool success(false);
+
+    // Check the rect does not collide.
+    if(collides(rect_px) == false)
+    {
+        // Add the rect to each cell that it covers.
+        const auto cell_range(cells(rect_px));
+        for(long column = cell_range.first.first; column <= cell_range.second.first; ++column)
+        {
+            for(long row = cell_range.first.second; row <= cell_range.second.second; ++row)
+            {
+                m_cells[std::make_pair(column, row)].push_back(rect_px);
+            }
+        }
+
+        // Success.
+        success = true;
+    }
+
+    // Return our success.
+    return success;
+}
+
+void CollisionGrid::clear()
+{
+    // Remove all cells.
+    m_cells.clear();
+}
+
+std::pair<std::pair<long, long>, std::pair<long, long>> CollisionGrid::cells(const QRectF& rect_px) const
+{
+    // Normalise the rect (so left/top are the minimums).
+    const QRectF rect_normalized_px(rect_px.normalized());
+
+    // Return the first and last cells covered.
+    return std::make_pair(std::make_pair(long(std::floor(rect_normalized_px.left() / m_cell_size_px)), long(std::floor(rect_normalized_px.top() / m_cell_size_px))),
+                          std::make_pair(long(std::floor(rect_normalized_px.right() / m_cell_size_px)), long(std::floor(rect_normalized_px.bottom() / m_cell_size_px))));
+}
@@ -0,0 +1,105 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QRectF>
+
+// STL includes.
+#include <map>
+#include <utility>
+#include <vector>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Collision grid, that tracks the screen-space rects already occupied (ie: by labels) so that overlapping rects can be rejected.
+         * The rects are bucketed into a uniform grid of cells, so each collision check only compares against the rects in the cells it covers.
+         */
+        class QWIDGETMAP_EXPORT CollisionGrid
+        {
+
+        public:
+
+            /**
+             * Collision grid constructor.
+             * @param cell_size_px The size of each cell in pixels.
+             */
+            explicit CollisionGrid(const double& cell_size_px = 64.0);
+
+            /// Disable copy constructor.
+            CollisionGrid(const CollisionGrid&) = delete;
+
+            /// Disable copy assignment.
+            CollisionGrid& operator=(const CollisionGrid&) = delete;
+
+            /// Destructor.
+            ~CollisionGrid() = default;
+
+        public:
+
+            /**
+             * Checks whether a rect collides with any rect already inserted.
+             * @param rect_px The rect in pixels.
+             * @return whether the rect collides.
+             */
+            bool collides(const QRectF& rect_px) const;
+
+            /**
+             * Inserts a rect, if it does not collide with any rect already inserted.
+             * @param rect_px The rect in pixels.
+             * @return whether the rect was inserted (ie: it did not collide).
+             */
+            bool insert(const QRectF& rect_px);
+
+            /**
+             * Removes all rects.
+             */
+            void clear();
+
+        private:
+
+            /**
+             * Calculates the range of cells that a rect covers.
+             * @param rect_px The rect in pixels.
+             * @return the first and last cells (column, row) covered.
+             */
+            std::pair<std::pair<long, long>, std::pair<long, long>> cells(const QRectF& rect_px) const;
+
+        private:
+
+            /// The size of each cell in pixels.
+            const double m_cell_size_px;
+
+            /// The rects that overlap each cell, keyed by (column, row) (cells only exist if they contain rects).
+            std::map<std::pair<long, long>, std::vector<QRectF>> m_cells;
+
+        };
+
+    }
+
+}
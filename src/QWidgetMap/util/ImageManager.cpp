@@ -141,7 +141,7 @@ QPixmap ImageManager::image(const QUrl& url, const QSize& size_px)
         else if(m_persistent_cache && persistentCacheFind(url, size_px, return_pixmap))
         {
             // Add the image to the volatile cache.
-            m_pixmap_cache[md5hex(url, size_px)] = return_pixmap;
+            pixmapCacheInsert(md5hex(url, size_px), return_pixmap);
         }
         // Has it recently failed to download?
         else if(m_failed_images.contains(url))
@@ -182,10 +182,21 @@ QPixmap ImageManager::prefetchImage(const QUrl& url, const QSize& size_px)
     return image(url, size_px);
 }
 
+MemoryUsage ImageManager::memoryUsage() const
+{
+    // Report the image cache and placeholder pixmaps.
+    MemoryUsage return_memory_usage("ImageManager");
+    return_memory_usage.addChild(MemoryUsage("Image cache", m_pixmap_cache_bytes, true, m_pixmap_cache_count));
+    return_memory_usage.addChild(MemoryUsage("Placeholders", m_pixmap_placeholder_bytes, true, m_pixmap_placeholder_count));
+
+    // Return the memory used.
+    return return_memory_usage;
+}
+
 void ImageManager::imageDownloaded(const QUrl& url, const QPixmap& pixmap)
 {
     // Add it to the pixmap cache.
-    m_pixmap_cache[md5hex(url, pixmap.size())] = pixmap;
+    pixmapCacheInsert(md5hex(url, pixmap.size()), pixmap);
 
     // Do we have the persistent cache enabled?
     if(m_persistent_cache)
@@ -240,6 +251,10 @@ QPixmap ImageManager::pixmapLoading(const QSize& size_px)
 
         // Save the pixmap.
         m_pixmap_loading[toString(size_px)] = pixmap;
+
+        // Keep track of the memory used.
+        m_pixmap_placeholder_bytes += MemoryUsage::pixmapBytes(pixmap);
+        ++m_pixmap_placeholder_count;
     }
 
     // Return the pixmap.
@@ -259,12 +274,32 @@ QPixmap ImageManager::pixmapFailed(const QSize& size_px)
 
         // Save the pixmap.
         m_pixmap_failed[toString(size_px)] = pixmap;
+
+        // Keep track of the memory used.
+        m_pixmap_placeholder_bytes += MemoryUsage::pixmapBytes(pixmap);
+        ++m_pixmap_placeholder_count;
     }
 
     // Return the pixmap.
     return m_pixmap_failed[toString(size_px)];
 }
 
+void ImageManager::pixmapCacheInsert(const QString& key, const QPixmap& pixmap)
+{
+    // Find (or create) the cache entry.
+    auto itr_insert(m_pixmap_cache.find(key));
+    if(itr_insert == m_pixmap_cache.end())
+    {
+        itr_insert = m_pixmap_cache.emplace(key, QPixmap()).first;
+        ++m_pixmap_cache_count;
+    }
+
+    // Replace the cached pixmap, keeping track of the memory used.
+    m_pixmap_cache_bytes -= MemoryUsage::pixmapBytes(itr_insert->second);
+    itr_insert->second = pixmap;
+    m_pixmap_cache_bytes += MemoryUsage::pixmapBytes(itr_insert->second);
+}
+
 QString ImageManager::md5hex(const QUrl& url, const QSize& size_px)
 {
     // Return the md5 hex value of the given url at a specific tile size.
@@ -27,12 +27,15 @@
 #include <QtNetwork/QNetworkProxy>
 
 // STL includes.
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <map>
 #include <memory>
 
 // Local includes.
 #include "../qwidgetmap_global.h"
+#include "MemoryUsage.h"
 #include "NetworkManager.h"
 
 /// QWidgetMap namespace.
@@ -133,6 +136,13 @@ namespace qwm
              */
             QPixmap prefetchImage(const QUrl& url, const QSize& size_px);
 
+            /**
+             * Fetches the memory used by the in-memory cache of images and the placeholder (loading/failed) pixmaps.
+             * The pixmap sizes are estimated from their dimensions and depth (the platform may store them differently).
+             * @return the memory used.
+             */
+            MemoryUsage memoryUsage() const;
+
         private slots:
 
             /**
@@ -164,6 +174,13 @@ namespace qwm
              */
             QPixmap pixmapFailed(const QSize& size_px);
 
+            /**
+             * Inserts the image into the in-memory cache, keeping track of the memory it uses.
+             * @param key The key of the image (see md5hex()).
+             * @param pixmap The pixmap of the image to insert.
+             */
+            void pixmapCacheInsert(const QString& key, const QPixmap& pixmap);
+
             /**
              * Generate a md5 hex for the given url.
              * @param url The url to generate a md5 hex for.
@@ -231,12 +248,24 @@ namespace qwm
             /// Cache of pixmaps already loaded.
             std::map<QString, QPixmap> m_pixmap_cache;
 
+            /// The number of bytes used by the pixmaps already loaded (estimated, readable from any thread).
+            std::atomic<std::size_t> m_pixmap_cache_bytes { 0 };
+
+            /// The number of pixmaps already loaded (readable from any thread).
+            std::atomic<std::size_t> m_pixmap_cache_count { 0 };
+
             /// Pixmap of an empty image with "LOADING..." text.
             std::map<QString, QPixmap> m_pixmap_loading;
 
             /// Pixmap of a failed image.
             std::map<QString, QPixmap> m_pixmap_failed;
 
+            /// The number of bytes used by the loading/failed pixmaps (estimated, readable from any thread).
+            std::atomic<std::size_t> m_pixmap_placeholder_bytes { 0 };
+
+            /// The number of loading/failed pixmaps (readable from any thread).
+            std::atomic<std::size_t> m_pixmap_placeholder_count { 0 };
+
             /// The failed image expiry.
             std::chrono::seconds m_pixmap_failed_expiry;
 
@@ -0,0 +1,167 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// STD includes.
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Lock-free multiple-producer single-consumer queue.
+         * Any number of threads can push objects without blocking, while a single consumer takes all pending objects in one go.
+         */
+        template <class T>
+        class QWIDGETMAP_EXPORT MPSCQueue
+        {
+
+        public:
+
+            /**
+             * MPSC Queue constructor.
+             */
+            MPSCQueue() = default;
+
+            /// Disable copy constructor.
+            MPSCQueue(const MPSCQueue&) = delete;
+
+            /// Disable copy assignment.
+            MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+            /// Destructor.
+            ~MPSCQueue()
+            {
+                // Release any objects that are still pending.
+                release(m_head.exchange(nullptr));
+            }
+
+        public:
+
+            /**
+             * Fetches whether the queue is empty.
+             * @return whether the queue is empty.
+             */
+            bool empty() const
+            {
+                // Return whether the queue has a head node.
+                return m_head.load(std::memory_order_acquire) == nullptr;
+            }
+
+            /**
+             * Pushes an object onto the queue (safe to call from any thread).
+             * @param object The object to push.
+             */
+            void push(T object)
+            {
+                // Create the node to push.
+                Node* node(new Node(std::move(object)));
+
+                // Link the node in as the new head, retrying if another producer got there first.
+                node->m_next = m_head.load(std::memory_order_relaxed);
+                while(m_head.compare_exchange_weak(node->m_next, node, std::memory_order_release, std::memory_order_relaxed) == false)
+                {
+                    // The failed exchange has updated the next node, so try again.
+                }
+            }
+
+            /**
+             * Takes all pending objects from the queue (must only be called from a single consumer at a time).
+             * @return the pending objects, in the order they were pushed.
+             */
+            std::vector<T> take()
+            {
+                // Detach the list of pending nodes (newest first).
+                Node* node(m_head.exchange(nullptr, std::memory_order_acquire));
+
+                // Move the objects out of the nodes.
+                std::vector<T> return_objects;
+                for(Node* itr_node(node); itr_node != nullptr; itr_node = itr_node->m_next)
+                {
+                    return_objects.push_back(std::move(itr_node->m_object));
+                }
+
+                // Release the nodes.
+                release(node);
+
+                // Reverse the objects so that they are in the order they were pushed.
+                std::reverse(return_objects.begin(), return_objects.end());
+
+                // Return the objects.
+                return return_objects;
+            }
+
+        private:
+
+            /// Queue node.
+            struct Node
+            {
+                /**
+                 * Node constructor.
+                 * @param object The object to store.
+                 */
+                explicit Node(T object)
+                    : m_object(std::move(object))
+                {
+
+                }
+
+                /// The object stored.
+                T m_object;
+
+                /// The next (older) node.
+                Node* m_next { nullptr };
+            };
+
+            /**
+             * Releases a list of nodes.
+             * @param node The first node in the list to release.
+             */
+            static void release(Node* node)
+            {
+                // Loop through each node.
+                while(node != nullptr)
+                {
+                    // Move on to the next node before releasing this one.
+                    Node* next(node->m_next);
+                    delete node;
+                    node = next;
+                }
+            }
+
+        private:
+
+            /// The most recently pushed node.
+            std::atomic<Node*> m_head { nullptr };
+
+        };
+
+    }
+
+}
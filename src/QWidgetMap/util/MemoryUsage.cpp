@@ -0,0 +1,135 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MemoryUsage.h"
+
+// STL includes.
+#include <algorithm>
+
+using namespace qwm::util;
+
+std::size_t MemoryUsage::pixmapBytes(const QPixmap& pixmap)
+{
+    // Return the pixels multiplied by the bytes per pixel.
+    return std::size_t(pixmap.width()) * std::size_t(pixmap.height()) * std::size_t(std::max(pixmap.depth(), 8) / 8);
+}
+
+std::size_t MemoryUsage::staticTextBytes(const QStaticText& static_text)
+{
+    // Return the characters, plus a glyph index and position for each character.
+    return std::size_t(static_text.text().size()) * (sizeof(QChar) + sizeof(quint32) + sizeof(QPointF));
+}
+
+MemoryUsage::MemoryUsage(const std::string& name, const std::size_t& bytes, const bool& estimated, const std::size_t& count)
+    : m_name(name),
+      m_bytes(bytes),
+      m_estimated(estimated),
+      m_count(count)
+{
+
+}
+
+const std::string& MemoryUsage::name() const
+{
+    // Return the name.
+    return m_name;
+}
+
+std::size_t MemoryUsage::bytes() const
+{
+    // Return the number of bytes.
+    return m_bytes;
+}
+
+bool MemoryUsage::isEstimated() const
+{
+    // Return whether the number of bytes is an estimate.
+    return m_estimated;
+}
+
+std::size_t MemoryUsage::count() const
+{
+    // Return the number of items.
+    return m_count;
+}
+
+const std::vector<MemoryUsage>& MemoryUsage::children() const
+{
+    // Return the sub-components.
+    return m_children;
+}
+
+void MemoryUsage::addChild(const MemoryUsage& child)
+{
+    // Add the sub-component.
+    m_children.push_back(child);
+}
+
+std::size_t MemoryUsage::totalBytes() const
+{
+    // Add the bytes of each sub-component to our own.
+    std::size_t return_bytes(m_bytes);
+    for(const auto& child : m_children)
+    {
+        return_bytes += child.totalBytes();
+    }
+
+    // Return the total number of bytes.
+    return return_bytes;
+}
+
+bool MemoryUsage::isTotalEstimated() const
+{
+    // Check whether we, or any sub-component, are an estimate.
+    bool return_estimated(m_estimated);
+    for(const auto& child : m_children)
+    {
+        return_estimated = return_estimated || child.isTotalEstimated();
+    }
+
+    // Return whether the total is an estimate.
+    return return_estimated;
+}
+
+QString MemoryUsage::toString() const
+{
+    // Build the report lines.
+    QString return_lines;
+    appendLines(return_lines, 0);
+
+    // Return the report.
+    return return_lines;
+}
+
+void MemoryUsage::appendLines(QString& return_lines, const int& depth) const
+{
+    // Add the line for this component (total bytes, with the item count if applicable).
+    return_lines += QString(depth * 2, QChar(' '));
+    return_lines += QString::fromStdString(m_name) + ": " + (isTotalEstimated() ? "~" : "") + QString::number(qulonglong(totalBytes())) + " bytes";
+    if(m_count > 0)
+    {
+        return_lines += " (" + QString::number(qulonglong(m_count)) + " items)";
+    }
+    return_lines += "\n";
+
+    // Add the lines for each sub-component.
+    for(const auto& child : m_children)
+    {
+        child.appendLines(return_lines, depth + 1);
+    }
+}
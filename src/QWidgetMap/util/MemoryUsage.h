@@ -0,0 +1,167 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QMetaType>
+#include <QtCore/QString>
+#include <QtGui/QPixmap>
+#include <QtGui/QStaticText>
+
+// STL includes.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Captures the memory used by a component, broken down into the memory used by its sub-components.
+         * Sizes that cannot be measured exactly (ie: Qt/GDAL internals, allocator and container node overheads) are
+         * estimates, and are flagged as such.
+         */
+        class QWIDGETMAP_EXPORT MemoryUsage
+        {
+
+        public:
+
+            /**
+             * This constructs a Memory Usage.
+             * @param name The name of the component.
+             * @param bytes The number of bytes used by the component itself (excluding its sub-components).
+             * @param estimated Whether the number of bytes is an estimate.
+             * @param count The number of items held by the component (ie: images, drawables, nodes), or 0 if not applicable.
+             */
+            explicit MemoryUsage(const std::string& name = std::string(), const std::size_t& bytes = 0, const bool& estimated = false, const std::size_t& count = 0);
+
+        public:
+
+            /**
+             * Estimates the number of bytes used by a pixmap's pixels (from its dimensions and depth, the platform may store it differently).
+             * @param pixmap The pixmap to estimate.
+             * @return the estimated number of bytes used.
+             */
+            static std::size_t pixmapBytes(const QPixmap& pixmap);
+
+            /**
+             * Estimates the number of bytes held by a text layout (its characters, and a glyph and position per character).
+             * @param static_text The text layout to estimate.
+             * @return the estimated number of bytes used.
+             */
+            static std::size_t staticTextBytes(const QStaticText& static_text);
+
+        public:
+
+            /**
+             * Fetches the name of the component.
+             * @return the name of the component.
+             */
+            const std::string& name() const;
+
+            /**
+             * Fetches the number of bytes used by the component itself (excluding its sub-components).
+             * @return the number of bytes used.
+             */
+            std::size_t bytes() const;
+
+            /**
+             * Fetches whether the number of bytes used by the component itself is an estimate.
+             * @return whether the number of bytes is an estimate.
+             */
+            bool isEstimated() const;
+
+            /**
+             * Fetches the number of items held by the component.
+             * @return the number of items held, or 0 if not applicable.
+             */
+            std::size_t count() const;
+
+            /**
+             * Fetches the memory used by the sub-components.
+             * @return the memory used by the sub-components.
+             */
+            const std::vector<MemoryUsage>& children() const;
+
+            /**
+             * Adds the memory used by a sub-component.
+             * @param child The memory used by the sub-component.
+             */
+            void addChild(const MemoryUsage& child);
+
+            /**
+             * Calculates the number of bytes used by the component and its sub-components.
+             * @return the total number of bytes used.
+             */
+            std::size_t totalBytes() const;
+
+            /**
+             * Checks whether any part of the total number of bytes used is an estimate.
+             * @return whether the total number of bytes is an estimate.
+             */
+            bool isTotalEstimated() const;
+
+            /**
+             * Formats the memory used as a report (one line per component, indented by depth), for logging.
+             * Estimated totals are prefixed with '~'.
+             * @return the report.
+             */
+            QString toString() const;
+
+        private:
+
+            /**
+             * Appends the report lines of the component and its sub-components.
+             * @param return_lines The report lines to append to.
+             * @param depth The depth of the component.
+             */
+            void appendLines(QString& return_lines, const int& depth) const;
+
+        private:
+
+            /// The name of the component.
+            std::string m_name;
+
+            /// The number of bytes used by the component itself.
+            std::size_t m_bytes;
+
+            /// Whether the number of bytes is an estimate.
+            bool m_estimated;
+
+            /// The number of items held by the component.
+            std::size_t m_count;
+
+            /// The memory used by the sub-components.
+            std::vector<MemoryUsage> m_children;
+
+        };
+
+    }
+
+}
+
+Q_DECLARE_METATYPE(qwm::util::MemoryUsage)
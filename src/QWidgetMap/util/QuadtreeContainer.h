@@ -21,9 +21,12 @@
 #include <QtCore/QDebug>
 
 // STD includes.
+#include <array>
 #include <cstddef>
 #include <memory>
 #include <set>
+#include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -59,8 +62,12 @@ namespace qwm
                 m_points.reserve(capacity);
             }
 
-            /// Disable copy constructor.
-            QuadtreeContainer(const QuadtreeContainer&) = delete;
+            /**
+             * Quadtree Container copy constructor.
+             * The child quadtree nodes are shared with the original until either container modifies them (copy-on-write).
+             * @param other The quadtree container to copy.
+             */
+            QuadtreeContainer(const QuadtreeContainer& other) = default;
 
             /// Disable copy assignment.
             QuadtreeContainer& operator=(const QuadtreeContainer&) = delete;
@@ -70,6 +77,77 @@ namespace qwm
 
         public:
 
+            /**
+             * Fetches the bounding box area that this quadtree container covers in coordinates.
+             * @return the bounding box area that this quadtree container covers in coordinates.
+             */
+            const RectWorldCoord& boundary() const
+            {
+                // Return the boundary.
+                return m_boundary_coord;
+            }
+
+            /**
+             * Fetches all objects.
+             * @param return_points The objects are added to this.
+             */
+            void values(std::vector<T>& return_points) const
+            {
+                // Add our points.
+                for(const auto& point : m_points)
+                {
+                    return_points.push_back(point.second);
+                }
+
+                // Do we have any child quadtree nodes?
+                if(m_child_north_east != nullptr)
+                {
+                    // Add the points of each child.
+                    m_child_north_east->values(return_points);
+                    m_child_north_west->values(return_points);
+                    m_child_south_east->values(return_points);
+                    m_child_south_west->values(return_points);
+                }
+            }
+
+            /**
+             * Fetches the number of quadtree nodes (this node and its descendants).
+             * @return the number of quadtree nodes.
+             */
+            std::size_t nodeCount() const
+            {
+                // Count this node and the nodes of each child.
+                std::size_t return_count(1);
+                if(m_child_north_east != nullptr)
+                {
+                    return_count += m_child_north_east->nodeCount() + m_child_north_west->nodeCount() + m_child_south_east->nodeCount() + m_child_south_west->nodeCount();
+                }
+
+                // Return the number of quadtree nodes.
+                return return_count;
+            }
+
+            /**
+             * Estimates the number of bytes used by the quadtree nodes (excluding the objects themselves).
+             * Child nodes shared with copies of this quadtree container are counted by each copy.
+             * @return the estimated number of bytes used.
+             */
+            std::size_t memoryBytes() const
+            {
+                // Add our point storage to the size of this node.
+                std::size_t return_bytes(sizeof(QuadtreeContainer) + (m_points.capacity() * sizeof(std::pair<PointWorldCoord, T>)));
+
+                // Do we have any child quadtree nodes?
+                if(m_child_north_east != nullptr)
+                {
+                    // Add each child (and its shared pointer control block).
+                    return_bytes += m_child_north_east->memoryBytes() + m_child_north_west->memoryBytes() + m_child_south_east->memoryBytes() + m_child_south_west->memoryBytes() + (4 * 2 * sizeof(void*));
+                }
+
+                // Return the estimated number of bytes.
+                return return_bytes;
+            }
+
             /**
              * Fetches objects within the specified bounding box range.
              * @param return_points The objects that are within the specified range are added to this.
@@ -103,6 +181,44 @@ namespace qwm
                 }
             }
 
+            /**
+             * Fetches objects within the specified bounding box range that pass a filter, stopping once a limit is reached.
+             * Nodes are visited in a fixed order (north east, north west, south east, then south west), so the same objects
+             * are returned for the same contents.
+             * @param return_points The objects that are within the specified range are added to this.
+             * @param range_coord The bounding box range.
+             * @param limit The number of return objects to stop at.
+             * @param filter The filter that each object must pass to be returned.
+             */
+            template <typename Filter>
+            void query(std::set<T>& return_points, const RectWorldCoord& range_coord, const std::size_t& limit, const Filter& filter) const
+            {
+                // Does the range intersect with our boundary (and have we still to reach the limit)?
+                if(return_points.size() < limit && range_coord.intersects(m_boundary_coord))
+                {
+                    // Check whether any of our points are contained in the range (stopping once the limit is reached).
+                    for(auto itr_point(m_points.begin()); itr_point != m_points.end() && return_points.size() < limit; ++itr_point)
+                    {
+                        // Is the point contained by the query range, and does it pass the filter.
+                        if(range_coord.contains(itr_point->first) && filter(itr_point->second))
+                        {
+                            // Add to the return points.
+                            return_points.insert(itr_point->second);
+                        }
+                    }
+
+                    // Do we have any child quadtree nodes?
+                    if(m_child_north_east != nullptr)
+                    {
+                        // Search each child and add the points they return (each returns straight away once the limit is reached).
+                        m_child_north_east->query(return_points, range_coord, limit, filter);
+                        m_child_north_west->query(return_points, range_coord, limit, filter);
+                        m_child_south_east->query(return_points, range_coord, limit, filter);
+                        m_child_south_west->query(return_points, range_coord, limit, filter);
+                    }
+                }
+            }
+
             /**
              * Inserts an object into the quadtree container.
              * @param point_coord The objects's point in coordinates.
@@ -135,29 +251,12 @@ namespace qwm
                             subdivide();
                         }
 
-                        // Try inserting into north east.
-                        if(m_child_north_east->insert(point_coord, object))
+                        // Find the child that contains the point (north east, north west, south east, then south west).
+                        std::shared_ptr<QuadtreeContainer>* child(findChild(point_coord));
+                        if(child != nullptr)
                         {
-                            // Update our success.
-                            success = true;
-                        }
-                        // Try inserting into north west.
-                        else if(m_child_north_west->insert(point_coord, object))
-                        {
-                            // Update our success.
-                            success = true;
-                        }
-                        // Try inserting into south east.
-                        else if(m_child_south_east->insert(point_coord, object))
-                        {
-                            // Update our success.
-                            success = true;
-                        }
-                        // Try inserting into south west.
-                        else if(m_child_south_west->insert(point_coord, object))
-                        {
-                            // Update our success.
-                            success = true;
+                            // Insert into the child (detached first, as it may be shared with a copy).
+                            success = detach(*child).insert(point_coord, object);
                         }
                         else
                         {
@@ -171,13 +270,37 @@ namespace qwm
                 return success;
             }
 
+            /**
+             * Inserts multiple objects into the quadtree container.
+             * The objects are partitioned into their quadrants up-front, so that each node is sized and filled in one pass.
+             * Large batches have their top-level quadrants built concurrently (one thread per quadrant, bounded by the number of cores).
+             * @param points The objects to insert, with each objects's point in coordinates.
+             * @return the number of objects inserted into this quadtree container.
+             */
+            std::size_t insert(std::vector<std::pair<PointWorldCoord, T>> points)
+            {
+                // Calculate how many levels of child quadtree nodes can be built concurrently (each level splits the work four ways).
+                std::size_t parallel_depth(0);
+                for(std::size_t tasks = 1; tasks < std::thread::hardware_concurrency(); tasks *= 4)
+                {
+                    ++parallel_depth;
+                }
+
+                // Insert the points.
+                return insertBulk(std::move(points), parallel_depth);
+            }
+
             /**
              * Removes an object from the quadtree container.
              * @param point_coord The objects's point in coordinates.
              * @param object The object to remove.
+             * @return whether the object was removed from this quadtree container.
              */
-            void erase(const PointWorldCoord& point_coord, const T& object)
+            bool erase(const PointWorldCoord& point_coord, const T& object)
             {
+                // Keep track of our success.
+                bool success(false);
+
                 // Does this boundary contain the point?
                 if(m_boundary_coord.contains(point_coord))
                 {
@@ -190,6 +313,9 @@ namespace qwm
                         {
                             // Remove the object from the container.
                             itr_point = m_points.erase(itr_point);
+
+                            // Update our success.
+                            success = true;
                         }
                         else
                         {
@@ -201,13 +327,38 @@ namespace qwm
                     // Do we have child quadtree nodes?
                     if(m_child_north_east != nullptr)
                     {
-                        // Search each child and remove the object if found.
-                        m_child_north_east->erase(point_coord, object);
-                        m_child_north_west->erase(point_coord, object);
-                        m_child_south_east->erase(point_coord, object);
-                        m_child_south_west->erase(point_coord, object);
+                        // Search each child that contains the point and remove the object if found.
+                        for(const auto& child : children())
+                        {
+                            // Does the child's boundary contain the point?
+                            if((*child)->m_boundary_coord.contains(point_coord))
+                            {
+                                // Remove from the child (detached first, as it may be shared with a copy).
+                                success |= detach(*child).erase(point_coord, object);
+                            }
+                        }
                     }
                 }
+
+                // Return our success.
+                return success;
+            }
+
+            /**
+             * Relocates an object within the quadtree container.
+             * The object is updated in place while it remains within its current node's boundary, otherwise it is removed and re-inserted from the closest ancestor node that contains the new point.
+             * @param previous_point_coord The objects's previous point in coordinates.
+             * @param point_coord The objects's new point in coordinates.
+             * @param object The object to relocate.
+             * @return whether the object was relocated (false if the object was not found, or the new point is outside of this quadtree container which removes the object).
+             */
+            bool relocate(const PointWorldCoord& previous_point_coord, const PointWorldCoord& point_coord, const T& object)
+            {
+                // Keep track of whether the object still needs to be re-inserted.
+                bool reinsert(false);
+
+                // Relocate the object, it is only a success if it was found and did not need re-inserting above us.
+                return relocateNode(previous_point_coord, point_coord, object, reinsert) && reinsert == false;
             }
 
             /**
@@ -219,14 +370,299 @@ namespace qwm
                 m_points.clear();
 
                 // Reset the child nodes.
-                m_child_north_east.reset(nullptr);
-                m_child_north_west.reset(nullptr);
-                m_child_south_east.reset(nullptr);
-                m_child_south_west.reset(nullptr);
+                m_child_north_east.reset();
+                m_child_north_west.reset();
+                m_child_south_east.reset();
+                m_child_south_west.reset();
             }
 
         private:
 
+            /**
+             * Inserts multiple objects into the quadtree container.
+             * @param points The objects to insert, with each objects's point in coordinates.
+             * @param parallel_depth The number of levels of child quadtree nodes that can still be built concurrently.
+             * @return the number of objects inserted into this quadtree container.
+             */
+            std::size_t insertBulk(std::vector<std::pair<PointWorldCoord, T>> points, const std::size_t& parallel_depth)
+            {
+                // The minimum number of points that are worth building child quadtree nodes concurrently for.
+                const std::size_t parallel_points_minimum(10000);
+
+                // Keep track of the number of objects inserted.
+                std::size_t inserted(0);
+
+                // The objects that do not fit within this node's capacity.
+                std::vector<std::pair<PointWorldCoord, T>> overflow_points;
+
+                // Loop through each object.
+                for(auto& point : points)
+                {
+                    // Does this boundary contain the point?
+                    if(m_boundary_coord.contains(point.first))
+                    {
+                        // Have we reached our capacity?
+                        if(m_points.size() < m_capacity)
+                        {
+                            // Add the point.
+                            m_points.push_back(std::move(point));
+
+                            // Update the number inserted.
+                            ++inserted;
+                        }
+                        else
+                        {
+                            // Defer the point to the child quadtree nodes.
+                            overflow_points.push_back(std::move(point));
+                        }
+                    }
+                }
+
+                // Do we have any points to pass on to the child quadtree nodes?
+                if(overflow_points.empty() == false)
+                {
+                    // Do we already have child quadtree nodes?
+                    if(m_child_north_east == nullptr)
+                    {
+                        // We need to create the child quadtree nodes before we continue.
+                        subdivide();
+                    }
+
+                    // Calculate which child quadtree node each point belongs to (using the same order as a single insert).
+                    std::vector<std::size_t> child_indices(overflow_points.size(), 4);
+                    std::size_t child_counts[4] { 0, 0, 0, 0 };
+                    const std::array<std::shared_ptr<QuadtreeContainer>*, 4> child_nodes(children());
+                    for(std::size_t i = 0; i < overflow_points.size(); ++i)
+                    {
+                        // Find the first child that contains the point.
+                        for(std::size_t c = 0; c < 4 && child_indices[i] == 4; ++c)
+                        {
+                            // Does the child's boundary contain the point?
+                            if((*child_nodes[c])->m_boundary_coord.contains(overflow_points[i].first))
+                            {
+                                // Assign the point to this child.
+                                child_indices[i] = c;
+                                ++child_counts[c];
+                            }
+                        }
+                    }
+
+                    // Pre-size each child's list of points, and detach the children that will be modified (they may be shared with a copy).
+                    std::vector<std::pair<PointWorldCoord, T>> child_points[4];
+                    QuadtreeContainer* children_detached[4] { nullptr, nullptr, nullptr, nullptr };
+                    for(std::size_t c = 0; c < 4; ++c)
+                    {
+                        child_points[c].reserve(child_counts[c]);
+                        if(child_counts[c] > 0)
+                        {
+                            children_detached[c] = &detach(*child_nodes[c]);
+                        }
+                    }
+
+                    // Distribute the points to each child's list.
+                    for(std::size_t i = 0; i < overflow_points.size(); ++i)
+                    {
+                        // Was a child found?
+                        if(child_indices[i] < 4)
+                        {
+                            // Add the point to the child's list.
+                            child_points[child_indices[i]].push_back(std::move(overflow_points[i]));
+                        }
+                        else
+                        {
+                            // Warn that we are unable to insert point into quadtree container.
+                            qDebug() << "Unable to insert point into quadtree container.";
+                        }
+                    }
+
+                    // Should the child quadtree nodes be built concurrently?
+                    if(parallel_depth > 0 && overflow_points.size() >= parallel_points_minimum)
+                    {
+                        // Build each child on its own thread (each child only touches its own sub-tree, so no locking is required).
+                        std::size_t child_inserted[4] { 0, 0, 0, 0 };
+                        bool child_threaded[4] { false, false, false, false };
+                        std::vector<std::thread> child_threads;
+                        child_threads.reserve(4);
+                        try
+                        {
+                            for(std::size_t c = 0; c < 4; ++c)
+                            {
+                                if(children_detached[c] != nullptr)
+                                {
+                                    child_threads.emplace_back([&, c]() { child_inserted[c] = children_detached[c]->insertBulk(std::move(child_points[c]), parallel_depth - 1); });
+                                    child_threaded[c] = true;
+                                }
+                            }
+                        }
+                        catch(const std::system_error&)
+                        {
+                            // Unable to start another thread, the remaining children are built on this thread below.
+                        }
+
+                        // Wait for each child to be built (the threads already started must be joined before anything else can throw).
+                        for(auto& child_thread : child_threads)
+                        {
+                            child_thread.join();
+                        }
+
+                        // Insert the points into each child that could not be built on its own thread.
+                        for(std::size_t c = 0; c < 4; ++c)
+                        {
+                            if(children_detached[c] != nullptr && child_threaded[c] == false)
+                            {
+                                child_inserted[c] = children_detached[c]->insertBulk(std::move(child_points[c]), 0);
+                            }
+                        }
+
+                        // Add up the number inserted by each child.
+                        for(std::size_t c = 0; c < 4; ++c)
+                        {
+                            inserted += child_inserted[c];
+                        }
+                    }
+                    else
+                    {
+                        // Insert the points into each child.
+                        for(std::size_t c = 0; c < 4; ++c)
+                        {
+                            if(children_detached[c] != nullptr)
+                            {
+                                inserted += children_detached[c]->insertBulk(std::move(child_points[c]), 0);
+                            }
+                        }
+                    }
+                }
+
+                // Return the number of objects inserted.
+                return inserted;
+            }
+
+            /**
+             * Relocates an object within this quadtree node (and its child nodes).
+             * @param previous_point_coord The objects's previous point in coordinates.
+             * @param point_coord The objects's new point in coordinates.
+             * @param object The object to relocate.
+             * @param reinsert Set to true if the object was removed and needs re-inserting by an ancestor node (the new point is outside of this node).
+             * @return whether the object was found.
+             */
+            bool relocateNode(const PointWorldCoord& previous_point_coord, const PointWorldCoord& point_coord, const T& object, bool& reinsert)
+            {
+                // Keep track of whether we found the object.
+                bool found(false);
+
+                // Does this boundary contain the previous point?
+                if(m_boundary_coord.contains(previous_point_coord))
+                {
+                    // Check whether any of our points are the object.
+                    auto itr_point(m_points.begin());
+                    while(found == false && itr_point != m_points.end())
+                    {
+                        // Have we found the object?
+                        if(itr_point->second == object)
+                        {
+                            // Does this boundary still contain the new point?
+                            if(m_boundary_coord.contains(point_coord))
+                            {
+                                // Update the point in place.
+                                itr_point->first = point_coord;
+                            }
+                            else
+                            {
+                                // Remove the object, an ancestor node needs to re-insert it.
+                                m_points.erase(itr_point);
+                                reinsert = true;
+                            }
+
+                            // We have found the object.
+                            found = true;
+                        }
+                        else
+                        {
+                            // Move on to the next point.
+                            ++itr_point;
+                        }
+                    }
+
+                    // Do we need to search our child quadtree nodes?
+                    if(found == false && m_child_north_east != nullptr)
+                    {
+                        // Search each child that contains the previous point until the object is found.
+                        for(const auto& child : children())
+                        {
+                            // Does the child's boundary contain the previous point?
+                            if(found == false && (*child)->m_boundary_coord.contains(previous_point_coord))
+                            {
+                                // Relocate within the child (detached first, as it may be shared with a copy).
+                                found = detach(*child).relocateNode(previous_point_coord, point_coord, object, reinsert);
+                            }
+                        }
+
+                        // Did a child remove the object, and does this boundary contain the new point?
+                        if(reinsert && m_boundary_coord.contains(point_coord))
+                        {
+                            // Re-insert the object from this node.
+                            reinsert = (insert(point_coord, object) == false);
+                        }
+                    }
+                }
+
+                // Return whether we found the object.
+                return found;
+            }
+
+            /**
+             * Ensures a child node is not shared with a copy of this quadtree container before it is modified (copy-on-write).
+             * @param child The child node to detach.
+             * @return the detached child node.
+             */
+            static QuadtreeContainer& detach(std::shared_ptr<QuadtreeContainer>& child)
+            {
+                // Is the child node shared?
+                if(child.use_count() > 1)
+                {
+                    // Replace it with our own copy (which still shares its own child nodes).
+                    child = std::make_shared<QuadtreeContainer>(*child);
+                }
+
+                // Return the detached child node.
+                return *child;
+            }
+
+            /**
+             * Fetches the child nodes, in the order they are searched (north east, north west, south east, south west).
+             * @return the child nodes.
+             */
+            std::array<std::shared_ptr<QuadtreeContainer>*, 4> children()
+            {
+                // Return the child nodes.
+                return {{ &m_child_north_east, &m_child_north_west, &m_child_south_east, &m_child_south_west }};
+            }
+
+            /**
+             * Finds the first child node that contains the point.
+             * @param point_coord The point in coordinates.
+             * @return the child node that contains the point, or nullptr if none do.
+             */
+            std::shared_ptr<QuadtreeContainer>* findChild(const PointWorldCoord& point_coord)
+            {
+                // Default to no child found.
+                std::shared_ptr<QuadtreeContainer>* return_child(nullptr);
+
+                // Loop through each child until one is found.
+                for(const auto& child : children())
+                {
+                    // Does the child's boundary contain the point?
+                    if(return_child == nullptr && (*child)->m_boundary_coord.contains(point_coord))
+                    {
+                        // Use this child.
+                        return_child = child;
+                    }
+                }
+
+                // Return the child found.
+                return return_child;
+            }
+
             /**
              * Creates the child nodes.
              */
@@ -237,19 +673,19 @@ namespace qwm
 
                 // Construct the north east child.
                 const RectWorldCoord north_east(PointWorldCoord(m_boundary_coord.left() + half_size.width(), m_boundary_coord.top()), half_size);
-                m_child_north_east.reset(new QuadtreeContainer<T>(m_capacity, north_east));
+                m_child_north_east = std::make_shared<QuadtreeContainer<T>>(m_capacity, north_east);
 
                 // Construct the north west child.
                 const RectWorldCoord north_west(PointWorldCoord(m_boundary_coord.left(), m_boundary_coord.top()), half_size);
-                m_child_north_west.reset(new QuadtreeContainer<T>(m_capacity, north_west));
+                m_child_north_west = std::make_shared<QuadtreeContainer<T>>(m_capacity, north_west);
 
                 // Construct the south east child.
                 const RectWorldCoord south_east(PointWorldCoord(m_boundary_coord.left() + half_size.width(), m_boundary_coord.top() + half_size.height()), half_size);
-                m_child_south_east.reset(new QuadtreeContainer<T>(m_capacity, south_east));
+                m_child_south_east = std::make_shared<QuadtreeContainer<T>>(m_capacity, south_east);
 
                 // Construct the south west child.
                 const RectWorldCoord south_west(PointWorldCoord(m_boundary_coord.left(), m_boundary_coord.top() + half_size.height()), half_size);
-                m_child_south_west.reset(new QuadtreeContainer<T>(m_capacity, south_west));
+                m_child_south_west = std::make_shared<QuadtreeContainer<T>>(m_capacity, south_west);
             }
 
         private:
@@ -263,17 +699,17 @@ namespace qwm
             /// Points in this quadtree node.
             std::vector<std::pair<PointWorldCoord, T>> m_points;
 
-            /// Child: north east quadtree node.
-            std::unique_ptr<QuadtreeContainer> m_child_north_east;
+            /// Child: north east quadtree node (shared with copies until modified).
+            std::shared_ptr<QuadtreeContainer> m_child_north_east;
 
-            /// Child: north west quadtree node.
-            std::unique_ptr<QuadtreeContainer> m_child_north_west;
+            /// Child: north west quadtree node (shared with copies until modified).
+            std::shared_ptr<QuadtreeContainer> m_child_north_west;
 
-            /// Child: south east quadtree node.
-            std::unique_ptr<QuadtreeContainer> m_child_south_east;
+            /// Child: south east quadtree node (shared with copies until modified).
+            std::shared_ptr<QuadtreeContainer> m_child_south_east;
 
-            /// Child: south west quadtree node.
-            std::unique_ptr<QuadtreeContainer> m_child_south_west;
+            /// Child: south west quadtree node (shared with copies until modified).
+            std::shared_ptr<QuadtreeContainer> m_child_south_west;
 
         };
 
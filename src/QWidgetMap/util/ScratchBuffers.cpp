@@ -0,0 +1,164 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ScratchBuffers.h"
+
+// Qt includes.
+#include <QtCore/QThreadStorage>
+
+// STL includes.
+#include <algorithm>
+
+using namespace qwm::util;
+
+namespace
+{
+    /// The scratch buffers of each thread (owned and destroyed by the thread storage).
+    QThreadStorage<ScratchBuffers*> m_instances;
+
+    /// The capacity (in elements) that is always kept, regardless of the frame's peak.
+    const std::size_t m_minimum_capacity(4096);
+
+    /**
+     * Prepares a buffer to be handed out.
+     * @param buffer The buffer to prepare.
+     * @param peak The most elements held during the current frame (updated with the buffer's current size).
+     * @param size_hint The number of elements expected.
+     */
+    template <typename T>
+    void prepareBuffer(std::vector<T>& buffer, std::size_t& peak, const std::size_t& size_hint)
+    {
+        // Track the most elements held, before they are cleared.
+        peak = std::max(peak, std::max(buffer.size(), size_hint));
+
+        // Clear the buffer (the capacity is kept).
+        buffer.clear();
+
+        // Size the buffer once up front, rather than growing it element by element.
+        buffer.reserve(size_hint);
+    }
+
+    /**
+     * Resets a buffer at the end of a frame.
+     * @param buffer The buffer to reset.
+     * @param peak The most elements held during the current frame (reset to 0).
+     */
+    template <typename T>
+    void resetBuffer(std::vector<T>& buffer, std::size_t& peak)
+    {
+        // Track the most elements held, before they are cleared.
+        peak = std::max(peak, buffer.size());
+
+        // Release the capacity if it is far larger than the frame needed.
+        if(buffer.capacity() > std::max(peak * 4, m_minimum_capacity))
+        {
+            std::vector<T>().swap(buffer);
+            buffer.reserve(peak);
+        }
+        else
+        {
+            buffer.clear();
+        }
+
+        // Start the next frame.
+        peak = 0;
+    }
+}
+
+ScratchBuffers& ScratchBuffers::local()
+{
+    // Create the calling thread's scratch buffers, if required.
+    if(m_instances.hasLocalData() == false)
+    {
+        m_instances.setLocalData(new ScratchBuffers);
+    }
+
+    // Return the calling thread's scratch buffers.
+    return *(m_instances.localData());
+}
+
+std::vector<QPointF>& ScratchBuffers::pointsPx(const std::size_t& size_hint)
+{
+    // Prepare the buffer.
+    prepareBuffer(m_points_px, m_points_px_peak, size_hint);
+
+    // Return the buffer.
+    return m_points_px;
+}
+
+std::vector<int>& ScratchBuffers::polylineSizes(const std::size_t& size_hint)
+{
+    // Prepare the buffer.
+    prepareBuffer(m_polyline_sizes, m_polyline_sizes_peak, size_hint);
+
+    // Return the buffer.
+    return m_polyline_sizes;
+}
+
+std::vector<QPointF>& ScratchBuffers::clipPx(const std::size_t& size_hint)
+{
+    // Prepare the buffer.
+    prepareBuffer(m_clip_px, m_clip_px_peak, size_hint);
+
+    // Return the buffer.
+    return m_clip_px;
+}
+
+std::vector<int>& ScratchBuffers::outcodes(const std::size_t& size_hint)
+{
+    // Prepare the buffer.
+    prepareBuffer(m_outcodes, m_outcodes_peak, size_hint);
+
+    // Return the buffer.
+    return m_outcodes;
+}
+
+std::vector<QPointF>& ScratchBuffers::batchPointsPx(const std::size_t& size_hint)
+{
+    // Prepare the buffer.
+    prepareBuffer(m_batch_points_px, m_batch_points_px_peak, size_hint);
+
+    // Return the buffer.
+    return m_batch_points_px;
+}
+
+std::vector<int>& ScratchBuffers::batchPolylineSizes(const std::size_t& size_hint)
+{
+    // Prepare the buffer.
+    prepareBuffer(m_batch_polyline_sizes, m_batch_polyline_sizes_peak, size_hint);
+
+    // Return the buffer.
+    return m_batch_polyline_sizes;
+}
+
+void ScratchBuffers::reset()
+{
+    // Reset each buffer.
+    resetBuffer(m_points_px, m_points_px_peak);
+    resetBuffer(m_polyline_sizes, m_polyline_sizes_peak);
+    resetBuffer(m_clip_px, m_clip_px_peak);
+    resetBuffer(m_outcodes, m_outcodes_peak);
+    resetBuffer(m_batch_points_px, m_batch_points_px_peak);
+    resetBuffer(m_batch_polyline_sizes, m_batch_polyline_sizes_peak);
+}
+
+std::size_t ScratchBuffers::bytesReserved() const
+{
+    // Return the capacity of each buffer in bytes.
+    return ((m_points_px.capacity() + m_clip_px.capacity() + m_batch_points_px.capacity()) * sizeof(QPointF)) + ((m_polyline_sizes.capacity() + m_outcodes.capacity() + m_batch_polyline_sizes.capacity()) * sizeof(int));
+}
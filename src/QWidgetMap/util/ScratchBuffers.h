@@ -0,0 +1,175 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QPointF>
+
+// STL includes.
+#include <cstddef>
+#include <vector>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Scratch buffers used whilst drawing, one set per thread.
+         * Geometries are projected into these buffers (drawn with the pointer/count QPainter overloads) rather than into a
+         * freshly allocated QPolygonF each frame, so the buffers keep their capacity between geometries and frames. The
+         * renderer calls reset() once per frame, which releases any capacity well above what the frame needed.
+         * A buffer is only valid until it is next fetched on the same thread.
+         */
+        class QWIDGETMAP_EXPORT ScratchBuffers
+        {
+
+        public:
+
+            /**
+             * Get the scratch buffers of the calling thread (created on first use, and destroyed when the thread exits).
+             * @return the scratch buffers of the calling thread.
+             */
+            static ScratchBuffers& local();
+
+        private:
+
+            /**
+             * This constructs the Scratch Buffers.
+             */
+            ScratchBuffers() = default;
+
+        public:
+
+            /// Disable copy constructor.
+            ScratchBuffers(const ScratchBuffers&) = delete;
+
+            /// Disable copy assignment.
+            ScratchBuffers& operator=(const ScratchBuffers&) = delete;
+
+            /// Destructor.
+            ~ScratchBuffers() = default;
+
+        public:
+
+            /**
+             * Fetches the (cleared) buffer of projected points.
+             * @param size_hint The number of points expected, used to size the buffer once up front.
+             * @return the buffer of projected points.
+             */
+            std::vector<QPointF>& pointsPx(const std::size_t& size_hint = 0);
+
+            /**
+             * Fetches the (cleared) buffer of polyline sizes (the number of points in each polyline of the projected points).
+             * @param size_hint The number of polylines expected, used to size the buffer once up front.
+             * @return the buffer of polyline sizes.
+             */
+            std::vector<int>& polylineSizes(const std::size_t& size_hint = 0);
+
+            /**
+             * Fetches the (cleared) buffer of points used whilst clipping.
+             * @param size_hint The number of points expected, used to size the buffer once up front.
+             * @return the buffer of points used whilst clipping.
+             */
+            std::vector<QPointF>& clipPx(const std::size_t& size_hint = 0);
+
+            /**
+             * Fetches the (cleared) buffer of point outcodes.
+             * @param size_hint The number of outcodes expected, used to size the buffer once up front.
+             * @return the buffer of point outcodes.
+             */
+            std::vector<int>& outcodes(const std::size_t& size_hint = 0);
+
+            /**
+             * Fetches the (cleared) buffer of projected points that polylines are batched into, before being drawn together.
+             * This is kept apart from pointsPx(), so that geometries drawn between batches do not clear a pending batch.
+             * @param size_hint The number of points expected, used to size the buffer once up front.
+             * @return the buffer of batched projected points.
+             */
+            std::vector<QPointF>& batchPointsPx(const std::size_t& size_hint = 0);
+
+            /**
+             * Fetches the (cleared) buffer of batched polyline sizes (the number of points in each polyline of the batched projected points).
+             * @param size_hint The number of polylines expected, used to size the buffer once up front.
+             * @return the buffer of batched polyline sizes.
+             */
+            std::vector<int>& batchPolylineSizes(const std::size_t& size_hint = 0);
+
+            /**
+             * Resets the buffers at the end of a frame.
+             * Capacity is kept for the next frame, unless it is far larger than the frame needed (ie: after drawing a
+             * one-off huge geometry), in which case it is released.
+             */
+            void reset();
+
+            /**
+             * Fetches the number of bytes reserved by the buffers.
+             * @return the number of bytes reserved.
+             */
+            std::size_t bytesReserved() const;
+
+        private:
+
+            /// The buffer of projected points.
+            std::vector<QPointF> m_points_px;
+
+            /// The most projected points held during the current frame.
+            std::size_t m_points_px_peak { 0 };
+
+            /// The buffer of polyline sizes.
+            std::vector<int> m_polyline_sizes;
+
+            /// The most polyline sizes held during the current frame.
+            std::size_t m_polyline_sizes_peak { 0 };
+
+            /// The buffer of points used whilst clipping.
+            std::vector<QPointF> m_clip_px;
+
+            /// The most clipping points held during the current frame.
+            std::size_t m_clip_px_peak { 0 };
+
+            /// The buffer of batched projected points.
+            std::vector<QPointF> m_batch_points_px;
+
+            /// The most batched projected points held during the current frame.
+            std::size_t m_batch_points_px_peak { 0 };
+
+            /// The buffer of batched polyline sizes.
+            std::vector<int> m_batch_polyline_sizes;
+
+            /// The most batched polyline sizes held during the current frame.
+            std::size_t m_batch_polyline_sizes_peak { 0 };
+
+            /// The buffer of point outcodes.
+            std::vector<int> m_outcodes;
+
+            /// The most outcodes held during the current frame.
+            std::size_t m_outcodes_peak { 0 };
+
+        };
+
+    }
+
+}
@@ -0,0 +1,172 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpriteAtlas.h"
+
+// STL includes.
+#include <algorithm>
+
+using namespace qwm::util;
+
+namespace
+{
+    /// Singleton instance of Sprite Atlas.
+    std::unique_ptr<SpriteAtlas> m_instance(nullptr);
+
+    /**
+     * Checks whether a brush can be keyed by its colour and style (ie: it is not a gradient/texture).
+     * @param brush The brush to check.
+     * @return whether the brush can be keyed.
+     */
+    bool isKeyable(const QBrush& brush)
+    {
+        // Solid colours and patterns only depend on the colour and style.
+        return brush.style() <= Qt::DiagCrossPattern;
+    }
+
+    /**
+     * Checks whether a pen can be keyed by its colour, width, style, dash offset, cap, join, miter limit and brush style (ie: it does not use
+     * a custom dash pattern, or a gradient/texture brush).
+     * @param pen The pen to check.
+     * @return whether the pen can be keyed.
+     */
+    bool isKeyable(const QPen& pen)
+    {
+        // Custom dash patterns are not captured by the pen style.
+        return pen.style() != Qt::CustomDashLine && isKeyable(pen.brush());
+    }
+}
+
+SpriteAtlas& SpriteAtlas::get()
+{
+    // Does the singleton instance exist?
+    if(m_instance == nullptr)
+    {
+        // Create a default instance.
+        m_instance.reset(new SpriteAtlas);
+    }
+
+    // Return the reference to the instance object.
+    return *(m_instance.get());
+}
+
+void SpriteAtlas::destroy()
+{
+    // Ensure the singleton instance is destroyed.
+    m_instance.reset(nullptr);
+}
+
+std::shared_ptr<QPixmap> SpriteAtlas::sprite(const std::string& shape, const QSize& size_px, const QPen& pen, const QBrush& brush, const std::function<void(QPainter&, const QSize&)>& render)
+{
+    // The sprite to return.
+    std::shared_ptr<QPixmap> return_sprite;
+
+    // Can the sprite be shared?
+    if(isKeyable(pen) && isKeyable(brush))
+    {
+        // Create the sprite key.
+        const SpriteKey key(shape, size_px.width(), size_px.height(),
+                            pen.color().rgba(), pen.widthF(), int(pen.style()), pen.dashOffset(), int(pen.capStyle()), int(pen.joinStyle()), pen.miterLimit(), int(pen.brush().style()),
+                            brush.color().rgba(), int(brush.style()));
+
+        // Gain a lock to protect the sprites.
+        QMutexLocker locker(&m_mutex);
+
+        // Is the sprite already in use?
+        return_sprite = m_sprites[key].lock();
+        if(return_sprite == nullptr)
+        {
+            // Render the sprite and share it.
+            return_sprite = SpriteAtlas::render(size_px, pen, brush, render);
+            m_sprites[key] = return_sprite;
+
+            // Release the sprites that are no longer in use, once enough have built up (so the cost is amortised).
+            if(m_sprites.size() >= m_sprites_sweep_size)
+            {
+                for(auto itr_sprite(m_sprites.begin()); itr_sprite != m_sprites.end();)
+                {
+                    // Is the sprite no longer in use?
+                    if(itr_sprite->second.expired())
+                    {
+                        // Remove the sprite.
+                        itr_sprite = m_sprites.erase(itr_sprite);
+                    }
+                    else
+                    {
+                        // Move on to the next sprite.
+                        ++itr_sprite;
+                    }
+                }
+
+                // Wait for the sprites to double before sweeping again.
+                m_sprites_sweep_size = std::max(std::size_t(64), m_sprites.size() * 2);
+            }
+        }
+    }
+    else
+    {
+        // Render a sprite just for this symbol.
+        return_sprite = SpriteAtlas::render(size_px, pen, brush, render);
+    }
+
+    // Return the sprite.
+    return return_sprite;
+}
+
+std::size_t SpriteAtlas::size() const
+{
+    // Gain a lock to protect the sprites.
+    QMutexLocker locker(&m_mutex);
+
+    // Count the sprites still in use.
+    std::size_t return_size(0);
+    for(const auto& sprite : m_sprites)
+    {
+        if(sprite.second.expired() == false)
+        {
+            ++return_size;
+        }
+    }
+
+    // Return the number of sprites.
+    return return_size;
+}
+
+std::shared_ptr<QPixmap> SpriteAtlas::render(const QSize& size_px, const QPen& pen, const QBrush& brush, const std::function<void(QPainter&, const QSize&)>& render)
+{
+    // Create a pixmap of the required size.
+    auto return_sprite(std::make_shared<QPixmap>(size_px));
+
+    // Reset the pixmap.
+    return_sprite->fill(Qt::transparent);
+
+    // Create a painter for the pixmap.
+    QPainter painter(return_sprite.get());
+
+    // Ensure antialiasing is enabled.
+    painter.setRenderHints(QPainter::Antialiasing, true);
+
+    // Set the pen and brush.
+    painter.setPen(pen);
+    painter.setBrush(brush);
+
+    // Render the symbol.
+    render(painter, size_px);
+
+    // Return the sprite.
+    return return_sprite;
+}
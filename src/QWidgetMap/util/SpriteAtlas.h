@@ -0,0 +1,133 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QMutex>
+#include <QtCore/QSize>
+#include <QtGui/QBrush>
+#include <QtGui/QPainter>
+#include <QtGui/QPen>
+#include <QtGui/QPixmap>
+
+// STL includes.
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Shares the rendered pixmaps of point symbols (ie: circles/arrows), so that identical symbols are only rendered and stored once.
+         * Sprites are keyed by (shape, size, pen, brush) and held weakly, so a sprite is released once no point references it.
+         */
+        class QWIDGETMAP_EXPORT SpriteAtlas
+        {
+
+        public:
+
+            /**
+             * Get the singleton instance of the Sprite Atlas.
+             * @return the singleton instance.
+             */
+            static SpriteAtlas& get();
+
+            /// Destroys the singleton instance of Sprite Atlas.
+            static void destroy();
+
+        private:
+
+            /**
+             * This constructs a Sprite Atlas.
+             */
+            SpriteAtlas() = default;
+
+        public:
+
+            /// Disable copy constructor.
+            SpriteAtlas(const SpriteAtlas&) = delete;
+
+            /// Disable copy assignment.
+            SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+
+            /// Destructor.
+            ~SpriteAtlas() = default;
+
+        public:
+
+            /**
+             * Fetches the sprite for a symbol, rendering it if an identical sprite is not already in use.
+             * Pens/brushes that use gradients or textures, and pens with custom dash patterns, cannot be compared cheaply, so those sprites are always rendered (and not shared).
+             * @param shape The name of the symbol's shape (ie: "circle").
+             * @param size_px The size of the sprite in pixels.
+             * @param pen The pen to render the symbol with.
+             * @param brush The brush to render the symbol with.
+             * @param render The function to render the symbol with (the painter is set up with the pen/brush and antialiasing).
+             * @return the sprite pixmap.
+             */
+            std::shared_ptr<QPixmap> sprite(const std::string& shape, const QSize& size_px, const QPen& pen, const QBrush& brush, const std::function<void(QPainter&, const QSize&)>& render);
+
+            /**
+             * Fetches the number of sprites currently shared.
+             * @return the number of sprites currently shared.
+             */
+            std::size_t size() const;
+
+        private:
+
+            /// The key that identifies a sprite: shape, width, height, pen (colour, width, style, dash offset, cap, join, miter limit, brush style) and brush (colour, style).
+            using SpriteKey = std::tuple<std::string, int, int, QRgb, qreal, int, qreal, int, int, qreal, int, QRgb, int>;
+
+            /**
+             * Renders a sprite.
+             * @param size_px The size of the sprite in pixels.
+             * @param pen The pen to render the symbol with.
+             * @param brush The brush to render the symbol with.
+             * @param render The function to render the symbol with.
+             * @return the sprite pixmap.
+             */
+            static std::shared_ptr<QPixmap> render(const QSize& size_px, const QPen& pen, const QBrush& brush, const std::function<void(QPainter&, const QSize&)>& render);
+
+        private:
+
+            /// The sprites currently shared.
+            std::map<SpriteKey, std::weak_ptr<QPixmap>> m_sprites;
+
+            /// The number of sprites at which the sprites no longer in use are released.
+            std::size_t m_sprites_sweep_size { 64 };
+
+            /// Mutex to protect the sprites.
+            mutable QMutex m_mutex;
+
+        };
+
+    }
+
+}
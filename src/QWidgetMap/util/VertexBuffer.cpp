@@ -0,0 +1,142 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "VertexBuffer.h"
+
+// STL includes.
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace qwm::util;
+
+namespace
+{
+    /// The encoding used by vertex buffers that do not specify one.
+    std::atomic<int> m_default_encoding(int(VertexBuffer::Encoding::Double));
+}
+
+VertexBuffer::Encoding VertexBuffer::defaultEncoding()
+{
+    // Return the default encoding.
+    return Encoding(m_default_encoding.load());
+}
+
+void VertexBuffer::setDefaultEncoding(const Encoding& encoding)
+{
+    // Set the default encoding.
+    m_default_encoding.store(int(encoding));
+}
+
+VertexBuffer::VertexBuffer(const std::vector<PointWorldCoord>& points, const Encoding& encoding)
+    : m_encoding(encoding)
+{
+    // Should the vertices be quantized?
+    if(m_encoding == Encoding::Quantized)
+    {
+        // Loop through each vertex and quantize it (to the nearest step, clamped to the range that can be stored).
+        const double maximum_degrees(double(std::numeric_limits<std::int32_t>::max()) / double(m_quantized_scale));
+        m_quantized.reserve(points.size() * 2);
+        for(const auto& point : points)
+        {
+            m_quantized.push_back(std::int32_t(std::lround(std::max(-maximum_degrees, std::min(maximum_degrees, point.longitude())) * double(m_quantized_scale))));
+            m_quantized.push_back(std::int32_t(std::lround(std::max(-maximum_degrees, std::min(maximum_degrees, point.latitude())) * double(m_quantized_scale))));
+        }
+    }
+    else
+    {
+        // Store the vertices as they are.
+        m_points = points;
+    }
+}
+
+PointWorldCoord VertexBuffer::at(const std::size_t& index) const
+{
+    // Return the vertex, decoding it if required (bounds checked).
+    return m_encoding == Encoding::Quantized ? PointWorldCoord(m_quantized.at(index * 2) / double(m_quantized_scale), m_quantized.at((index * 2) + 1) / double(m_quantized_scale)) : m_points.at(index);
+}
+
+QRectF VertexBuffer::boundingRect() const
+{
+    // The bounding rect to return.
+    QRectF return_rect;
+
+    // Do we have any vertices?
+    if(empty() == false)
+    {
+        // Loop through each vertex to find the minimum/maximum longitude and latitude.
+        double longitude_minimum(std::numeric_limits<double>::max());
+        double latitude_minimum(std::numeric_limits<double>::max());
+        double longitude_maximum(std::numeric_limits<double>::lowest());
+        double latitude_maximum(std::numeric_limits<double>::lowest());
+        for(std::size_t i = 0; i < size(); ++i)
+        {
+            const PointWorldCoord point((*this)[i]);
+            longitude_minimum = std::min(longitude_minimum, point.longitude());
+            latitude_minimum = std::min(latitude_minimum, point.latitude());
+            longitude_maximum = std::max(longitude_maximum, point.longitude());
+            latitude_maximum = std::max(latitude_maximum, point.latitude());
+        }
+
+        // Set the bounding rect (as QPolygonF::boundingRect would).
+        return_rect = QRectF(QPointF(longitude_minimum, latitude_minimum), QPointF(longitude_maximum, latitude_maximum));
+    }
+
+    // Return the bounding rect.
+    return return_rect;
+}
+
+std::size_t VertexBuffer::memoryBytes() const
+{
+    // Return the number of bytes allocated for the vertices.
+    return (m_points.capacity() * sizeof(PointWorldCoord)) + (m_quantized.capacity() * sizeof(std::int32_t));
+}
+
+QPolygonF VertexBuffer::toQPolygonF(const std::size_t& first, const std::size_t& last) const
+{
+    // Clamp the range to the vertices.
+    const std::size_t range_last(std::min(last, size()));
+
+    // Loop through each vertex in the range to copy it.
+    QPolygonF return_polygon;
+    return_polygon.reserve(int(range_last > first ? range_last - first : 0));
+    for(std::size_t i = first; i < range_last; ++i)
+    {
+        return_polygon.append((*this)[i]);
+    }
+
+    // Return the polygon.
+    return return_polygon;
+}
+
+std::vector<PointWorldCoord> VertexBuffer::toStdVector(const std::size_t& first, const std::size_t& last) const
+{
+    // Clamp the range to the vertices.
+    const std::size_t range_last(std::min(last, size()));
+
+    // Loop through each vertex in the range to copy it.
+    std::vector<PointWorldCoord> return_points;
+    return_points.reserve(range_last > first ? range_last - first : 0);
+    for(std::size_t i = first; i < range_last; ++i)
+    {
+        return_points.push_back((*this)[i]);
+    }
+
+    // Return the points.
+    return return_points;
+}
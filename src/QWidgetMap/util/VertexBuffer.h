@@ -0,0 +1,242 @@
+/**
+ * @copyright 2015 Chris Stylianou
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QRectF>
+#include <QtGui/QPolygonF>
+
+// STL includes.
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+// Local includes.
+#include "../qwidgetmap_global.h"
+#include "Point.h"
+
+/// QWidgetMap namespace.
+namespace qwm
+{
+
+    /// Utilities namespace.
+    namespace util
+    {
+
+        /**
+         * Compact vertex storage for line/polygon geometries.
+         * The vertices are stored once, either as doubles or quantized to 32-bit fixed-point (1e-7 degrees, ~1cm at the
+         * equator), which halves the memory used. Vertices are read in place (by index or iterator) rather than copied out.
+         */
+        class QWIDGETMAP_EXPORT VertexBuffer
+        {
+
+        public:
+
+            /// Vertex encodings.
+            enum class Encoding
+            {
+                /// Vertices are stored as doubles (16 bytes per vertex).
+                Double,
+
+                /// Vertices are stored as 32-bit fixed-point (8 bytes per vertex).
+                Quantized
+            };
+
+            /**
+             * Iterator over the vertices of a vertex buffer (vertices are decoded as they are read).
+             */
+            class const_iterator
+            {
+
+            public:
+
+                /// Iterator traits.
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef PointWorldCoord value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const PointWorldCoord* pointer;
+                typedef PointWorldCoord reference;
+
+                /**
+                 * Vertex buffer iterator constructor.
+                 * @param buffer The vertex buffer to iterate over.
+                 * @param index The index of the vertex the iterator points at.
+                 */
+                const_iterator(const VertexBuffer* buffer = nullptr, const std::size_t& index = 0) : m_buffer(buffer), m_index(index) { }
+
+                /**
+                 * Fetches the vertex the iterator points at.
+                 * @return the vertex (world coordinates).
+                 */
+                PointWorldCoord operator*() const { return (*m_buffer)[m_index]; }
+
+                /// Moves on to the next vertex.
+                const_iterator& operator++() { ++m_index; return *this; }
+
+                /// Moves on to the next vertex.
+                const_iterator operator++(int) { const_iterator previous(*this); ++m_index; return previous; }
+
+                /// Moves back to the previous vertex.
+                const_iterator& operator--() { --m_index; return *this; }
+
+                /// Moves the iterator forward a number of vertices.
+                const_iterator operator+(const std::ptrdiff_t& offset) const { return const_iterator(m_buffer, std::size_t(std::ptrdiff_t(m_index) + offset)); }
+
+                /// Calculates the number of vertices between two iterators.
+                std::ptrdiff_t operator-(const const_iterator& other) const { return std::ptrdiff_t(m_index) - std::ptrdiff_t(other.m_index); }
+
+                /// Compares whether two iterators point at the same vertex.
+                bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+
+                /// Compares whether two iterators point at different vertices.
+                bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+            private:
+
+                /// The vertex buffer.
+                const VertexBuffer* m_buffer;
+
+                /// The index of the vertex.
+                std::size_t m_index;
+
+            };
+
+        public:
+
+            /**
+             * Fetches the encoding used by vertex buffers that do not specify one.
+             * @return the default encoding.
+             */
+            static Encoding defaultEncoding();
+
+            /**
+             * Sets the encoding used by vertex buffers that do not specify one (ie: Quantized for memory-constrained deployments).
+             * @param encoding The default encoding.
+             */
+            static void setDefaultEncoding(const Encoding& encoding);
+
+        public:
+
+            /**
+             * Vertex buffer constructor.
+             * @param points The vertices to store (world coordinates).
+             * @param encoding The encoding to store the vertices with.
+             */
+            explicit VertexBuffer(const std::vector<PointWorldCoord>& points = std::vector<PointWorldCoord>(), const Encoding& encoding = defaultEncoding());
+
+        public:
+
+            /**
+             * Fetches the encoding the vertices are stored with.
+             * @return the encoding.
+             */
+            Encoding encoding() const { return m_encoding; }
+
+            /**
+             * Fetches the number of vertices.
+             * @return the number of vertices.
+             */
+            std::size_t size() const { return m_encoding == Encoding::Quantized ? m_quantized.size() / 2 : m_points.size(); }
+
+            /**
+             * Fetches whether there are no vertices.
+             * @return whether there are no vertices.
+             */
+            bool empty() const { return size() == 0; }
+
+            /**
+             * Fetches a vertex (without bounds checking).
+             * @param index The index of the vertex.
+             * @return the vertex (world coordinates).
+             */
+            PointWorldCoord operator[](const std::size_t& index) const
+            {
+                // Return the vertex, decoding it if required.
+                return m_encoding == Encoding::Quantized ? PointWorldCoord(m_quantized[index * 2] / double(m_quantized_scale), m_quantized[(index * 2) + 1] / double(m_quantized_scale)) : m_points[index];
+            }
+
+            /**
+             * Fetches a vertex.
+             * @param index The index of the vertex.
+             * @return the vertex (world coordinates).
+             */
+            PointWorldCoord at(const std::size_t& index) const;
+
+            /**
+             * Fetches an iterator to the first vertex.
+             * @return the iterator to the first vertex.
+             */
+            const_iterator begin() const { return const_iterator(this, 0); }
+
+            /**
+             * Fetches an iterator past the last vertex.
+             * @return the iterator past the last vertex.
+             */
+            const_iterator end() const { return const_iterator(this, size()); }
+
+            /**
+             * Calculates the bounding rect of the vertices.
+             * @return the bounding rect (world coordinates).
+             */
+            QRectF boundingRect() const;
+
+            /**
+             * Fetches the number of bytes used to store the vertices.
+             * @return the number of bytes used.
+             */
+            std::size_t memoryBytes() const;
+
+            /**
+             * Copies a range of the vertices into a QPolygonF.
+             * @param first The index of the first vertex to copy.
+             * @param last The index after the last vertex to copy (defaults to the end of the vertices).
+             * @return the QPolygonF of the vertices (world coordinates).
+             */
+            QPolygonF toQPolygonF(const std::size_t& first = 0, const std::size_t& last = std::numeric_limits<std::size_t>::max()) const;
+
+            /**
+             * Copies a range of the vertices into a vector.
+             * @param first The index of the first vertex to copy.
+             * @param last The index after the last vertex to copy (defaults to the end of the vertices).
+             * @return the vector of the vertices (world coordinates).
+             */
+            std::vector<PointWorldCoord> toStdVector(const std::size_t& first = 0, const std::size_t& last = std::numeric_limits<std::size_t>::max()) const;
+
+        private:
+
+            /// The number of quantized steps per degree.
+            static const std::int32_t m_quantized_scale = 10000000;
+
+            /// The encoding the vertices are stored with.
+            Encoding m_encoding;
+
+            /// The vertices (if stored as doubles).
+            std::vector<PointWorldCoord> m_points;
+
+            /// The vertices, as interleaved longitude/latitude quantized steps (if stored quantized).
+            std::vector<std::int32_t> m_quantized;
+
+        };
+
+    }
+
+}